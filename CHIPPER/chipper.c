@@ -0,0 +1,2679 @@
+/* (S)Chip-48 Assembler V2.11 by Christian Egeberg 2/11-'90 .. 20/8-'91 */
+/* Reentrant version, all state is kept in an Assembler record, see chipper.h */
+
+#include "chipper.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <setjmp.h>
+
+#define False     ( char )0
+#define True      ( char )~0
+#define UnDefined 0L
+#define Defined   ~0L
+
+#define StartAddress 0x200L
+#define StopAddress  0xfffL
+#define CheckMagic   0x1081L
+#define WordMask     0xffffL
+#define AddrMask     0xfffL
+#define ByteMask     0xffL
+#define NibbleMask   0xfL
+
+#define SpaceLength     32768
+#define SpaceAlign      sizeof( long int )
+#define LineLength      255
+#define ParamLength     127
+#define SymbolLength    32
+#define ListLength      32
+#define StackLength     32
+#define IncludeLength   16
+#define HashLength      256
+#define TextLength      4096
+#define MaxBaseLength   16
+#define BinHpHeadLength 13
+
+#define NullChar      '\0'
+#define SpaceChar     ' '
+#define SeparatorChar ','
+#define RemarkChar    ';'
+#define SymbolChar    '_'
+#define LabelChar     ':'
+#define EqualChar     '='
+#define TextChar      '\''
+#define AddressChar   '\77'
+#define HexChar       '#'
+#define BinChar       '$'
+#define OctChar       '@'
+#define AscChar       '\"'
+#define StartChar     '('
+#define StopChar      ')'
+#define PlusChar      '+'
+#define MinusChar     '-'
+#define NotChar       '~'
+#define PowerChar     '!'
+#define ShlChar       '<'
+#define ShrChar       '>'
+#define MulChar       '*'
+#define FracChar      '/'
+#define AndChar       '&'
+#define OrChar        '|'
+#define XorChar       '^'
+#define DivChar       '\\'
+#define ModChar       '%'
+
+#define WrongToken    0
+#define EqualToken    1
+#define AddToken      2
+#define AlignToken    3
+#define AndToken      4
+#define CallToken     5
+#define ClsToken      6
+#define DaToken       7
+#define DbToken       8
+#define DefineToken   9
+#define DrwToken     10
+#define DsToken      11
+#define DwToken      12
+#define ElseToken    13
+#define EndToken     14
+#define EndifToken   15
+#define EquToken     16
+#define ExitToken    17
+#define HighToken    18
+#define IfdefToken   19
+#define IfundToken   20
+#define IncludeToken 21
+#define JpToken      22
+#define LdToken      23
+#define LowToken     24
+#define OptionToken  25
+#define OrToken      26
+#define OrgToken     27
+#define RetToken     28
+#define RndToken     29
+#define ScdToken     30
+#define SclToken     31
+#define ScrToken     32
+#define SeToken      33
+#define ShlToken     34
+#define ShrToken     35
+#define SknpToken    36
+#define SkpToken     37
+#define SneToken     38
+#define SubToken     39
+#define SubnToken    40
+#define SysToken     41
+#define UndefToken   42
+#define UsedToken    43
+#define XorToken     44
+#define XrefToken    45
+#define LastToken    46
+
+#define BadReg   0
+#define BReg     1
+#define DtReg    2
+#define FReg     3
+#define HfReg    4
+#define IReg     5
+#define KReg     6
+#define LfReg    7
+#define RReg     8
+#define StReg    9
+#define V0Reg   10
+#define V1Reg   11
+#define V2Reg   12
+#define V3Reg   13
+#define V4Reg   14
+#define V5Reg   15
+#define V6Reg   16
+#define V7Reg   17
+#define V8Reg   18
+#define V9Reg   19
+#define VaReg   20
+#define VbReg   21
+#define VcReg   22
+#define VdReg   23
+#define VeReg   24
+#define VfReg   25
+#define IiReg   26
+#define LastReg 27
+
+#define AlignOnDefault  Defined
+#define Chip8Default    UnDefined
+#define Chip48Default   Defined
+#define Super10Default  UnDefined
+#define Super11Default  UnDefined
+#define UsedYesDefault  UnDefined
+#define UsedOnDefault   UnDefined
+#define XrefYesDefault  Defined
+#define XrefOnDefault   Defined
+#define HpHeadDefault   Defined
+#define HpAscDefault    UnDefined
+
+typedef char LineString[ LineLength + 1 ];
+typedef char ParamString[ ParamLength + 1 ];
+typedef char SymbolString[ SymbolLength + 1 ];
+typedef struct SpaceRecord {
+  unsigned int Size;
+  char *Start;
+  char *Point;
+  char *Index;
+  unsigned int Request;
+} SpaceRecord;
+typedef const struct LocRecord *LocPointer;
+typedef struct LocRecord {
+  unsigned int Line;
+  char *Name;
+  char *Text;
+  char Xref;
+  long int Addr;
+} LocRecord;
+typedef struct ReferRecord *ReferPointer;
+typedef struct ReferRecord {
+  LocRecord Loc;
+  ReferPointer Next;
+} ReferRecord;
+typedef struct ParamRecord *ParamPointer;
+typedef struct ParamRecord {
+  char *Param;
+  ParamPointer Next;
+} ParamRecord;
+typedef struct SymbolRecord *SymbolPointer;
+typedef struct SymbolRecord {
+  LocRecord Loc;
+  long int Value;
+  char *Symbol;
+  char *Expr;
+  ReferPointer Refer;
+  unsigned int Hash;
+  char Label;
+  SymbolPointer Next;
+} SymbolRecord;
+typedef struct SymbolTable {
+  SymbolPointer Bucket[ HashLength ];
+  SymbolPointer *Sorted;
+  unsigned int Count;
+} SymbolTable;
+typedef struct InstRecord *InstPointer;
+typedef struct InstRecord {
+  LocRecord Loc;
+  unsigned int Token;
+  unsigned int Count;
+  ParamPointer Params;
+  InstPointer Next;
+} InstRecord;
+typedef struct TextRecord {
+  char *Start;
+  size_t Length;
+  size_t Size;
+} TextRecord;
+typedef struct Assembler *AsmPointer;
+typedef struct Assembler {
+  SpaceRecord Space;
+  jmp_buf Abort;
+  char OutOfMemory;
+  char ListFlag;
+
+  const char *SourceName;
+  char *FileName;
+  Chipper_ReadFunc Read;
+  void *UserData;
+  char *Sources[ IncludeLength ];
+  unsigned int Depth;
+
+  char StackStart[ StackLength + 1 ];
+  char *StackPoint;
+
+  long int DummyValue;
+  long int *AlignOnCond;
+  long int *Chip8Cond;
+  long int *Chip48Cond;
+  long int *Super10Cond;
+  long int *Super11Cond;
+  long int *UsedYesCond;
+  long int *UsedOnCond;
+  long int *XrefYesCond;
+  long int *XrefOnCond;
+  long int *HpHeadCond;
+  long int *HpAscCond;
+
+  InstPointer Instructions;
+  InstPointer LastInst;
+  SymbolTable Directives;
+  SymbolTable Registers;
+  SymbolTable Symbols;
+  SymbolTable Conditions;
+  InstPointer InstPoint;
+  SymbolPointer SymbPoint;
+  SymbolPointer CurrentSymbol;
+
+  long int FinalAddress;
+  LocRecord Location;
+  unsigned int WarningCount;
+
+  TextRecord List;
+  TextRecord Messages;
+  TextRecord Output;
+  TextRecord Includes;
+
+  unsigned char Memory[ StopAddress - StartAddress + 1 ];
+} Assembler;
+
+static const char DefaultSourceName[] = "source";
+static const char BinHpHeadText[] = "HPHP48-C";
+static const char AscHpHeadText[] = "%%HP: T(3)A(R)F(.);\n";
+
+static const char RunErrorMessage[] = "Fatal error: ";
+static const char RunWarningMessage[] = "Warning: ";
+static const char WarningNumMessage[] = "Total number of warnings: ";
+static const char EndOfFileMessage[] = "; End of file";
+static const char NoSourceError[] = "No source file found";
+static const char AllocationError[] = "Unable to allocate more memory";
+static const char SpaceAssertError[] = "Internal memory allocation mismatch";
+static const char NestedIfdefError[] = "Too many nested conditions";
+static const char NestedIncludeError[] = "Too many nested include files";
+static const char BoundsError[] = "Outside legal address range";
+static const char ParamCountWarning[] = "Incorrect number of parameters";
+static const char DualSymbolWarning[] = "No directive recognized";
+static const char NoOptionWarning[] = "Option not recognized";
+static const char MissingSymbolWarning[] = "No symbol name specified";
+static const char NoSymbolWarning[] = "Not a defined symbol";
+static const char UnusedSymbolWarning[] = "Unused symbol detected";
+static const char CopySymbolWarning[] = "Existing symbol redefined";
+static const char UndefinedWarning[] = "Unable to evaluate parameter";
+static const char RangeWarning[] = "Parameter out of range";
+static const char NoRegisterWarning[] = "No register recognized";
+static const char BadRegisterWarning[] = "Illegal register specified";
+static const char NeedsChip8Warning[] = "Chip-8 spesific directive";
+static const char NeedsChip48Warning[] = "Chip-48 spesific directive";
+static const char NeedsSuper10Warning[] = "Super Chip-48 V1.0.. spesific directive";
+static const char NeedsSuper11Warning[] = "Super Chip-48 V1.1.. spesific directive";
+static const char MissingIfdefWarning[] = "No previous condition found";
+static const char CountDefineWarning[] = "Unbalanced condition matching in file";
+static const char InternalWarning[] = "Internal data structure mismatch";
+
+static const char AlignOnName[] = "ALIGNON";
+static const char Chip8Name[] = "CHIP8";
+static const char Chip48Name[] = "CHIP48";
+static const char Super10Name[] = "SCHIP10";
+static const char Super11Name[] = "SCHIP11";
+static const char UsedYesName[] = "USEDYES";
+static const char UsedOnName[] = "USEDON";
+static const char XrefYesName[] = "XREFYES";
+static const char XrefOnName[] = "XREFON";
+static const char HpHeadName[] = "HPHEAD";
+static const char HpAscName[] = "HPASC";
+static const char HpBinName[] = "HPBIN";
+static const char BinaryName[] = "BINARY";
+static const char StringName[] = "STRING";
+
+static const char OptionYesName[] = "YES";
+static const char OptionNoName[] = "NO";
+static const char OptionOnName[] = "ON";
+static const char OptionOffName[] = "OFF";
+
+static const SymbolString TokenText[ LastToken ] =
+  { ",,,,,",   "=",       "ADD",     "ALIGN",   "AND",
+    "CALL",    "CLS",     "DA",      "DB",      "DEFINE",
+    "DRW",     "DS",      "DW",      "ELSE",    "END",
+    "ENDIF",   "EQU",     "EXIT",    "HIGH",    "IFDEF",
+    "IFUND",   "INCLUDE", "JP",      "LD",      "LOW",
+    "OPTION",  "OR",      "ORG",     "RET",     "RND",
+    "SCD",     "SCL",     "SCR",     "SE",      "SHL",
+    "SHR",     "SKNP",    "SKP",     "SNE",     "SUB",
+    "SUBN",    "SYS",     "UNDEF",   "USED",    "XOR",
+    "XREF"                                                };
+
+static const SymbolString RegisterText[ LastReg ] =
+  { ",,,", "B",   "DT",  "F",   "HF",  "I",   "K",   "LF",
+    "R",   "ST",  "V0",  "V1",  "V2",  "V3",  "V4",  "V5",
+    "V6",  "V7",  "V8",  "V9",  "VA",  "VB",  "VC",  "VD",
+    "VE",  "VF",  "[I]"                                    };
+
+static const char Operators[ 0x100 ] = {
+  [ StartChar ] = True, [ StopChar ] = True,  [ PlusChar ] = True,
+  [ MinusChar ] = True, [ NotChar ] = True,   [ PowerChar ] = True,
+  [ ShlChar ] = True,   [ ShrChar ] = True,   [ MulChar ] = True,
+  [ FracChar ] = True,  [ AndChar ] = True,   [ OrChar ] = True,
+  [ XorChar ] = True,   [ DivChar ] = True,   [ ModChar ] = True   };
+static const char StartOperator[] = { StartChar, NullChar };
+static const char StopOperator[] = { StopChar, NullChar };
+static const char UnaryOperator[] = { PlusChar, MinusChar, NotChar, NullChar };
+static const char PowerOperator[] = { PowerChar, ShlChar, ShrChar, NullChar };
+static const char MulDivOperator[] = { MulChar, FracChar, NullChar };
+static const char PlusMinusOperator[] = { PlusChar, MinusChar, NullChar };
+static const char BitWiseOperator[] = { AndChar, OrChar, XorChar, NullChar };
+static const char DivModOperator[] = { DivChar, ModChar, NullChar };
+static const char DigitText[] = "0123456789ABCDEF.";
+static char NullString[] = "\0";
+static const char Separator[] =
+  "------------------------------------------------------------------------------";
+
+static const long int DefinedValue = Defined;
+static const LocRecord NullLocation = { 0, NullString, NullString, False, 0L };
+static const LocRecord UsedLocation = { 0, NullString, NullString, True, 0L };
+
+static char ResolveDivMod( AsmPointer Asm, char *Symbol, char **Param,
+  long int *Value, SymbolTable *Table, LocPointer Loc );
+static void DecodeFile( AsmPointer Asm, char *FileName, const char *Source,
+  size_t Size );
+
+static void GrowText( AsmPointer Asm, TextRecord *Text, size_t Length )
+{
+  size_t Size;
+  char *This;
+
+  if( Text->Length + Length + 1 > Text->Size ) {
+    for( Size = Text->Size ? Text->Size : TextLength;
+      Size < Text->Length + Length + 1; Size <<= 1 )
+        ;
+    This = ( char * )realloc( Text->Start, Size );
+    if( !This ) {
+      /* Nothing more can be reported, see Chipper_Assemble */
+      Asm->OutOfMemory = True;
+      longjmp( Asm->Abort, 1 );
+    }
+    Text->Start = This;
+    Text->Size = Size;
+  }
+}
+
+static void AppendText( AsmPointer Asm, TextRecord *Text, const char *Data,
+  size_t Length )
+{
+  GrowText( Asm, Text, Length );
+  memcpy( Text->Start + Text->Length, Data, Length );
+  Text->Length += Length;
+  Text->Start[ Text->Length ] = NullChar;
+}
+
+static void FormatText( AsmPointer Asm, TextRecord *Text, const char *Format,
+  va_list Args )
+{
+  va_list Copy;
+  int Length;
+
+  va_copy( Copy, Args );
+  Length = vsnprintf( NULL, 0, Format, Copy );
+  va_end( Copy );
+  if( Length > 0 ) {
+    GrowText( Asm, Text, ( size_t )Length );
+    vsnprintf( Text->Start + Text->Length, ( size_t )Length + 1, Format, Args );
+    Text->Length += Length;
+  }
+}
+
+static void ListText( AsmPointer Asm, const char *Format, ... )
+{
+  va_list Args;
+
+  if( Asm->ListFlag ) {
+    va_start( Args, Format );
+    FormatText( Asm, &( Asm->List ), Format, Args );
+    va_end( Args );
+  }
+}
+
+static void ReportText( AsmPointer Asm, const char *Format, ... )
+{
+  va_list Args;
+
+  va_start( Args, Format );
+  FormatText( Asm, &( Asm->Messages ), Format, Args );
+  va_end( Args );
+  if( Asm->ListFlag ) {
+    va_start( Args, Format );
+    FormatText( Asm, &( Asm->List ), Format, Args );
+    va_end( Args );
+  }
+}
+
+static void RunError( AsmPointer Asm, char AbortFlag, const char *Message )
+{
+  if( AbortFlag )
+    ReportText( Asm, "%s\n%s%s\n", Separator, RunErrorMessage, Message );
+  else
+    ReportText( Asm, "%s\n%s%s\n", Separator, RunWarningMessage, Message );
+  if( Asm->Location.Line )
+    ReportText( Asm, "Current file %s line %u\n%s\n", Asm->Location.Name,
+      Asm->Location.Line, Asm->Location.Text );
+  if( Asm->InstPoint )
+    ReportText( Asm, "Associated file %s line %u\n%s\n",
+      Asm->InstPoint->Loc.Name, Asm->InstPoint->Loc.Line,
+      Asm->InstPoint->Loc.Text );
+  if( Asm->SymbPoint )
+    ReportText( Asm, "Symbol %s file %s line %u\n%s\n",
+      Asm->SymbPoint->Symbol, Asm->SymbPoint->Loc.Name,
+      Asm->SymbPoint->Loc.Line, Asm->SymbPoint->Loc.Text );
+  ReportText( Asm, "%s\n", Separator );
+  if( AbortFlag )
+    longjmp( Asm->Abort, 1 );
+    /* Chipper_Assemble releases everything */
+  else
+    Asm->WarningCount++;
+}
+
+static char *NumberString( char *Result, long int Value, unsigned int Base,
+  unsigned int Count )
+{
+  char *Digit;
+
+  Digit = Result + Count;
+  *( Digit-- ) = NullChar;
+  while(( Digit >= Result ) && ( Value > 0L )) {
+    *( Digit-- ) = DigitText[ Value % Base ];
+    Value /= Base;
+  }
+  while( Digit >= Result )
+    *( Digit-- ) = '0';
+  return( Result );
+}
+
+static void ListInstruction( AsmPointer Asm, long int Address,
+  unsigned int Count, InstPointer Inst )
+{
+  unsigned int This;
+  SymbolString HexText;
+
+  if( !Asm->ListFlag )
+    return;
+  ListText( Asm, "%s\n%s(%u).. %s: ", Inst->Loc.Text, Inst->Loc.Name,
+    Inst->Loc.Line, NumberString( HexText, Address, 16, 3 ));
+  for( This = 0; This < Count; This++ )
+    ListText( Asm, "%s", NumberString( HexText, ( long int )
+      Asm->Memory[ Address + This - StartAddress ], 16, 2 ));
+  ListText( Asm, "\n" );
+}
+
+static void ListReference( AsmPointer Asm, ReferPointer Head )
+{
+  for( ; Head; Head = Head->Next )
+    if( Head->Loc.Line && Head->Loc.Xref )
+      ListText( Asm, "  %s(%u)\n", Head->Loc.Name, Head->Loc.Line );
+}
+
+static int CompareSymbols( const void *Left, const void *Right )
+{
+  return( strcmp(( *( const SymbolPointer * )Left )->Symbol,
+    ( *( const SymbolPointer * )Right )->Symbol ));
+}
+
+/* Hashing loses the order the listing is printed in */
+static void SortSymbols( AsmPointer Asm, SymbolTable *Table )
+{
+  SymbolPointer Symb;
+  unsigned int Bucket;
+  unsigned int Count;
+
+  if( !Table->Count )
+    return;
+  free( Table->Sorted );
+  Table->Sorted = ( SymbolPointer * )malloc( Table->Count *
+    sizeof( SymbolPointer ));
+  if( !Table->Sorted )
+    RunError( Asm, True, AllocationError );
+  for( Count = 0, Bucket = 0; Bucket < HashLength; Bucket++ )
+    for( Symb = Table->Bucket[ Bucket ]; Symb; Symb = Symb->Next )
+      Table->Sorted[ Count++ ] = Symb;
+  qsort( Table->Sorted, Table->Count, sizeof( SymbolPointer ),
+    CompareSymbols );
+}
+
+static void ListSymbols( AsmPointer Asm, SymbolTable *Table )
+{
+  SymbolString HexText;
+  SymbolPointer Head;
+  unsigned int Count;
+
+  SortSymbols( Asm, Table );
+  for( Count = 0; Count < Table->Count; Count++ ) {
+    Head = Table->Sorted[ Count ];
+    Asm->SymbPoint = Head;
+    if( !( *Asm->UsedYesCond ) && Head->Loc.Line && !( Head->Refer ))
+      RunError( Asm, False, UnusedSymbolWarning );
+    if( Head->Expr )
+      strcpy( HexText, "UND" );
+    else
+      NumberString( HexText, Head->Value, 16, 3 );
+    ListText( Asm, "%s %s %s(%u)\n", HexText, Head->Symbol, Head->Loc.Name,
+      Head->Loc.Line );
+    if( *Asm->XrefYesCond )
+      ListReference( Asm, Head->Refer );
+    Asm->SymbPoint = NULL;
+  }
+}
+
+static void ListDefines( AsmPointer Asm, SymbolTable *Table )
+{
+  SymbolPointer Head;
+  unsigned int Count;
+
+  SortSymbols( Asm, Table );
+  for( Count = 0; Count < Table->Count; Count++ ) {
+    Head = Table->Sorted[ Count ];
+    if( Head->Value )
+      ListText( Asm, "DEF %s\n", Head->Symbol );
+    else
+      ListText( Asm, "UND %s\n", Head->Symbol );
+  }
+}
+
+static void ListWarnings( AsmPointer Asm )
+{
+  ListText( Asm, "%s%u\n", WarningNumMessage, Asm->WarningCount );
+}
+
+static char *AssertSpace( AsmPointer Asm, unsigned int Size )
+{
+  SpaceRecord *Chain;
+
+  Chain = &( Asm->Space );
+  if( Chain->Request )
+    RunError( Asm, True, SpaceAssertError );
+  if( Size + sizeof( char * ) > Chain->Size )
+    RunError( Asm, True, SpaceAssertError );
+  if( !( Chain->Start )) {
+    Chain->Start = ( char * )malloc( Chain->Size );
+    if( !( Chain->Start ))
+      RunError( Asm, True, AllocationError );
+    Chain->Point = NULL;
+  }
+  if( !( Chain->Point )) {
+    Chain->Point = Chain->Start;
+    Chain->Index = NULL;
+  }
+  if( !( Chain->Index )) {
+    *( char ** )Chain->Point = NULL;
+    Chain->Index = Chain->Point + sizeof( char * );
+  }
+  Chain->Index = Chain->Point + (( Chain->Index - Chain->Point + SpaceAlign -
+    1 ) / SpaceAlign ) * SpaceAlign;
+  if( Chain->Index + Size > Chain->Point + Chain->Size ) {
+    char *This;
+
+    This = ( char * )malloc( Chain->Size );
+    if( !This )
+      RunError( Asm, True, AllocationError );
+    *( char ** )Chain->Point = This;
+    Chain->Point = This;
+    *( char ** )This = NULL;
+    Chain->Index = This + sizeof( char * );
+  }
+  Chain->Request = Size;
+  return( Chain->Index );
+}
+
+static void ClaimSpace( AsmPointer Asm, unsigned int Size )
+{
+  SpaceRecord *Chain;
+
+  Chain = &( Asm->Space );
+  if( !( Chain->Request ))
+    RunError( Asm, True, SpaceAssertError );
+  if( Size > Chain->Request )
+    RunError( Asm, True, SpaceAssertError );
+  Chain->Index += Size;
+  Chain->Request = 0;
+}
+
+/* Also called after a fatal error, with a request possibly pending */
+static void ReleaseSpace( AsmPointer Asm )
+{
+  SpaceRecord *Chain;
+  char *This;
+  char *Next;
+
+  Chain = &( Asm->Space );
+  for( This = Chain->Start; This; ) {
+    Next = *( char ** )This;
+    free( This );
+    This = Next;
+  }
+  Chain->Start = NULL;
+  Chain->Point = NULL;
+  Chain->Index = NULL;
+  Chain->Request = 0;
+}
+
+static char *ReadFile( const char *FileName, size_t *Size )
+{
+  FILE *File;
+  char *Result;
+  long int Length;
+
+  File = fopen( FileName, "rb" );
+  if( !File )
+    return( NULL );
+  Result = NULL;
+  if(( fseek( File, 0L, SEEK_END ) == 0 ) && (( Length = ftell( File )) >= 0 )
+    && ( fseek( File, 0L, SEEK_SET ) == 0 )) {
+      Result = ( char * )malloc(( size_t )Length + 1 );
+      if( Result && ( fread( Result, 1, ( size_t )Length, File ) !=
+        ( size_t )Length )) {
+          free( Result );
+          Result = NULL;
+      }
+      *Size = ( size_t )Length;
+  }
+  fclose( File );
+  return( Result );
+}
+
+/* Each file is noted before it is read, a missing one included */
+static void NoteInclude( AsmPointer Asm, const char *Dir, size_t Length,
+  const char *FileName )
+{
+  AppendText( Asm, &( Asm->Includes ), Dir, Length );
+  AppendText( Asm, &( Asm->Includes ), FileName, strlen( FileName ));
+  AppendText( Asm, &( Asm->Includes ), "\n", 1 );
+}
+
+/* Include files are found next to the main source unless a reader is given */
+static char *ReadSource( AsmPointer Asm, const char *FileName, size_t *Size )
+{
+  const char *Slash;
+  char *Path;
+  char *Result;
+  size_t Length;
+
+  if( Asm->Read ) {
+    NoteInclude( Asm, "", 0, FileName );
+    return( Asm->Read( FileName, Size, Asm->UserData ));
+  }
+  Slash = Asm->SourceName ? strrchr( Asm->SourceName, '/' ) : NULL;
+  if(( *FileName == '/' ) || !Slash ) {
+    NoteInclude( Asm, "", 0, FileName );
+    return( ReadFile( FileName, Size ));
+  }
+  Length = ( size_t )( Slash - Asm->SourceName ) + 1;
+  NoteInclude( Asm, Asm->SourceName, Length, FileName );
+  Path = ( char * )malloc( Length + strlen( FileName ) + 1 );
+  if( !Path )
+    RunError( Asm, True, AllocationError );
+  memcpy( Path, Asm->SourceName, Length );
+  strcpy( Path + Length, FileName );
+  Result = ReadFile( Path, Size );
+  free( Path );
+  return( Result );
+}
+
+static void DefineReference( AsmPointer Asm, LocPointer Loc,
+  ReferPointer *Head )
+{
+  ReferPointer This;
+  ReferPointer Ref;
+  ReferPointer Last;
+  int Compare;
+
+  if( Loc ) {
+    This = ( ReferPointer )AssertSpace( Asm, sizeof( ReferRecord ));
+    ClaimSpace( Asm, sizeof( ReferRecord ));
+    This->Loc = *Loc;
+    This->Next = NULL;
+    for( Last = NULL, Ref = *Head; Ref; ) {
+      Compare = strcmp( Loc->Name, Ref->Loc.Name );
+      if( !Compare ) {
+        if( Loc->Line < Ref->Loc.Line ) {
+          This->Next = Ref;
+          Ref = NULL;
+        } else {
+          Last = Ref;
+          Ref = Ref->Next;
+        }
+      } else
+        if( Compare < 0 ) {
+          This->Next = Ref;
+          Ref = NULL;
+        } else {
+          Last = Ref;
+          Ref = Ref->Next;
+        }
+    }
+    if( !Last )
+      *Head = This;
+    else
+      if(( Loc->Line != Last->Loc.Line ) || ( Loc->Name != Last->Loc.Name ))
+        Last->Next = This;
+  }
+}
+
+static char *StripSymbol( char *Result, const char *Symbol )
+{
+  char *Last;
+
+  if( *Symbol == SymbolChar )
+    Symbol++;
+  strncpy( Result, Symbol, SymbolLength );
+  Result[ SymbolLength ] = NullChar;
+  Last = Result + strlen( Result ) - 1;
+  if( *Last == LabelChar )
+    *Last = NullChar;
+  return( Result );
+}
+
+static unsigned int HashSymbol( const char *Symbol )
+{
+  unsigned int Hash;
+
+  for( Hash = 2166136261U; *Symbol; Symbol++ )
+    Hash = ( Hash ^ ( unsigned char )*Symbol ) * 16777619U;
+  return( Hash );
+}
+
+static SymbolPointer FindSymbol( const SymbolTable *Table, const char *Symbol,
+  unsigned int Hash )
+{
+  SymbolPointer Symb;
+
+  for( Symb = Table->Bucket[ Hash % HashLength ]; Symb; Symb = Symb->Next )
+    if(( Symb->Hash == Hash ) && !strcmp( Symbol, Symb->Symbol ))
+      return( Symb );
+  return( NULL );
+}
+
+static char DefineSymbol( AsmPointer Asm, const char *RawSymbol,
+  long int Value, SymbolTable *Table, LocPointer Loc )
+{
+  SymbolString Symbol;
+  SymbolPointer Symb;
+  unsigned int Hash;
+
+  StripSymbol( Symbol, RawSymbol );
+  Hash = HashSymbol( Symbol );
+  Symb = FindSymbol( Table, Symbol, Hash );
+  if( Symb ) {
+    Symb->Value = Value;
+    Symb->Expr = NULL;
+    Symb->Label = False;
+    if( Loc )
+      Symb->Loc = *Loc;
+    else
+      Symb->Loc = NullLocation;
+    if( Symb->Loc.Xref )
+      DefineReference( Asm, &( Symb->Loc ), &( Symb->Refer ));
+    Asm->CurrentSymbol = Symb;
+    return( False );
+  }
+  Symb = ( SymbolPointer )AssertSpace( Asm, sizeof( SymbolRecord ));
+  ClaimSpace( Asm, sizeof( SymbolRecord ));
+  Symb->Symbol = ( char * )AssertSpace( Asm, sizeof( SymbolString ));
+  strcpy( Symb->Symbol, Symbol );
+  ClaimSpace( Asm, ( unsigned int )( strlen( Symb->Symbol ) + 1 ));
+  Symb->Value = Value;
+  Symb->Expr = NULL;
+  Symb->Label = False;
+  if( Loc )
+    Symb->Loc = *Loc;
+  else
+    Symb->Loc = NullLocation;
+  Symb->Refer = NULL;
+  if( *Asm->UsedOnCond )
+    DefineReference( Asm, &NullLocation, &( Symb->Refer ));
+  Symb->Hash = Hash;
+  Symb->Next = Table->Bucket[ Hash % HashLength ];
+  Table->Bucket[ Hash % HashLength ] = Symb;
+  Table->Count++;
+  Asm->CurrentSymbol = Symb;
+  return( True );
+}
+
+static char ResolveOption( const char *Option, long int *YesNoPoint,
+  long int *OnOffPoint )
+{
+  char Result;
+
+  Result = True;
+  if( !strcmp( Option, OptionYesName )) {
+    *YesNoPoint = Defined;
+    Result = False;
+  }
+  if( !strcmp( Option, OptionNoName )) {
+    *YesNoPoint = UnDefined;
+    Result = False;
+  }
+  if( !strcmp( Option, OptionOnName )) {
+    *OnOffPoint = Defined;
+    Result = False;
+  }
+  if( !strcmp( Option, OptionOffName )) {
+    *OnOffPoint = UnDefined;
+    Result = False;
+  }
+  return( Result );
+}
+
+static char ResolveSymbol( AsmPointer Asm, const char *RawSymbol,
+  long int *Value, SymbolTable *Table, LocPointer Loc )
+{
+  SymbolString Symbol;
+  SymbolPointer Head;
+  char Result;
+
+  Result = False;
+  *Value = 0L;
+  StripSymbol( Symbol, RawSymbol );
+  Head = FindSymbol( Table, Symbol, HashSymbol( Symbol ));
+  if( Head ) {
+    *Value = Head->Value;
+    if( Loc )
+      if( Loc->Xref )
+        DefineReference( Asm, Loc, &( Head->Refer ));
+    if( !( Head->Expr ))
+      Result = True;
+  }
+  return( Result );
+}
+
+static char ResolveNumber( const char *Symbol, int Base, long int *Value )
+{
+  const char *Digit;
+  char Result;
+  unsigned int Count;
+  unsigned int Length;
+
+  Result = True;
+  if( !( *Symbol ))
+    Result = False;
+  *Value = 0L;
+  Length = strlen( Symbol );
+  for( Count = 1; Count <= Length; Count++ ) {
+    Digit = strchr( DigitText, Symbol[ Count - 1 ]);
+    if( !Digit ) {
+      Result = False;
+      Count = Length;
+    } else {
+      if(( Digit - DigitText ) >= MaxBaseLength )
+        Digit = DigitText;
+      if(( Digit - DigitText ) > Base ) {
+        Result = False;
+        Count = Length;
+      } else
+        *Value = Base * ( *Value ) + ( Digit - DigitText );
+    }
+  }
+  return( Result );
+}
+
+static char ResolveValue( AsmPointer Asm, const char *Symbol, long int *Value,
+  SymbolTable *Table, LocPointer Loc )
+{
+  char Result;
+
+  Result = False;
+  *Value = 0L;
+  if(( Symbol[ 0 ] == AddressChar ) && !( Symbol[ 1 ]) && Loc ) {
+    *Value = Loc->Addr;
+    return( True );
+  }
+  switch( Symbol[ 0 ]) {
+    case HexChar:
+      Result = ResolveNumber( Symbol + 1, 16, Value );
+      break;
+    case BinChar:
+      Result = ResolveNumber( Symbol + 1, 2, Value );
+      break;
+    case OctChar:
+      Result = ResolveNumber( Symbol + 1, 8, Value );
+      break;
+    case AscChar:
+      if( Symbol[ 1 ]) {
+        *Value = Symbol[ 1 ];
+        if( !( Symbol[ 2 ]))
+        Result = True;
+      }
+      break;
+    default:
+      if( isdigit(( unsigned char )Symbol[ 0 ]))
+        Result = ResolveNumber( Symbol, 10, Value );
+      else
+        Result = ResolveSymbol( Asm, Symbol, Value, Table, Loc );
+      break;
+  }
+  return( Result );
+}
+
+static char *SplitParam( char *Result, char **Param )
+{
+  char *Start;
+  char *Count;
+  char *Store;
+  char Reading;
+
+  Store = Result;
+  *Store = NullChar;
+  Reading = True;
+  for( Start = NULL, Count = *Param; *Count; Count++ )
+    if( isgraph(( unsigned char )*Count )) {
+      Start = Count;
+      Count = NullString;
+    }
+  if( Start ) {
+    Count = Start;
+    if( Operators[ ( unsigned char )*Count ]) {
+      *( Store++ ) = *Count;
+      *( Store++ ) = NullChar;
+      *Param = Count + 1;
+      Reading = False;
+    } else
+      for( ; *Count; Count++ )
+        if(( !isgraph(( unsigned char )*Count )) ||
+          Operators[ ( unsigned char )*Count ]) {
+            *Param = Count;
+            Count = NullString;
+            Reading = False;
+        } else
+          *( Store++ ) = *Count;
+  }
+  if( Reading )
+    *Param = NullString;
+  *( Store++ ) = NullChar;
+  return( Result );
+}
+
+static char ResolveOperator( const char *Symbol, char *Token,
+  const char *Legal )
+{
+  *Token = *Symbol;
+  if(( *Token ) && strchr( Legal, *Token ))
+    return( True );
+  else
+    return( False );
+}
+
+static char ResolveSingle( char Token, long int *Value )
+{
+  char Result;
+
+  Result = True;
+  switch( Token ) {
+    case PlusChar:
+      /* Nothing to be done */
+      break;
+    case MinusChar:
+      *Value = -( *Value );
+      break;
+    case NotChar:
+      *Value = ~( *Value );
+      break;
+    default:
+      Result = False;
+      break;
+  }
+  return( Result );
+}
+
+static char ResolveDouble( char Token, long int *Value, long int Operand )
+{
+  long int Count;
+  long int This;
+  char Result;
+
+  Result = True;
+  switch( Token ) {
+    case PowerChar:
+      This = 1;
+      for( Count = 1; Count <= Operand; Count++ )
+        This *= *Value;
+      *Value = This;
+      break;
+    case ShlChar:
+      *Value <<= Operand;
+      break;
+    case ShrChar:
+      *Value >>= Operand;
+      break;
+    case MulChar:
+      *Value *= Operand;
+      break;
+    case FracChar:
+    case DivChar:
+      *Value /= Operand;
+      break;
+    case PlusChar:
+      *Value += Operand;
+      break;
+    case MinusChar:
+      *Value -= Operand;
+      break;
+    case AndChar:
+      *Value &= Operand;
+      break;
+    case OrChar:
+      *Value |= Operand;
+      break;
+    case XorChar:
+      *Value ^= Operand;
+      break;
+    case ModChar:
+      *Value %= Operand;
+      break;
+    default:
+      Result = False;
+      break;
+  }
+  return( Result );
+}
+
+static char ResolveParent( AsmPointer Asm, char *Symbol, char **Param,
+  long int *Value, SymbolTable *Table, LocPointer Loc )
+{
+  char Token;
+  char Status;
+
+  if( ResolveOperator( Symbol, &Token, StartOperator )) {
+    SplitParam( Symbol, Param );
+    Status = ResolveDivMod( Asm, Symbol, Param, Value, Table, Loc );
+    if( !ResolveOperator( Symbol, &Token, StopOperator ))
+      Status = False;
+    SplitParam( Symbol, Param );
+  } else {
+    Status = ResolveValue( Asm, Symbol, Value, Table, Loc );
+    SplitParam( Symbol, Param );
+  }
+  return( Status );
+}
+
+static char ResolveUnary( AsmPointer Asm, char *Symbol, char **Param,
+  long int *Value, SymbolTable *Table, LocPointer Loc )
+{
+  char Token;
+  char Status;
+
+  if( ResolveOperator( Symbol, &Token, UnaryOperator )) {
+    SplitParam( Symbol, Param );
+    Status = ResolveParent( Asm, Symbol, Param, Value, Table, Loc );
+    Status = Status & ResolveSingle( Token, Value );
+  } else
+    Status = ResolveParent( Asm, Symbol, Param, Value, Table, Loc );
+  return( Status );
+}
+
+static char ResolvePower( AsmPointer Asm, char *Symbol, char **Param,
+  long int *Value, SymbolTable *Table, LocPointer Loc )
+{
+  long int Operand;
+  char Token;
+  char Status;
+
+  Operand = 0L;
+  Status = ResolveUnary( Asm, Symbol, Param, Value, Table, Loc );
+  while( ResolveOperator( Symbol, &Token, PowerOperator )) {
+    SplitParam( Symbol, Param );
+    Status = Status & ResolveUnary( Asm, Symbol, Param, &Operand, Table, Loc );
+    Status = Status & ResolveDouble( Token, Value, Operand );
+  }
+  return( Status );
+}
+
+static char ResolveMulDiv( AsmPointer Asm, char *Symbol, char **Param,
+  long int *Value, SymbolTable *Table, LocPointer Loc )
+{
+  long int Operand;
+  char Token;
+  char Status;
+
+  Operand = 0L;
+  Status = ResolvePower( Asm, Symbol, Param, Value, Table, Loc );
+  while( ResolveOperator( Symbol, &Token, MulDivOperator )) {
+    SplitParam( Symbol, Param );
+    Status = Status & ResolvePower( Asm, Symbol, Param, &Operand, Table, Loc );
+    Status = Status & ResolveDouble( Token, Value, Operand );
+  }
+  return( Status );
+}
+
+static char ResolvePlusMinus( AsmPointer Asm, char *Symbol, char **Param,
+  long int *Value, SymbolTable *Table, LocPointer Loc )
+{
+  long int Operand;
+  char Token;
+  char Status;
+
+  Operand = 0L;
+  Status = ResolveMulDiv( Asm, Symbol, Param, Value, Table, Loc );
+  while( ResolveOperator( Symbol, &Token, PlusMinusOperator )) {
+    SplitParam( Symbol, Param );
+    Status = Status & ResolveMulDiv( Asm, Symbol, Param, &Operand, Table,
+      Loc );
+    Status = Status & ResolveDouble( Token, Value, Operand );
+  }
+  return( Status );
+}
+
+static char ResolveBitWise( AsmPointer Asm, char *Symbol, char **Param,
+  long int *Value, SymbolTable *Table, LocPointer Loc )
+{
+  long int Operand;
+  char Token;
+  char Status;
+
+  Operand = 0L;
+  Status = ResolvePlusMinus( Asm, Symbol, Param, Value, Table, Loc );
+  while( ResolveOperator( Symbol, &Token, BitWiseOperator )) {
+    SplitParam( Symbol, Param );
+    Status = Status & ResolvePlusMinus( Asm, Symbol, Param, &Operand, Table,
+      Loc );
+    Status = Status & ResolveDouble( Token, Value, Operand );
+  }
+  return( Status );
+}
+
+static char ResolveDivMod( AsmPointer Asm, char *Symbol, char **Param,
+  long int *Value, SymbolTable *Table, LocPointer Loc )
+{
+  long int Operand;
+  char Token;
+  char Status;
+
+  Operand = 0L;
+  Status = ResolveBitWise( Asm, Symbol, Param, Value, Table, Loc );
+  while( ResolveOperator( Symbol, &Token, DivModOperator )) {
+    SplitParam( Symbol, Param );
+    Status = Status & ResolveBitWise( Asm, Symbol, Param, &Operand, Table,
+      Loc );
+    Status = Status & ResolveDouble( Token, Value, Operand );
+  }
+  return( Status );
+}
+
+static char ResolveExpression( AsmPointer Asm, char **Param, long int *Value,
+  SymbolTable *Table, LocPointer Loc )
+{
+  SymbolString Symbol;
+  char Result;
+
+  Result = False;
+  *Value = 0L;
+  SplitParam( Symbol, Param );
+  if( *Symbol )
+    Result = ResolveDivMod( Asm, Symbol, Param, Value, Table, Loc );
+  if( *Symbol )
+    return( False );
+  else
+    return( Result );
+}
+
+static void MissingEquations( AsmPointer Asm, SymbolTable *Table )
+{
+  unsigned int Count;
+
+  SortSymbols( Asm, Table );
+  for( Count = 0; Count < Table->Count; Count++ )
+    if( Table->Sorted[ Count ]->Expr ) {
+      Asm->SymbPoint = Table->Sorted[ Count ];
+      RunError( Asm, False, UndefinedWarning );
+      Asm->SymbPoint = NULL;
+    }
+}
+
+static unsigned int ResolveTraversal( AsmPointer Asm, SymbolTable *Table )
+{
+  SymbolPointer Symb;
+  char *Expression;
+  long int Value;
+  unsigned int Bucket;
+  unsigned int Count;
+
+  Count = 0;
+  for( Bucket = 0; Bucket < HashLength; Bucket++ )
+    for( Symb = Table->Bucket[ Bucket ]; Symb; Symb = Symb->Next )
+      if( Symb->Expr ) {
+        Expression = Symb->Expr;
+        if( ResolveExpression( Asm, &Expression, &Value, Table,
+          &( Symb->Loc ))) {
+            Symb->Value = Value;
+            Symb->Expr = NULL;
+        } else
+          Count++;
+      }
+  return( Count );
+}
+
+static void ResolveEquations( AsmPointer Asm, SymbolTable *Table )
+{
+  unsigned int Count;
+  unsigned int Remains;
+
+  Count = 0;
+  do {
+    Remains = Count;
+    Count = ResolveTraversal( Asm, Table );
+  } while( Count && ( Count != Remains ));
+  if( Count )
+    MissingEquations( Asm, Table );
+}
+
+static void StoreSymbolList( AsmPointer Asm, const SymbolString SymbolText[],
+  unsigned int Count, SymbolTable *Table )
+{
+  unsigned int This;
+
+  for( This = 0; This < Count; This++ )
+    if( !DefineSymbol( Asm, SymbolText[ This ], ( long int )This, Table,
+      &NullLocation ))
+        RunError( Asm, False, CopySymbolWarning );
+}
+
+static char *SplitLine( char *Result, char **Line, char AbortFlag )
+{
+  char *Start;
+  char *Count;
+  char *Store;
+  int Level;
+  char TextFlag;
+  char Reading;
+
+  Store = Result;
+  *Store = NullChar;
+  Level = 0;
+  TextFlag = False;
+  Reading = True;
+  for( Start = NULL, Count = *Line; *Count; Count++ )
+    if( *Count == RemarkChar )
+      Count = NullString;
+    else
+      if( isgraph(( unsigned char )*Count ) && ( *Count != SeparatorChar )) {
+        Start = Count;
+        Count = NullString;
+      }
+  if( Start ) {
+    for( Count = Start; *Count && ( Count < Start + ParamLength ); Count++ )
+      if( *Count == TextChar ) {
+        if(( Count != Start ) && ( *( Count - 1 ) == TextChar ))
+          *( Store++ ) = TextChar;
+        TextFlag = ( char )~TextFlag;
+      } else
+        if( TextFlag )
+          *( Store++ ) = *Count;
+        else
+          switch( *Count ) {
+            case SeparatorChar:
+              if( !Level ) {
+                *Line = Count;
+                Reading = False;
+                Count = NullString;
+              } else
+                *( Store++ ) = *Count;
+              break;
+            case RemarkChar:
+              *Line = NullString;
+              Reading = False;
+              Count = NullString;
+              break;
+            case StartChar:
+              Level++;
+              *( Store++ ) = *Count;
+              break;
+            case StopChar:
+              Level--;
+              *( Store++ ) = *Count;
+              break;
+            default:
+              if( isgraph(( unsigned char )*Count ))
+                *( Store++ ) = ( char )toupper(( unsigned char )*Count );
+              else
+                if( AbortFlag && ( !Level )) {
+                  *Line = Count;
+                  Reading = False;
+                  Count = NullString;
+                } else
+                  if( Store != Result )
+                   if( *( Store - 1 ) != SpaceChar )
+                     *( Store++ ) = SpaceChar;
+              break;
+          }
+  }
+  if( Reading )
+    *Line = NullString;
+  if( Store != Result )
+    *( Store-- ) = NullChar;
+  while( *Store == SpaceChar )
+    if( Store > Result )
+      *( Store-- ) = NullChar;
+    else
+      *Store = NullChar;
+  return( Result );
+}
+
+static void AlignWordBounds( AsmPointer Asm )
+{
+  if( *Asm->AlignOnCond )
+    Asm->Location.Addr = (( Asm->Location.Addr + 1 ) >> 1 ) << 1;
+  if( Asm->Location.Addr > Asm->FinalAddress )
+    Asm->FinalAddress = Asm->Location.Addr;
+  if(( Asm->Location.Addr < StartAddress ) ||
+    ( Asm->Location.Addr > StopAddress ))
+      RunError( Asm, True, BoundsError );
+}
+
+static char ParamCheck( AsmPointer Asm, unsigned int Count, unsigned int Min,
+  unsigned int Max )
+{
+  if(( Count < Min ) || ( Count > Max ))
+    RunError( Asm, False, ParamCountWarning );
+  if( Count >= Min )
+    return( True );
+  else
+    return( False );
+}
+
+static char RangeCheck( AsmPointer Asm, long int Value, long int Min,
+  long int Max, const char *Message )
+{
+  if(( Value < Min ) || ( Value > Max )) {
+    RunError( Asm, False, Message );
+    return( True );
+  } else
+    return( False );
+}
+
+static char DecodeOption( AsmPointer Asm, const char *Option )
+{
+  char Result;
+
+  Result = True;
+  if( !strcmp( Option, Chip8Name )) {
+    *Asm->Chip8Cond = Defined;
+    *Asm->Chip48Cond = Defined;
+    *Asm->Super10Cond = UnDefined;
+    *Asm->Super11Cond = UnDefined;
+    *Asm->HpHeadCond = UnDefined;
+    *Asm->HpAscCond = UnDefined;
+    Result = False;
+  }
+  if( !strcmp( Option, Chip48Name )) {
+    *Asm->Chip8Cond = UnDefined;
+    *Asm->Chip48Cond = Defined;
+    *Asm->Super10Cond = UnDefined;
+    *Asm->Super11Cond = UnDefined;
+    *Asm->HpHeadCond = Defined;
+    Result = False;
+  }
+  if( !strcmp( Option, Super10Name )) {
+    *Asm->Chip8Cond = UnDefined;
+    *Asm->Chip48Cond = UnDefined;
+    *Asm->Super10Cond = Defined;
+    *Asm->Super11Cond = UnDefined;
+    *Asm->HpHeadCond = Defined;
+    Result = False;
+  }
+  if( !strcmp( Option, Super11Name )) {
+    *Asm->Chip8Cond = UnDefined;
+    *Asm->Chip48Cond = UnDefined;
+    *Asm->Super10Cond = Defined;
+    *Asm->Super11Cond = Defined;
+    *Asm->HpHeadCond = Defined;
+    Result = False;
+  }
+  if( !strcmp( Option, HpBinName )) {
+    *Asm->HpHeadCond = Defined;
+    *Asm->HpAscCond = UnDefined;
+    Result = False;
+  }
+  if( !strcmp( Option, HpAscName )) {
+    *Asm->HpHeadCond = Defined;
+    *Asm->HpAscCond = Defined;
+    Result = False;
+  }
+  if( !strcmp( Option, BinaryName )) {
+    *Asm->HpHeadCond = UnDefined;
+    *Asm->HpAscCond = UnDefined;
+    Result = False;
+  }
+  if( !strcmp( Option, StringName )) {
+    *Asm->HpHeadCond = UnDefined;
+    *Asm->HpAscCond = Defined;
+    Result = False;
+  }
+  return( Result );
+}
+
+static unsigned int DecodeParameters( AsmPointer Asm, char **Line,
+  ParamPointer *Head )
+{
+  ParamString FoundWord;
+  ParamPointer Param;
+  ParamPointer Last;
+  unsigned int Count;
+
+  *Head = NULL;
+  Count = 0;
+  for( Last = NULL; **Line; )
+    if( *SplitLine( FoundWord, Line, False )) {
+      Param = ( ParamPointer )AssertSpace( Asm, sizeof( ParamRecord ));
+      ClaimSpace( Asm, sizeof( ParamRecord ));
+      Param->Param = ( char * )AssertSpace( Asm, sizeof( ParamString ));
+      strcpy( Param->Param, FoundWord );
+      ClaimSpace( Asm, ( unsigned int )( strlen( Param->Param ) + 1 ));
+      Param->Next = NULL;
+      if( Last )
+        Last->Next = Param;
+      else
+        *Head = Param;
+      Last = Param;
+      Count++;
+    }
+  return( Count );
+}
+
+static void DecodeDirective( AsmPointer Asm, unsigned int Token, char **Line )
+{
+  ParamPointer Params;
+  InstPointer Inst;
+  unsigned int Count;
+
+  Count = DecodeParameters( Asm, Line, &Params );
+  switch( Token ) {
+    case ElseToken:
+      ParamCheck( Asm, Count, 0, 0 );
+      if( Asm->StackPoint == Asm->StackStart )
+        RunError( Asm, False, MissingIfdefWarning );
+      else
+        *Asm->StackPoint = ( char )~( *Asm->StackPoint );
+      break;
+    case EndifToken:
+      ParamCheck( Asm, Count, 0, 0 );
+      if( Asm->StackPoint <= Asm->StackStart )
+        RunError( Asm, False, MissingIfdefWarning );
+      else
+        Asm->StackPoint--;
+      break;
+    case IfdefToken:
+    case IfundToken:
+      if( ParamCheck( Asm, Count, 1, 1 )) {
+        long int Value;
+
+        if( !ResolveSymbol( Asm, Params->Param, &Value, &( Asm->Conditions ),
+          &NullLocation ))
+            Value = 0L;
+        if( Token == IfundToken )
+          Value = ~Value;
+        if( Asm->StackPoint >= Asm->StackStart + StackLength )
+          RunError( Asm, True, NestedIfdefError );
+        else
+          if( Value )
+            *( ++Asm->StackPoint ) = True;
+          else
+            *( ++Asm->StackPoint ) = False;
+      }
+      break;
+    default:
+      if( *Asm->StackPoint ) {
+        switch( Token ) {
+          case WrongToken:
+            RunError( Asm, False, InternalWarning );
+            break;
+          case AlignToken:
+            if( ParamCheck( Asm, Count, 1, 1 ))
+              if( ResolveOption( Params->Param, Asm->AlignOnCond,
+                Asm->AlignOnCond ))
+                  RunError( Asm, False, NoOptionWarning );
+            break;
+          case DefineToken:
+          case UndefToken:
+            if( ParamCheck( Asm, Count, 1, 1 )) {
+              if( Token == DefineToken )
+                DefineSymbol( Asm, Params->Param, Defined, &( Asm->Conditions ),
+                  &NullLocation );
+              else
+                DefineSymbol( Asm, Params->Param, UnDefined,
+                  &( Asm->Conditions ), &NullLocation );
+            }
+            break;
+          case EqualToken:
+          case EquToken:
+            if( !Asm->CurrentSymbol )
+              RunError( Asm, False, MissingSymbolWarning );
+            else
+              if( ParamCheck( Asm, Count, 1, 1 )) {
+                char *Expression;
+
+                Expression = ( char * )AssertSpace( Asm, sizeof( ParamString ));
+                Asm->CurrentSymbol->Expr = strcpy( Expression, Params->Param );
+                Asm->CurrentSymbol->Label = False;
+                ClaimSpace( Asm, ( unsigned int )( strlen( Expression ) + 1 ));
+              }
+            break;
+          case DsToken:
+            if( ParamCheck( Asm, Count, 1, 1 )) {
+              char *FirstParam;
+              long int Value;
+
+              FirstParam = Params->Param;
+              if( !ResolveExpression( Asm, &FirstParam, &Value,
+                &( Asm->Symbols ), &( Asm->Location )))
+                  RunError( Asm, False, UndefinedWarning );
+              Asm->Location.Addr += Value;
+            }
+            break;
+          case OptionToken:
+            if( ParamCheck( Asm, Count, 1, 1 ))
+              if( DecodeOption( Asm, Params->Param ))
+                RunError( Asm, False, NoOptionWarning );
+            break;
+          case OrgToken:
+            if( ParamCheck( Asm, Count, 1, 1 )) {
+              char *FirstParam;
+              long int Value;
+
+              FirstParam = Params->Param;
+              if( ResolveExpression( Asm, &FirstParam, &Value,
+                &( Asm->Symbols ), &( Asm->Location )))
+                  Asm->Location.Addr = Value;
+              else
+                RunError( Asm, False, UndefinedWarning );
+            }
+            break;
+          case IncludeToken:
+            if( ParamCheck( Asm, Count, 1, 1 )) {
+              LocRecord StoreLoc;
+              char *IncludeName;
+              char *Source;
+              size_t Size;
+
+              if( Asm->Depth >= IncludeLength )
+                RunError( Asm, True, NestedIncludeError );
+              StoreLoc = Asm->Location;
+              for( IncludeName = Params->Param; *IncludeName; IncludeName++ )
+                *IncludeName = ( char )tolower(( unsigned char )*IncludeName );
+              IncludeName = ( char * )AssertSpace( Asm, sizeof( LineString ));
+              strcpy( IncludeName, Params->Param );
+              ClaimSpace( Asm, ( unsigned int )( strlen( IncludeName ) + 1 ));
+              Source = ReadSource( Asm, IncludeName, &Size );
+              if( !Source )
+                RunError( Asm, True, NoSourceError );
+              Asm->Sources[ Asm->Depth++ ] = Source;
+              DecodeFile( Asm, IncludeName, Source, Size );
+              free( Asm->Sources[ --Asm->Depth ]);
+              Asm->Location = StoreLoc;
+              ListText( Asm, "Reading: %s\n\n", Asm->Location.Name );
+            }
+            break;
+          case EndToken:
+            ParamCheck( Asm, Count, 0, 0 );
+            /* The END directive is ignored */
+            break;
+          case UsedToken:
+            if( ParamCheck( Asm, Count, 1, ListLength )) {
+              if( ResolveOption( Params->Param, Asm->UsedYesCond,
+                Asm->UsedOnCond )) {
+                  ParamPointer Point;
+                  long int Value;
+
+                  for( Point = Params; Point; Point = Point->Next )
+                    if( *Asm->XrefOnCond ) {
+                      if( !ResolveSymbol( Asm, Point->Param, &Value,
+                        &( Asm->Symbols ), &( Asm->Location )))
+                          if( !Value )
+                            RunError( Asm, False, NoSymbolWarning );
+                    } else
+                      if( !ResolveSymbol( Asm, Point->Param, &Value,
+                        &( Asm->Symbols ), &UsedLocation ))
+                          if( !Value )
+                            RunError( Asm, False, NoSymbolWarning );
+              } else
+                if( Count > 1 )
+                  RunError( Asm, False, ParamCountWarning );
+            }
+            break;
+          case XrefToken:
+            if( ParamCheck( Asm, Count, 1, 1 ))
+              if( ResolveOption( Params->Param, Asm->XrefYesCond,
+                Asm->XrefOnCond ))
+                  RunError( Asm, False, NoOptionWarning );
+            break;
+          default:
+            Inst = ( InstPointer )AssertSpace( Asm, sizeof( InstRecord ));
+            ClaimSpace( Asm, sizeof( InstRecord ));
+            Inst->Loc = Asm->Location;
+            Inst->Token = Token;
+            Inst->Count = Count;
+            Inst->Params = Params;
+            Inst->Next = NULL;
+            if( Asm->LastInst )
+              Asm->LastInst->Next = Inst;
+            else
+              Asm->Instructions = Inst;
+            Asm->LastInst = Inst;
+            switch( Token ) {
+              case DbToken:
+                if( ParamCheck( Asm, Count, 1, ListLength ))
+                  Asm->Location.Addr += Count;
+                break;
+              case DwToken:
+                if( ParamCheck( Asm, Count, 1, ListLength ))
+                  Asm->Location.Addr += Count * 2;
+                break;
+              case DaToken:
+                if( ParamCheck( Asm, Count, 1, 1 ))
+                  Asm->Location.Addr += strlen( Params->Param );
+                break;
+              default:
+                Asm->Location.Addr += 2;
+                break;
+            }
+          break;
+        }
+      }
+      break;
+  }
+}
+
+static void DecodeLine( AsmPointer Asm, char **Line )
+{
+  ParamString Split;
+  long int Value;
+
+  Asm->CurrentSymbol = NULL;
+  while( **Line )
+    if( *SplitLine( Split, Line, True )) {
+      if( !ResolveSymbol( Asm, Split, &Value, &( Asm->Directives ),
+        &NullLocation )) {
+          if( *Asm->StackPoint ) {
+            if( Asm->CurrentSymbol ) {
+              RunError( Asm, False, DualSymbolWarning );
+              *Line = NullString;
+            } else {
+              if( !DefineSymbol( Asm, Split, Asm->Location.Addr,
+                &( Asm->Symbols ), &( Asm->Location )))
+                  RunError( Asm, False, CopySymbolWarning );
+              Asm->CurrentSymbol->Label = True;
+            }
+          }
+      } else {
+        DecodeDirective( Asm, ( unsigned int )Value, Line );
+        AlignWordBounds( Asm );
+        *Line = NullString;
+      }
+    }
+  Asm->CurrentSymbol = NULL;
+}
+
+/* Same lines as fgets( Result, LineLength + 1, File ) */
+static char ReadLine( char *Result, const char *Source, size_t Size,
+  size_t *Point )
+{
+  char *Store;
+
+  if( *Point >= Size )
+    return( False );
+  for( Store = Result; ( *Point < Size ) && ( Store < Result + LineLength ); )
+    if(( *( Store++ ) = Source[ ( *Point )++ ]) == '\n' )
+      break;
+  *Store = NullChar;
+  return( True );
+}
+
+static void DecodeFile( AsmPointer Asm, char *FileName, const char *Source,
+  size_t Size )
+{
+  char *StoreStack;
+  char *Line;
+  size_t Point;
+
+  StoreStack = Asm->StackPoint;
+  ListText( Asm, "Reading: %s\n\n", FileName );
+  Asm->Location.Text = ( char * )AssertSpace( Asm, sizeof( LineString ));
+  *( Asm->Location.Text ) = NullChar;
+  Asm->Location.Name = FileName;
+  Asm->Location.Line = 1;
+  for( Point = 0; ReadLine( Asm->Location.Text, Source, Size, &Point ); ) {
+    ClaimSpace( Asm, ( unsigned int )( strlen( Asm->Location.Text ) + 1 ));
+    if( *Asm->XrefOnCond )
+      Asm->Location.Xref = True;
+    else
+      Asm->Location.Xref = False;
+    for( Line = Asm->Location.Text; *Line; Line++ )
+      if( iscntrl(( unsigned char )*Line ))
+        *Line = SpaceChar;
+    Line = Asm->Location.Text;
+    DecodeLine( Asm, &Line );
+    Asm->Location.Text = ( char * )AssertSpace( Asm, sizeof( LineString ));
+    *( Asm->Location.Text ) = NullChar;
+    Asm->Location.Line++;
+  }
+  strcpy( Asm->Location.Text, EndOfFileMessage );
+  ClaimSpace( Asm, ( unsigned int )( strlen( Asm->Location.Text ) + 1 ));
+  if( StoreStack != Asm->StackPoint )
+    RunError( Asm, False, CountDefineWarning );
+  Asm->Location = NullLocation;
+}
+
+static void StoreWord( AsmPointer Asm, long int Address, long int Value )
+{
+  Asm->Memory[ Address - StartAddress ] = ( unsigned char )
+    (( Value & 0xff00L ) >> 8 );
+  Asm->Memory[ Address - StartAddress + 1 ] = ( unsigned char )
+    ( Value & 0xffL );
+}
+
+static void EncodeNoneToken( AsmPointer Asm, InstPointer Inst,
+  long int OpCode, const long int *Ver10, const long int *Ver11 )
+{
+  ParamCheck( Asm, Inst->Count, 0, 0 );
+  /* Generate instruction anyway */
+  if( !( *Ver11 ))
+    RunError( Asm, False, NeedsSuper11Warning );
+  if( !( *Ver10 ))
+    RunError( Asm, False, NeedsSuper10Warning );
+  StoreWord( Asm, Inst->Loc.Addr, OpCode );
+  ListInstruction( Asm, Inst->Loc.Addr, 2, Inst );
+}
+
+static void EncodeValToken( AsmPointer Asm, InstPointer Inst, long int OpCode,
+  long int Limit, SymbolTable *Symb, const long int *Ver8,
+  const long int *Ver11 )
+{
+  long int Value;
+
+  Value = 0L;
+  if( ParamCheck( Asm, Inst->Count, 1, 1 )) {
+    char *FirstParam;
+
+    FirstParam = Inst->Params->Param;
+    if( !ResolveExpression( Asm, &FirstParam, &Value, Symb, &( Inst->Loc )))
+      RunError( Asm, False, UndefinedWarning );
+  }
+  if( RangeCheck( Asm, Value, 0L, Limit, RangeWarning ))
+    Value &= Limit;
+  if( !( *Ver11 ))
+    RunError( Asm, False, NeedsSuper11Warning );
+  if( !( *Ver8 ))
+    RunError( Asm, False, NeedsChip8Warning );
+  Value |= OpCode;
+  StoreWord( Asm, Inst->Loc.Addr, Value );
+  ListInstruction( Asm, Inst->Loc.Addr, 2, Inst );
+}
+
+static void EncodeRegToken( AsmPointer Asm, InstPointer Inst, long int OpCode,
+  SymbolTable *Reg )
+{
+  long int RegX;
+
+  RegX = ( long int )V0Reg;
+  if( ParamCheck( Asm, Inst->Count, 1, 1 )) {
+    if( ResolveSymbol( Asm, Inst->Params->Param, &RegX, Reg, &NullLocation ))
+      RegX -= V0Reg;
+    else
+      RunError( Asm, False, NoRegisterWarning );
+  }
+  if( RangeCheck( Asm, RegX, 0L, NibbleMask, BadRegisterWarning ))
+    RegX = 0L;
+  RegX = OpCode | ( RegX << 8 );
+  StoreWord( Asm, Inst->Loc.Addr, RegX );
+  ListInstruction( Asm, Inst->Loc.Addr, 2, Inst );
+}
+
+static void EncodeRegValToken( AsmPointer Asm, InstPointer Inst,
+  long int OpCode, SymbolTable *Reg, SymbolTable *Symb )
+{
+  long int RegX;
+  long int Value;
+
+  RegX = ( long int )V0Reg;
+  Value = 0L;
+  if( Inst->Count >= 1 ) {
+    if( ResolveSymbol( Asm, Inst->Params->Param, &RegX, Reg, &NullLocation ))
+      RegX -= V0Reg;
+    else
+      RunError( Asm, False, NoRegisterWarning );
+  }
+  if( RangeCheck( Asm, RegX, 0L, NibbleMask, BadRegisterWarning ))
+    RegX = 0L;
+  if( ParamCheck( Asm, Inst->Count, 2, 2 )) {
+    char *SecondParam;
+
+    SecondParam = Inst->Params->Next->Param;
+    if( !ResolveExpression( Asm, &SecondParam, &Value, Symb, &( Inst->Loc )))
+      RunError( Asm, False, UndefinedWarning );
+  }
+  if( RangeCheck( Asm, Value, 0L, ByteMask, RangeWarning ))
+    Value &= ByteMask;
+  Value |= OpCode | ( RegX << 8 );
+  StoreWord( Asm, Inst->Loc.Addr, Value );
+  ListInstruction( Asm, Inst->Loc.Addr, 2, Inst );
+}
+
+static void EncodeRegRegToken( AsmPointer Asm, InstPointer Inst,
+  long int OpCode, unsigned int Min, SymbolTable *Reg )
+{
+  long int RegX;
+  long int RegY;
+
+  RegX = ( long int )V0Reg;
+  RegY = 0L;
+  if( ParamCheck( Asm, Inst->Count, Min, 2 )) {
+    if( ResolveSymbol( Asm, Inst->Params->Param, &RegX, Reg, &NullLocation ))
+      RegX -= V0Reg;
+    else
+      RunError( Asm, False, NoRegisterWarning );
+  }
+  if( RangeCheck( Asm, RegX, 0L, NibbleMask, BadRegisterWarning ))
+    RegX = 0L;
+  if( Inst->Count >= 2 ) {
+    if( ResolveSymbol( Asm, Inst->Params->Next->Param, &RegY, Reg,
+      &NullLocation ))
+        RegY -= V0Reg;
+    else
+      RunError( Asm, False, NoRegisterWarning );
+  }
+  if( RangeCheck( Asm, RegY, 0L, NibbleMask, BadRegisterWarning ))
+    RegY = 0L;
+  RegX = OpCode | ( RegX << 8 ) | ( RegY << 4 );
+  StoreWord( Asm, Inst->Loc.Addr, RegX );
+  ListInstruction( Asm, Inst->Loc.Addr, 2, Inst );
+}
+
+static void EncodeRegRegOrValToken( AsmPointer Asm, InstPointer Inst,
+  long int OpCode1, long int OpCode2, SymbolTable *Reg, SymbolTable *Symb )
+{
+  long int RegX;
+  long int RegY;
+  long int Value;
+
+  RegX = ( long int )V0Reg;
+  RegY = ( long int )V0Reg;
+  Value = 0L;
+  if( Inst->Count >= 1 ) {
+    if( ResolveSymbol( Asm, Inst->Params->Param, &RegX, Reg, &NullLocation ))
+      RegX -= V0Reg;
+    else
+      RunError( Asm, False, NoRegisterWarning );
+  }
+  if( RangeCheck( Asm, RegX, 0L, NibbleMask, BadRegisterWarning ))
+    RegX = 0L;
+  if( ParamCheck( Asm, Inst->Count, 2, 2 )) {
+    if( ResolveSymbol( Asm, Inst->Params->Next->Param, &RegY, Reg,
+      &NullLocation )) {
+        RegY -= V0Reg;
+        if( RangeCheck( Asm, RegY, 0L, NibbleMask, BadRegisterWarning ))
+          RegY = 0L;
+        Value = OpCode1 | ( RegX << 8 ) | ( RegY << 4 );
+        StoreWord( Asm, Inst->Loc.Addr, Value );
+        ListInstruction( Asm, Inst->Loc.Addr, 2, Inst );
+      } else {
+        char *SecondParam;
+
+        SecondParam = Inst->Params->Next->Param;
+        if( !ResolveExpression( Asm, &SecondParam, &Value, Symb,
+          &( Inst->Loc )))
+            RunError( Asm, False, UndefinedWarning );
+        if( RangeCheck( Asm, Value, 0L, ByteMask, RangeWarning ))
+          Value &= ByteMask;
+        Value |= OpCode2 | ( RegX << 8 );
+        StoreWord( Asm, Inst->Loc.Addr, Value );
+        ListInstruction( Asm, Inst->Loc.Addr, 2, Inst );
+      }
+  }
+}
+
+static void EncodeDrwToken( AsmPointer Asm, InstPointer Inst, long int OpCode,
+  SymbolTable *Reg, SymbolTable *Symb )
+{
+  long int RegX;
+  long int RegY;
+  long int Value;
+
+  RegX = ( long int )V0Reg;
+  RegY = ( long int )V0Reg;
+  Value = 0L;
+  if( Inst->Count >= 1 ) {
+    if( ResolveSymbol( Asm, Inst->Params->Param, &RegX, Reg, &NullLocation ))
+      RegX -= V0Reg;
+    else
+      RunError( Asm, False, NoRegisterWarning );
+  }
+  if( RangeCheck( Asm, RegX, 0L, NibbleMask, BadRegisterWarning ))
+    RegX = 0L;
+  if( Inst->Count >= 2 ) {
+    if( ResolveSymbol( Asm, Inst->Params->Next->Param, &RegY, Reg,
+      &NullLocation ))
+        RegY -= V0Reg;
+    else
+      RunError( Asm, False, NoRegisterWarning );
+  }
+  if( RangeCheck( Asm, RegY, 0L, NibbleMask, BadRegisterWarning ))
+    RegY = 0L;
+  if( ParamCheck( Asm, Inst->Count, 3, 3 )) {
+    char *ThirdParam;
+
+    ThirdParam = Inst->Params->Next->Next->Param;
+    if( !ResolveExpression( Asm, &ThirdParam, &Value, Symb, &( Inst->Loc )))
+      RunError( Asm, False, UndefinedWarning );
+  }
+  if( RangeCheck( Asm, Value, 0L, NibbleMask, RangeWarning ))
+    Value &= NibbleMask;
+  if(( Value == 0L ) && !( *Asm->Super10Cond ))
+    RunError( Asm, False, NeedsSuper10Warning );
+  Value |= OpCode | ( RegX << 8 ) | ( RegY << 4 );
+  StoreWord( Asm, Inst->Loc.Addr, Value );
+  ListInstruction( Asm, Inst->Loc.Addr, 2, Inst );
+}
+
+static void EncodeAddToken( AsmPointer Asm, InstPointer Inst,
+  SymbolTable *Reg, SymbolTable *Symb )
+{
+  long int RegX;
+  long int RegY;
+  long int Value;
+
+  RegX = ( long int )V0Reg;
+  RegY = ( long int )V0Reg;
+  Value = 0L;
+  if( Inst->Count >= 1 )
+    if( !ResolveSymbol( Asm, Inst->Params->Param, &RegX, Reg,
+      &NullLocation )) {
+        RegX = ( long int )V0Reg;
+        RunError( Asm, False, NoRegisterWarning );
+    }
+  if( RegX == ( long int )IReg ) {
+    if( ParamCheck( Asm, Inst->Count, 2, 2 )) {
+      if( ResolveSymbol( Asm, Inst->Params->Next->Param, &RegX, Reg,
+        &NullLocation ))
+          RegX -= V0Reg;
+      else
+        RunError( Asm, False, NoRegisterWarning );
+    }
+    if( RangeCheck( Asm, RegX, 0L, NibbleMask, BadRegisterWarning ))
+      RegX = 0L;
+    Value = 0xf01eL | ( RegX << 8 );
+    StoreWord( Asm, Inst->Loc.Addr, Value );
+    ListInstruction( Asm, Inst->Loc.Addr, 2, Inst );
+  } else {
+    RegX -= V0Reg;
+    if( RangeCheck( Asm, RegX, 0L, NibbleMask, BadRegisterWarning ))
+      RegX = 0L;
+    if( ParamCheck( Asm, Inst->Count, 2, 2 )) {
+      if( ResolveSymbol( Asm, Inst->Params->Next->Param, &RegY, Reg,
+        &NullLocation )) {
+          RegY -= V0Reg;
+          if( RangeCheck( Asm, RegY, 0L, NibbleMask, BadRegisterWarning ))
+            RegY = 0L;
+          Value = 0x8004L | ( RegX << 8 ) | ( RegY << 4 );
+          StoreWord( Asm, Inst->Loc.Addr, Value );
+          ListInstruction( Asm, Inst->Loc.Addr, 2, Inst );
+        } else {
+          char *SecondParam;
+
+          SecondParam = Inst->Params->Next->Param;
+          if( !ResolveExpression( Asm, &SecondParam, &Value, Symb,
+            &( Inst->Loc )))
+              RunError( Asm, False, UndefinedWarning );
+          if( RangeCheck( Asm, Value, 0L, ByteMask, RangeWarning ))
+            Value &= ByteMask;
+          Value |= 0x7000L | ( RegX << 8 );
+          StoreWord( Asm, Inst->Loc.Addr, Value );
+          ListInstruction( Asm, Inst->Loc.Addr, 2, Inst );
+        }
+    }
+  }
+}
+
+static void EncodeJpToken( AsmPointer Asm, InstPointer Inst, SymbolTable *Reg,
+  SymbolTable *Symb )
+{
+  long int RegX;
+  long int Addr;
+
+  RegX = ( long int )V0Reg;
+  Addr = ( long int )V0Reg;
+  if( ParamCheck( Asm, Inst->Count, 1, 2 )) {
+    if( ResolveSymbol( Asm, Inst->Params->Param, &RegX, Reg,
+      &NullLocation )) {
+        if( RegX != V0Reg )
+          RunError( Asm, False, BadRegisterWarning );
+        if( Inst->Count == 1 )
+          RunError( Asm, False, ParamCountWarning );
+        else {
+          char *SecondParam;
+
+          SecondParam = Inst->Params->Next->Param;
+          if( ResolveExpression( Asm, &SecondParam , &Addr, Symb,
+            &( Inst->Loc )))
+              RunError( Asm, False, UndefinedWarning );
+        }
+        if( RangeCheck( Asm, Addr, 0L, AddrMask, RangeWarning ))
+          Addr &= AddrMask;
+        Addr |= 0xb000L;
+        StoreWord( Asm, Inst->Loc.Addr, Addr );
+        ListInstruction( Asm, Inst->Loc.Addr, 2, Inst );
+      } else {
+        char *FirstParam;
+
+        FirstParam = Inst->Params->Param;
+        if( !ResolveExpression( Asm, &FirstParam, &Addr, Symb,
+          &( Inst->Loc )))
+            RunError( Asm, False, UndefinedWarning );
+        if( Inst->Count == 2 )
+          RunError( Asm, False, ParamCountWarning );
+        if( RangeCheck( Asm, Addr, 0L, AddrMask, RangeWarning ))
+          Addr &= AddrMask;
+        Addr |= 0x1000L;
+        StoreWord( Asm, Inst->Loc.Addr, Addr );
+        ListInstruction( Asm, Inst->Loc.Addr, 2, Inst );
+      }
+  }
+}
+
+static void EncodeLdToken( AsmPointer Asm, InstPointer Inst, SymbolTable *Reg,
+  SymbolTable *Symb )
+{
+  long int RegX;
+  long int RegY;
+  long int Value;
+  char RegFlag;
+
+  RegX = ( long int )V0Reg;
+  RegY = ( long int )V0Reg;
+  Value = 0L;
+  RegFlag = True;
+  if( Inst->Count >= 1 )
+    if( !ResolveSymbol( Asm, Inst->Params->Param, &RegX, Reg,
+      &NullLocation )) {
+        RegX = ( long int )V0Reg;
+        RunError( Asm, False, NoRegisterWarning );
+    }
+  switch( RegX ) {
+    case BReg:
+    case DtReg:
+    case FReg:
+    case HfReg:
+    case LfReg:
+    case RReg:
+    case StReg:
+    case IiReg:
+      RegY = RegX;
+      RegX = ( long int )V0Reg;
+      if( ParamCheck( Asm, Inst->Count, 2, 2 )) {
+        if( ResolveSymbol( Asm, Inst->Params->Next->Param, &RegX, Reg,
+          &NullLocation ))
+            RegX -= V0Reg;
+        else
+          RunError( Asm, False, NoRegisterWarning );
+      }
+      if( RangeCheck( Asm, RegX, 0L, NibbleMask, BadRegisterWarning ))
+        RegX = 0L;
+      switch( RegY ) {
+        case BReg:
+          Value = 0xf033L | ( RegX << 8 );
+          break;
+        case DtReg:
+          Value = 0xf015L | ( RegX << 8 );
+          break;
+        case FReg:
+          if( !( *Asm->Chip48Cond ))
+            RunError( Asm, False, NeedsChip48Warning );
+          Value = 0xf029L | ( RegX << 8 );
+          break;
+        case HfReg:
+          if( !( *Asm->Super10Cond ))
+            RunError( Asm, False, NeedsSuper10Warning );
+          Value = 0xf030L | ( RegX << 8 );
+          break;
+        case LfReg:
+          if( !( *Asm->Super10Cond ))
+            RunError( Asm, False, NeedsSuper10Warning );
+          Value = 0xf029L | ( RegX << 8 );
+          break;
+        case RReg:
+          if( RangeCheck( Asm, RegX, 0L, 7L, BadRegisterWarning ))
+            RegX = 0L;
+          if( !( *Asm->Super10Cond ))
+            RunError( Asm, False, NeedsSuper10Warning );
+          Value = 0xf075L | ( RegX << 8 );
+          break;
+        case StReg:
+          Value = 0xf018L | ( RegX << 8 );
+          break;
+        case IiReg:
+          Value = 0xf055L | ( RegX << 8 );
+          break;
+        default:
+          RunError( Asm, False, InternalWarning );
+          break;
+      }
+      StoreWord( Asm, Inst->Loc.Addr, Value );
+      ListInstruction( Asm, Inst->Loc.Addr, 2, Inst );
+      break;
+    case IReg:
+      if( ParamCheck( Asm, Inst->Count, 2, 2 )) {
+        char *SecondParam;
+
+        SecondParam = Inst->Params->Next->Param;
+        if( !ResolveExpression( Asm, &SecondParam, &Value, Symb,
+          &( Inst->Loc )))
+            RunError( Asm, False, UndefinedWarning );
+      }
+      if( RangeCheck( Asm, Value, 0L, AddrMask, RangeWarning ))
+        Value &= AddrMask;
+      Value |= 0xa000L;
+      StoreWord( Asm, Inst->Loc.Addr, Value );
+      ListInstruction( Asm, Inst->Loc.Addr, 2, Inst );
+      break;
+    default:
+      RegX -= V0Reg;
+      if( RangeCheck( Asm, RegX, 0L, NibbleMask, BadRegisterWarning ))
+        RegX = 0L;
+      if( ParamCheck( Asm, Inst->Count, 2, 2 ))
+        RegFlag = ResolveSymbol( Asm, Inst->Params->Next->Param, &RegY, Reg,
+          &NullLocation );
+      if( RegFlag ) {
+        switch( RegY ) {
+          case DtReg:
+            Value = 0xf007L | ( RegX << 8 );
+            break;
+          case KReg:
+            Value = 0xf00aL | ( RegX << 8 );
+            break;
+          case RReg:
+            if( RangeCheck( Asm, RegX, 0L, 7L, BadRegisterWarning ))
+              RegX = 0L;
+            if( !( *Asm->Super10Cond ))
+              RunError( Asm, False, NeedsSuper10Warning );
+            Value = 0xf085L | ( RegX << 8 );
+            break;
+          case IiReg:
+            Value = 0xf065L | ( RegX << 8 );
+            break;
+          default:
+            RegY -= V0Reg;
+            if( RangeCheck( Asm, RegY, 0L, NibbleMask, BadRegisterWarning ))
+              RegY = 0L;
+            Value = 0x8000L | ( RegX << 8 ) | ( RegY << 4 );
+            break;
+        }
+        StoreWord( Asm, Inst->Loc.Addr, Value );
+        ListInstruction( Asm, Inst->Loc.Addr, 2, Inst );
+      } else {
+        if( Inst->Count >= 2 ) {
+          char *SecondParam;
+
+          SecondParam = Inst->Params->Next->Param;
+          if( !ResolveExpression( Asm, &SecondParam, &Value, Symb,
+            &( Inst->Loc )))
+              RunError( Asm, False, UndefinedWarning );
+        }
+        if( RangeCheck( Asm, Value, 0L, ByteMask, RangeWarning ))
+          Value &= ByteMask;
+        Value |= 0x6000L | ( RegX << 8 );
+        StoreWord( Asm, Inst->Loc.Addr, Value );
+        ListInstruction( Asm, Inst->Loc.Addr, 2, Inst );
+      }
+      break;
+  }
+}
+
+static void EncodeDaToken( AsmPointer Asm, InstPointer Inst )
+{
+  char *Param;
+  char *This;
+  long int Store;
+
+  Param = NullString;
+  if( Inst->Count >= 1 )
+    Param = Inst->Params->Param;
+  Store = Inst->Loc.Addr - StartAddress;
+  for( This = Param ; *This; This++ )
+    Asm->Memory[ Store++ ] = *This;
+  ListInstruction( Asm, Inst->Loc.Addr, ( unsigned int )strlen( Param ),
+    Inst );
+}
+
+static void EncodeDbToken( AsmPointer Asm, InstPointer Inst,
+  SymbolTable *Symb )
+{
+  ParamPointer Param;
+  char *LoopParam;
+  long int Value;
+  unsigned int This;
+
+  This = 0;
+  Value = 0L;
+  for( Param = Inst->Params; Param; Param = Param->Next ) {
+    LoopParam = Param->Param;
+    if( !ResolveExpression( Asm, &LoopParam, &Value, Symb, &( Inst->Loc )))
+      RunError( Asm, False, UndefinedWarning );
+    if( RangeCheck( Asm, Value, 0L, ByteMask, RangeWarning ))
+      Value &= ByteMask;
+    Asm->Memory[ Inst->Loc.Addr + ( This++ ) - StartAddress ] =
+      ( unsigned char )Value;
+  }
+  ListInstruction( Asm, Inst->Loc.Addr, Inst->Count, Inst );
+}
+
+static void EncodeDwToken( AsmPointer Asm, InstPointer Inst,
+  SymbolTable *Symb )
+{
+  ParamPointer Param;
+  char *LoopParam;
+  long int Value;
+  unsigned int This;
+
+  This = 0;
+  Value = 0L;
+  for( Param = Inst->Params; Param; Param = Param->Next ) {
+    LoopParam = Param->Param;
+    if( !ResolveExpression( Asm, &LoopParam, &Value, Symb, &( Inst->Loc )))
+      RunError( Asm, False, UndefinedWarning );
+    if( RangeCheck( Asm, Value, 0L, WordMask, RangeWarning ))
+      Value &= WordMask;
+    StoreWord( Asm, Inst->Loc.Addr + This, Value );
+    This += 2;
+  }
+  ListInstruction( Asm, Inst->Loc.Addr, Inst->Count * 2, Inst );
+}
+
+static void EncodeInstruction( AsmPointer Asm, InstPointer Inst )
+{
+  SymbolTable *Reg;
+  SymbolTable *Symb;
+
+  Reg = &( Asm->Registers );
+  Symb = &( Asm->Symbols );
+  switch( Inst->Token ) {
+    case AddToken:
+      EncodeAddToken( Asm, Inst, Reg, Symb );
+      break;
+    case AndToken:
+      EncodeRegRegToken( Asm, Inst, 0x8002L, 2, Reg );
+      break;
+    case CallToken:
+      EncodeValToken( Asm, Inst, 0x2000L, AddrMask, Symb, &DefinedValue,
+        &DefinedValue );
+      break;
+    case ClsToken:
+      EncodeNoneToken( Asm, Inst, 0x00e0L, &DefinedValue, &DefinedValue );
+      break;
+    case DaToken:
+      EncodeDaToken( Asm, Inst );
+      break;
+    case DbToken:
+      EncodeDbToken( Asm, Inst, Symb );
+      break;
+    case DrwToken:
+      EncodeDrwToken( Asm, Inst, 0xd000L, Reg, Symb );
+      break;
+    case DwToken:
+      EncodeDwToken( Asm, Inst, Symb );
+      break;
+    case ExitToken:
+      EncodeNoneToken( Asm, Inst, 0x00fdL, Asm->Super10Cond, &DefinedValue );
+      break;
+    case HighToken:
+      EncodeNoneToken( Asm, Inst, 0x00ffL, Asm->Super10Cond, &DefinedValue );
+      break;
+    case JpToken:
+      EncodeJpToken( Asm, Inst, Reg, Symb );
+      break;
+    case LdToken:
+      EncodeLdToken( Asm, Inst, Reg, Symb );
+      break;
+    case LowToken:
+      EncodeNoneToken( Asm, Inst, 0x00feL, Asm->Super10Cond, &DefinedValue );
+      break;
+    case OrToken:
+      EncodeRegRegToken( Asm, Inst, 0x8001L, 2, Reg );
+      break;
+    case RetToken:
+      EncodeNoneToken( Asm, Inst, 0x00eeL, &DefinedValue, &DefinedValue );
+      break;
+    case RndToken:
+      EncodeRegValToken( Asm, Inst, 0xc000L, Reg, Symb );
+      break;
+    case ScdToken:
+      EncodeValToken( Asm, Inst, 0x00c0L, NibbleMask, Symb, &DefinedValue,
+        Asm->Super11Cond );
+      break;
+    case SclToken:
+      EncodeNoneToken( Asm, Inst, 0x00fcL, &DefinedValue, Asm->Super11Cond );
+      break;
+    case ScrToken:
+      EncodeNoneToken( Asm, Inst, 0x00fbL, &DefinedValue, Asm->Super11Cond );
+      break;
+    case SeToken:
+      EncodeRegRegOrValToken( Asm, Inst, 0x5000L, 0x3000L, Reg, Symb );
+      break;
+    case ShlToken:
+      EncodeRegRegToken( Asm, Inst, 0x800eL, 1, Reg );
+      break;
+    case ShrToken:
+      EncodeRegRegToken( Asm, Inst, 0x8006L, 1, Reg );
+      break;
+    case SknpToken:
+      EncodeRegToken( Asm, Inst, 0xe0a1L, Reg );
+      break;
+    case SkpToken:
+      EncodeRegToken( Asm, Inst, 0xe09eL, Reg );
+      break;
+    case SneToken:
+      EncodeRegRegOrValToken( Asm, Inst, 0x9000L, 0x4000L, Reg, Symb );
+      break;
+    case SubToken:
+      EncodeRegRegToken( Asm, Inst, 0x8005L, 2, Reg );
+      break;
+    case SubnToken:
+      EncodeRegRegToken( Asm, Inst, 0x8007L, 2, Reg );
+      break;
+    case SysToken:
+      EncodeValToken( Asm, Inst, 0x2000L, AddrMask, Symb, Asm->Chip8Cond,
+        &DefinedValue );
+      break;
+    case XorToken:
+      EncodeRegRegToken( Asm, Inst, 0x8003L, 2, Reg );
+      break;
+    default:
+      RunError( Asm, False, InternalWarning );
+      break;
+  }
+}
+
+static void EncodeMemory( AsmPointer Asm )
+{
+  InstPointer Inst;
+
+  ListText( Asm, "-----   *INSTRUCTIONS*   -----\n\n" );
+  memset( Asm->Memory, 0, sizeof( Asm->Memory ));
+  for( Inst = Asm->Instructions; Inst; Inst = Inst->Next ) {
+    Asm->InstPoint = Inst;
+    EncodeInstruction( Asm, Inst );
+  }
+  Asm->InstPoint = NULL;
+  ListText( Asm, "\n-----   *SYMBOLS*   -----\n\n" );
+  ListSymbols( Asm, &( Asm->Symbols ));
+  ListText( Asm, "\n-----   *CONDITIONS*   -----\n\n" );
+  ListDefines( Asm, &( Asm->Conditions ));
+  ListText( Asm, "\n" );
+  ListWarnings( Asm );
+}
+
+static void WriteCheckByte( AsmPointer Asm, long int *Check,
+  unsigned char Value )
+{
+  SymbolString MsbText;
+  SymbolString LsbText;
+
+  if( *Asm->HpHeadCond ) {
+    AppendText( Asm, &( Asm->Output ), NumberString( LsbText,
+      ( long int )( Value & NibbleMask ), 16, 1 ), 1 );
+    AppendText( Asm, &( Asm->Output ), NumberString( MsbText,
+      ( long int )(( Value >> 4 ) & NibbleMask ), 16, 1 ), 1 );
+  } else
+    AppendText( Asm, &( Asm->Output ), NumberString( MsbText,
+      ( long int )Value, 16, 2 ), 2 );
+  *Check = ((( *Check ) >> 4 ) ^ (((( Value ^ ( *Check )) & NibbleMask ) *
+    CheckMagic ) & WordMask ));
+  *Check = ((( *Check ) >> 4 ) ^ ((((( Value >> 4 ) ^ ( *Check )) &
+    NibbleMask ) * CheckMagic ) & WordMask ));
+}
+
+static void WriteMemory( AsmPointer Asm, long int Start, long int Stop )
+{
+  TextRecord *Output;
+
+  Output = &( Asm->Output );
+  if( *Asm->HpHeadCond ) {
+    if( *Asm->HpAscCond )
+      AppendText( Asm, Output, AscHpHeadText, strlen( AscHpHeadText ));
+    else {
+      unsigned char HpHeading[ BinHpHeadLength ];
+      long int Size;
+
+      Size = (( Stop - Start ) << 1 ) + 5;
+      memcpy( HpHeading, BinHpHeadText, BinHpHeadLength - 5 );
+      HpHeading[ BinHpHeadLength - 5 ] = 0x2c;
+      HpHeading[ BinHpHeadLength - 4 ] = 0x2a;
+      HpHeading[ BinHpHeadLength - 3 ] = ( unsigned char )( 0 | (( Size &
+        0xfL ) << 4 ));
+      HpHeading[ BinHpHeadLength - 2 ] = ( unsigned char )(( Size &
+        0xff0L ) >> 4 );
+      HpHeading[ BinHpHeadLength - 1 ] = ( unsigned char )(( Size &
+        0xff000L ) >> 12 );
+      AppendText( Asm, Output, ( char * )HpHeading, BinHpHeadLength );
+    }
+  }
+  if( *Asm->HpAscCond ) {
+    SymbolString HexText;
+    long int Count;
+    long int Check;
+
+    Check = 0L;
+    if( *Asm->HpHeadCond ) {
+      long int Size;
+
+      Size = (( Stop - Start ) << 1 ) + 5;
+      AppendText( Asm, Output, "\"", 1 );
+      WriteCheckByte( Asm, &Check, 0x2c );
+      WriteCheckByte( Asm, &Check, 0x2a );
+      WriteCheckByte( Asm, &Check, ( unsigned char )( 0 | (( Size & 0xfL )
+        << 4 )));
+      WriteCheckByte( Asm, &Check, ( unsigned char )(( Size & 0xff0L ) >> 4 ));
+      WriteCheckByte( Asm, &Check, ( unsigned char )(( Size & 0xff000L )
+        >> 12 ));
+    }
+    for( Count = Start; Count < Stop; Count++ ) {
+      WriteCheckByte( Asm, &Check, Asm->Memory[ Count - StartAddress ]);
+      if( !(( Count - Start + 6 ) % 32 ) && ( *Asm->HpHeadCond ))
+        AppendText( Asm, Output, "\n", 1 );
+    }
+    if( *Asm->HpHeadCond ) {
+      for( Count = 0; Count < 4; Count++ )
+        AppendText( Asm, Output, NumberString( HexText,
+          ( Check >> ( 4 * Count )) & NibbleMask, 16, 1 ), 1 );
+      AppendText( Asm, Output, "\"", 1 );
+    }
+  } else
+    if(( Stop - Start ) > 0L )
+      AppendText( Asm, Output, ( char * )&( Asm->Memory[ Start -
+        StartAddress ]), ( size_t )( Stop - Start ));
+}
+
+static void AssembleSource( AsmPointer Asm, const char *Source, size_t Size )
+{
+  const char *SourceName;
+
+  AppendText( Asm, &( Asm->Messages ), "", 0 );
+  AppendText( Asm, &( Asm->Output ), "", 0 );
+  if( Asm->ListFlag )
+    AppendText( Asm, &( Asm->List ), "", 0 );
+  *Asm->StackPoint = True;
+  StoreSymbolList( Asm, TokenText, LastToken, &( Asm->Directives ));
+  StoreSymbolList( Asm, RegisterText, LastReg, &( Asm->Registers ));
+  DefineSymbol( Asm, Super10Name, Super10Default, &( Asm->Conditions ),
+    &NullLocation );
+  Asm->Super10Cond = &( Asm->CurrentSymbol->Value );
+  DefineSymbol( Asm, Chip48Name, Chip48Default, &( Asm->Conditions ),
+    &NullLocation );
+  Asm->Chip48Cond = &( Asm->CurrentSymbol->Value );
+  DefineSymbol( Asm, UsedYesName, UsedYesDefault, &( Asm->Conditions ),
+    &NullLocation );
+  Asm->UsedYesCond = &( Asm->CurrentSymbol->Value );
+  DefineSymbol( Asm, AlignOnName, AlignOnDefault, &( Asm->Conditions ),
+    &NullLocation );
+  Asm->AlignOnCond = &( Asm->CurrentSymbol->Value );
+  DefineSymbol( Asm, HpAscName, HpAscDefault, &( Asm->Conditions ),
+    &NullLocation );
+  Asm->HpAscCond = &( Asm->CurrentSymbol->Value );
+  DefineSymbol( Asm, Super11Name, Super11Default, &( Asm->Conditions ),
+    &NullLocation );
+  Asm->Super11Cond = &( Asm->CurrentSymbol->Value );
+  DefineSymbol( Asm, XrefOnName, XrefOnDefault, &( Asm->Conditions ),
+    &NullLocation );
+  Asm->XrefOnCond = &( Asm->CurrentSymbol->Value );
+  DefineSymbol( Asm, Chip8Name, Chip8Default, &( Asm->Conditions ),
+    &NullLocation );
+  Asm->Chip8Cond = &( Asm->CurrentSymbol->Value );
+  DefineSymbol( Asm, HpHeadName, HpHeadDefault, &( Asm->Conditions ),
+    &NullLocation );
+  Asm->HpHeadCond = &( Asm->CurrentSymbol->Value );
+  DefineSymbol( Asm, UsedOnName, UsedOnDefault, &( Asm->Conditions ),
+    &NullLocation );
+  Asm->UsedOnCond = &( Asm->CurrentSymbol->Value );
+  DefineSymbol( Asm, XrefYesName, XrefYesDefault, &( Asm->Conditions ),
+    &NullLocation );
+  Asm->XrefYesCond = &( Asm->CurrentSymbol->Value );
+  Asm->CurrentSymbol = NULL;
+  SourceName = Asm->SourceName ? Asm->SourceName : DefaultSourceName;
+  Asm->FileName = ( char * )malloc( strlen( SourceName ) + 1 );
+  if( !( Asm->FileName ))
+    RunError( Asm, True, AllocationError );
+  strcpy( Asm->FileName, SourceName );
+  DecodeFile( Asm, Asm->FileName, Source, Size );
+  ListText( Asm, "Done reading\n\n" );
+  ResolveEquations( Asm, &( Asm->Symbols ));
+  EncodeMemory( Asm );
+  WriteMemory( Asm, StartAddress, Asm->FinalAddress );
+}
+
+static int CompareLabels( const void *Left, const void *Right )
+{
+  const Chipper_Symbol *First = ( const Chipper_Symbol * )Left;
+  const Chipper_Symbol *Second = ( const Chipper_Symbol * )Right;
+
+  if( First->address != Second->address )
+    return(( First->address < Second->address ) ? -1 : 1 );
+  return( strcmp( First->name, Second->name ));
+}
+
+/* Labels only, EQU and register names are no addresses */
+static void KeepSymbols( AsmPointer Asm, Chipper_Result *Result )
+{
+  SymbolPointer Symb;
+  unsigned int Bucket;
+  size_t Count;
+
+  Result->symbols = ( Chipper_Symbol * )malloc(( Asm->Symbols.Count + 1 ) *
+    sizeof( Chipper_Symbol ));
+  if( !Result->symbols )
+    return;
+  for( Count = 0, Bucket = 0; Bucket < HashLength; Bucket++ )
+    for( Symb = Asm->Symbols.Bucket[ Bucket ]; Symb; Symb = Symb->Next )
+      if( Symb->Label ) {
+        strcpy( Result->symbols[ Count ].name, Symb->Symbol );
+        Result->symbols[ Count++ ].address = ( unsigned int )Symb->Value;
+      }
+  qsort( Result->symbols, Count, sizeof( Chipper_Symbol ), CompareLabels );
+  Result->symbol_count = Count;
+}
+
+static int KeepImage( AsmPointer Asm, Chipper_Result *Result )
+{
+  Result->image_size = ( size_t )( Asm->FinalAddress - StartAddress );
+  Result->image = ( unsigned char * )malloc( Result->image_size + 1 );
+  if( !Result->image ) {
+    Result->image_size = 0;
+    return( CHIPPER_ERROR );
+  }
+  memcpy( Result->image, Asm->Memory, Result->image_size );
+  Result->output = ( unsigned char * )Asm->Output.Start;
+  Result->output_size = Asm->Output.Length;
+  Asm->Output.Start = NULL;
+  KeepSymbols( Asm, Result );
+  return( CHIPPER_OK );
+}
+
+int Chipper_Assemble( const char *Source, size_t Size,
+  const Chipper_Options *Options, Chipper_Result *Result )
+{
+  AsmPointer Asm;
+  int Status;
+
+  memset( Result, 0, sizeof( Chipper_Result ));
+  Asm = ( AsmPointer )calloc( 1, sizeof( Assembler ));
+  if( !Asm )
+    return( CHIPPER_ERROR );
+  Asm->Space.Size = SpaceLength;
+  Asm->StackPoint = Asm->StackStart;
+  Asm->AlignOnCond = &( Asm->DummyValue );
+  Asm->Chip8Cond = &( Asm->DummyValue );
+  Asm->Chip48Cond = &( Asm->DummyValue );
+  Asm->Super10Cond = &( Asm->DummyValue );
+  Asm->Super11Cond = &( Asm->DummyValue );
+  Asm->UsedYesCond = &( Asm->DummyValue );
+  Asm->UsedOnCond = &( Asm->DummyValue );
+  Asm->XrefYesCond = &( Asm->DummyValue );
+  Asm->XrefOnCond = &( Asm->DummyValue );
+  Asm->HpHeadCond = &( Asm->DummyValue );
+  Asm->HpAscCond = &( Asm->DummyValue );
+  Asm->FinalAddress = StartAddress;
+  Asm->Location = NullLocation;
+  Asm->Location.Addr = StartAddress;
+  if( Options ) {
+    Asm->SourceName = Options->name;
+    Asm->ListFlag = Options->listing ? True : False;
+    Asm->Read = Options->read;
+    Asm->UserData = Options->user_data;
+  }
+  if( setjmp( Asm->Abort ))
+    Status = CHIPPER_ERROR;
+  else {
+    AssembleSource( Asm, Source, Size );
+    Status = KeepImage( Asm, Result );
+  }
+  if( Asm->OutOfMemory ) {
+    free( Asm->Messages.Start );
+    Asm->Messages.Start = NULL;
+  }
+  Result->listing = Asm->List.Start;
+  Result->messages = Asm->Messages.Start;
+  Result->includes = Asm->Includes.Start;
+  Result->warnings = Asm->WarningCount;
+  while( Asm->Depth )
+    free( Asm->Sources[ --Asm->Depth ]);
+  free( Asm->FileName );
+  free( Asm->Directives.Sorted );
+  free( Asm->Registers.Sorted );
+  free( Asm->Symbols.Sorted );
+  free( Asm->Conditions.Sorted );
+  free( Asm->Output.Start );
+  ReleaseSpace( Asm );
+  free( Asm );
+  return( Status );
+}
+
+int Chipper_AssembleFile( const char *Path, const Chipper_Options *Options,
+  Chipper_Result *Result )
+{
+  Chipper_Options Named;
+  char *Source;
+  size_t Size;
+  int Status;
+
+  memset( Result, 0, sizeof( Chipper_Result ));
+  memset( &Named, 0, sizeof( Chipper_Options ));
+  if( Options )
+    Named = *Options;
+  if( !Named.name )
+    Named.name = Path;
+  Size = 0;
+  Source = ReadFile( Path, &Size );
+  if( !Source )
+    return( CHIPPER_ERROR );
+  Status = Chipper_Assemble( Source, Size, &Named, Result );
+  free( Source );
+  return( Status );
+}
+
+void Chipper_Free( Chipper_Result *Result )
+{
+  free( Result->image );
+  free( Result->output );
+  free( Result->listing );
+  free( Result->messages );
+  free( Result->includes );
+  free( Result->symbols );
+  memset( Result, 0, sizeof( Chipper_Result ));
+}
+
+int Chipper_IsSource( const char *Path )
+{
+  const char *Extension;
+
+  Extension = strrchr( Path, '.' );
+  return( Extension && ( !strcasecmp( Extension, ".chp" ) ||
+    !strcasecmp( Extension, ".src" )));
+}
@@ -0,0 +1,69 @@
+#ifndef CHIPPER_H
+#define CHIPPER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+#define CHIPPER_VERSION "(S)Chip-48 Assembler V2.11 by Christian Egeberg 20/8-'91"
+
+#define CHIPPER_OK    0
+#define CHIPPER_ERROR -1                                                  // fatal error, see messages
+
+#define CHIPPER_SYMBOL_LENGTH 32
+
+/**
+ * @brief Reads the source of an INCLUDE directive
+ *
+ * Return a malloc'd buffer released by the assembler with free, or NULL if the file is
+ * missing. The name is lower case, as written in the source.
+*/
+typedef char *(*Chipper_ReadFunc)(const char *name, size_t *size, void *user_data);
+
+typedef struct {
+    const char         *name;                                             // source name in messages and the listing
+    int                 listing;                                          // also produce the listing
+    Chipper_ReadFunc    read;                                             // NULL reads files relative to the directory of name
+    void               *user_data;
+} Chipper_Options;
+
+typedef struct {
+    char                name[CHIPPER_SYMBOL_LENGTH + 1];
+    unsigned int        address;
+} Chipper_Symbol;
+
+/**
+ * @brief Outcome of one assembly, all buffers are owned by the result
+ *
+ * The image is the program as loaded at 0x200. The output is the target file chipper
+ * writes for it: the image itself, or an HP48 object when the source asks for one with
+ * OPTION. Messages hold the warnings and errors in chipper's format. Includes list the
+ * INCLUDE files the assembly tried to read, also when it failed. Symbols are the labels
+ * of the source in address order, EQU constants are left out.
+*/
+typedef struct {
+    unsigned char      *image;
+    size_t              image_size;
+    unsigned char      *output;
+    size_t              output_size;
+    char               *listing;                                          // NULL unless requested
+    char               *messages;                                         // NUL terminated, NULL only when out of memory
+    char               *includes;                                         // one path per line, as read, NULL if none
+    unsigned int        warnings;
+    Chipper_Symbol     *symbols;
+    size_t              symbol_count;
+} Chipper_Result;
+
+// Each call runs its own assembler, calls may run concurrently
+int  Chipper_Assemble(const char *source, size_t size, const Chipper_Options *options, Chipper_Result *result);
+int  Chipper_AssembleFile(const char *path, const Chipper_Options *options, Chipper_Result *result);   // Name defaults to the path
+void Chipper_Free(Chipper_Result *result);
+int  Chipper_IsSource(const char *path);                                  // .chp or .src, in any case
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
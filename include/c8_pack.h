@@ -0,0 +1,68 @@
+#ifndef C8_PACK_H
+#define C8_PACK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "chip8.h"
+
+#define C8_PACK_MAGIC     0x4B503843                                  // "C8PK"
+#define C8_PACK_VERSION   1
+#define C8_PACK_ALIGNMENT 16                                          // of each ROM image
+
+/**
+ * @brief ROM archive mapped once for batch runs
+ *
+ * Layout: header, entries sorted by name, a string table of NUL terminated names and
+ * keymaps (offset 0 is the empty string), then the ROM images. Settings are resolved
+ * from the config files when the pack is built, loading an entry is a plain copy out of
+ * the mapping, see c8pack.
+*/
+typedef struct {
+    uint32_t    magic;
+    uint32_t    version;
+    uint32_t    count;                                                // entries
+    uint32_t    strings;                                              // string table offset from the start of the pack
+    uint32_t    strings_size;
+    uint32_t    size;                                                 // whole pack in bytes
+} C8_PackHeader;
+
+typedef struct {
+    uint64_t    hash;                                                 // C8_Hash of the image
+    uint32_t    name;                                                 // string table offsets
+    uint32_t    keys;                                                 // 0 for the default keymap
+    uint32_t    offset;                                               // image from the start of the pack
+    uint32_t    size;
+    float       clockspeed;
+    float       fps;
+    float       speed;
+    uint8_t     wrapy;
+    uint8_t     xochip;
+    uint16_t    reserved;
+} C8_PackEntry;
+
+typedef struct {
+    const BYTE          *base;
+    size_t               size;
+    const C8_PackEntry  *entries;
+    uint32_t             count;
+    const char          *strings;
+    uint32_t             strings_size;
+} C8_Pack;
+
+int  C8_PackOpen(C8_Pack *pack, const char *path);                    // Return 0 on success, -1 if missing or not a valid pack
+void C8_PackClose(C8_Pack *pack);
+int  C8_IsPack(const char *path);                                     // Check the magic only
+
+const C8_PackEntry *C8_PackFind(const C8_Pack *pack, const char *name);
+const char *C8_PackString(const C8_Pack *pack, uint32_t offset);
+const BYTE *C8_PackImage(const C8_Pack *pack, const C8_PackEntry *entry);
+int  C8_PackLoad(C8_Context *context, const C8_Pack *pack, const C8_PackEntry *entry);   // Set the variant and copy the image
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
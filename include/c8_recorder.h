@@ -0,0 +1,78 @@
+#ifndef C8_RECORDER_H
+#define C8_RECORDER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <pthread.h>
+#include "chip8.h"
+
+#define RECORDER_QUEUE_LENGTH 64                                      // frames waiting for the encoder
+#define C8_RLE_MAGIC          "C8RL"
+#define C8_RLE_VERSION        1
+
+typedef enum {
+    C8_RECORD_Y4M,                                                    // grayscale 128x64 video, lores frames doubled
+    C8_RECORD_PPM,                                                    // one <path>NNNNNN.ppm per distinct frame
+    C8_RECORD_RLE                                                     // 1bpp run-length stream, see below
+} C8_RecordFormat;
+
+/*
+ * RLE stream: C8_RLE_MAGIC, a version byte, then one record per distinct frame:
+ *   uint64 frame index (little endian), BYTE width, BYTE height, BYTE plane count,
+ *   then for each plane the runs of its width*height pixels in row-major order,
+ *   alternating from a run of 0 bits, each length as an unsigned LEB128.
+ * A frame lasts until the index of the next record, the stream ends with a record
+ * of plane count 0 holding the total frame count.
+ */
+
+typedef struct {
+    C8_RecordFormat format;
+    int             scale;                                            // pixel scale of Y4M and PPM frames
+    int             fps;                                              // Y4M frame rate
+    int             block;                                            // wait for the encoder instead of dropping frames
+} C8_RecordOptions;
+
+// Copy of the display, usable with the C8_DISPLAY_* and C8_GET_PIXEL macros
+typedef struct {
+    uint64_t        display[SCREEN_PLANE_COUNT * SCREEN_BUFFER_SIZE_IN_WORDS];
+    int             hires;
+    uint64_t        index;
+} C8_RecordFrame;
+
+typedef struct {
+    C8_RecordOptions    options;
+    FILE               *out;                                          // NULL for PPM sequences
+    char               *path;
+
+    /* producer side */
+    C8_RecordFrame      last;                                         // last queued frame, to skip duplicates
+    uint64_t            frames;
+    uint64_t            duplicates;
+    uint64_t            dropped;
+
+    /* bounded queue, encoder thread */
+    pthread_t           thread;
+    pthread_mutex_t     lock;
+    pthread_cond_t      not_empty;
+    pthread_cond_t      not_full;
+    C8_RecordFrame     *queue;
+    int                 head;
+    int                 count;
+    int                 closing;
+    int                 error;                                        // set by the encoder on I/O failure
+} C8_Recorder;
+
+C8_RecordFormat C8_RecordFormatFromPath(const char *path);             // .y4m, .rle, PPM otherwise
+int  C8_RecorderOpen(C8_Recorder *recorder, const char *path, const C8_RecordOptions *options);  // Return 0 on success
+void C8_RecorderPush(C8_Recorder *recorder, const C8_Context *context);    // Call once per frame, never blocks unless options.block
+int  C8_RecorderClose(C8_Recorder *recorder);                         // Flush and join the encoder. Return 0 if every frame was written
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
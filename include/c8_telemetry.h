@@ -0,0 +1,68 @@
+#ifndef C8_TELEMETRY_H
+#define C8_TELEMETRY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "chip8.h"
+
+#define C8_TELEMETRY_MAGIC   0x54384843                               // "CH8T"
+#define C8_TELEMETRY_VERSION 1
+
+/**
+ * @brief Live state published to a memory-mapped file
+ *
+ * Readers map the file read-only and copy a snapshot with C8_TelemetryRead. The writer
+ * never waits on them: `seq` is odd while an update is in progress and readers retry
+ * until they copied a stable snapshot.
+*/
+typedef struct {
+    uint64_t    cycles;                                               // executed instructions
+    uint64_t    timestamp_ns;                                         // CLOCK_MONOTONIC at publication
+    double      instructions_per_second;                              // since the previous publication
+    double      frame_time_ms;                                        // reported by the frontend
+    uint32_t    frames;
+    uint32_t    error;                                                // C8_ErrorEnum
+    WORD        pc;
+    WORD        sp;
+    WORD        addressI;
+    BYTE        registers[REGISTER_COUNT];
+    BYTE        delay_timer;
+    BYTE        sound_timer;
+    BYTE        hires;
+    BYTE        planes;
+    BYTE        is_running;
+    uint64_t    display[SCREEN_PLANE_COUNT * SCREEN_BUFFER_SIZE_IN_WORDS];
+} C8_TelemetrySnapshot;
+
+typedef struct {
+    uint32_t                magic;
+    uint32_t                version;
+    uint32_t                size;                                     // sizeof(C8_TelemetryPage)
+    uint32_t                seq;                                      // seqlock, odd while writing
+    C8_TelemetrySnapshot    snapshot;
+} C8_TelemetryPage;
+
+typedef struct {
+    C8_TelemetryPage       *page;                                     // NULL when closed
+    uint64_t                last_cycles;
+    uint64_t                last_timestamp_ns;
+} C8_Telemetry;
+
+/* Writer */
+int  C8_TelemetryOpen(C8_Telemetry *telemetry, const char *path);     // Create or truncate, return 0 on success
+void C8_TelemetryPublish(C8_Telemetry *telemetry, const C8_Context *context, double frame_time_ms);
+void C8_TelemetryClose(C8_Telemetry *telemetry);
+
+/* Reader */
+const C8_TelemetryPage *C8_TelemetryMap(const char *path);             // NULL if missing or incompatible
+int                     C8_TelemetryRead(const C8_TelemetryPage *page, C8_TelemetrySnapshot *snapshot);  // Return 0 on success
+void                    C8_TelemetryUnmap(const C8_TelemetryPage *page);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
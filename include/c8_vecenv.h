@@ -0,0 +1,72 @@
+#ifndef C8_VECENV_H
+#define C8_VECENV_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <pthread.h>
+#include "chip8.h"
+
+#define VECENV_OBS_WIDTH   SCREEN_WIDTH
+#define VECENV_OBS_HEIGHT  SCREEN_HEIGHT
+#define VECENV_OBS_SIZE    (VECENV_OBS_WIDTH * VECENV_OBS_HEIGHT)   // bytes per instance
+
+// Reward of the step that just ran. Set *done to end the episode, exits and errors always do.
+typedef float (*C8_RewardCallback)(const C8_Context *context, int *done, void *user_data);
+
+typedef struct {
+    C8_Config           config;
+    int                 threads;                                      // <= 1 steps on the calling thread
+    int                 frameskip;                                    // frames per step, keys held for all of them
+    int                 cycles_per_frame;                             // instructions between 60hz timer updates
+    uint32_t            seed;                                         // CXNN seed of instance i is derived from seed, i and the episode
+    C8_RewardCallback   reward;                                       // optional
+    void               *user_data;
+} C8_VecEnvOptions;
+
+/**
+ * @brief N contexts stepped together
+ *
+ * Observations are written by the workers straight into the caller's buffer, one byte per
+ * pixel holding the color index, N x VECENV_OBS_HEIGHT x VECENV_OBS_WIDTH. Hires frames are
+ * downsampled, a pixel is lit if any of its 2x2 block is. Finished instances are reset
+ * within the step, their observation is the first of the next episode.
+*/
+typedef struct {
+    C8_VecEnvOptions    options;
+    int                 count;
+    C8_Context         *contexts;
+    BYTE               *initial_state;                                // loaded ROM, restored on reset
+    uint32_t           *episodes;
+
+    /* caller buffers */
+    BYTE               *observations;                                 // count * VECENV_OBS_SIZE
+    float              *rewards;                                      // count
+    BYTE               *dones;                                        // count
+    const uint16_t     *actions;                                      // held keys mask of each instance
+
+    /* thread pool */
+    pthread_t          *threads;
+    pthread_mutex_t     lock;
+    pthread_cond_t      start;
+    pthread_cond_t      finished;
+    unsigned            generation;                                   // incremented for each job
+    int                 job;
+    int                 pending;
+    int                 stopping;
+    int                 next_worker;                                  // shard handed to the next started thread
+} C8_VecEnv;
+
+int  C8_VecEnvCreate(C8_VecEnv *env, const char *path, int count, const C8_VecEnvOptions *options);  // Return 0 on success
+void C8_VecEnvSetBuffers(C8_VecEnv *env, BYTE *observations, float *rewards, BYTE *dones);
+void C8_VecEnvReset(C8_VecEnv *env);                                  // Reset every instance and write observations
+void C8_VecEnvStep(C8_VecEnv *env, const uint16_t *actions);          // actions[count] key masks
+void C8_VecEnvDestroy(C8_VecEnv *env);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -11,21 +11,33 @@ extern "C" {
 #include <time.h>
 #include "c8_helper.h"
 
-#define MEMORY_SIZE_IN_BYTES 0xFFF
+#define MEMORY_SIZE_IN_BYTES 0x10000                                   // XO-CHIP 64KiB address space
 #define USER_MEMORY_START 0x200
 #define USER_MEMORY_END   0xE9F
 #define USER_MEMORY_SIZE_IN_BYTES (USER_MEMORY_END-USER_MEMORY_START)
+#define XO_USER_MEMORY_END 0xFF9F                                     // XO-CHIP moves the stack to the top page
+#define STACK_SIZE_IN_BYTES 0x60
 #define REGISTER_COUNT 16
+#define RPL_FLAG_COUNT 16
 #define SCREEN_WIDTH 64
 #define SCREEN_HEIGHT 32
-#define SCREEN_BUFFER_SIZE_IN_BITS  ( SCREEN_WIDTH * SCREEN_HEIGHT)
+#define SCREEN_HIRES_WIDTH  128
+#define SCREEN_HIRES_HEIGHT 64
+#define SCREEN_ROW_WORDS            ( SCREEN_HIRES_WIDTH / 64 )                        // 64 pixels per packed word
+#define SCREEN_BUFFER_SIZE_IN_WORDS ( SCREEN_ROW_WORDS * SCREEN_HIRES_HEIGHT )
+#define SCREEN_BUFFER_SIZE_IN_BITS  ( SCREEN_HIRES_WIDTH * SCREEN_HIRES_HEIGHT )
 #define SCREEN_BUFFER_SIZE_IN_BYTES ( SCREEN_BUFFER_SIZE_IN_BITS / 8 )
+#define SCREEN_PLANE_COUNT 2                                          // XO-CHIP bitplanes
+#define AUDIO_PATTERN_SIZE_IN_BYTES 16
+#define DEFAULT_PITCH 64
 
 #define DEFAULT_WRAPY 1
+#define DEFAULT_SEED  0x2545F491
 
 typedef struct _C8_Context C8_Context;
 typedef void (*C8_KeyChangeNotifier)(C8_Context*, int);
 typedef void (*C8_BeepCallback)(void *);
+typedef void (*C8_AudioPatternCallback)(void *, const BYTE *pattern, BYTE pitch);
 
 typedef enum {
     C8_GOOD,
@@ -33,24 +45,85 @@ typedef enum {
     C8_STACKUNDERFLOW,
     C8_REFUSED_MEM_ACCESS,
     C8_LOAD_CANNOT_OPEN_FILE,
+    C8_LOAD_CANNOT_READ_FILE,
     C8_LOAD_CANNOT_OPEN_CONFIG,
     C8_LOAD_MEMORY_BUFFER_TOO_LARGE,
     C8_DECODE_INVALID_OPCODE,
-    C8_CLEAR_SCREEN
+    C8_CLEAR_SCREEN,
+    C8_EXIT,
+    C8_BREAK                                                        // watchpoint hit, the instruction completed
 } C8_ErrorEnum;
 
+// Why the program stopped, recorded on the cold path only. Faults clear is_running so
+// C8_Run checks them once per batch, and leave pc after the faulting instruction.
 typedef struct {
     C8_ErrorEnum err;
-    char *msg;
+    WORD         pc;                                                // faulting instruction
+    WORD         opcode;
+    WORD         address;                                           // accessed address, jump target or stack pointer
 } C8_Error;
 
+// Whether guest memory still matches code compiled ahead of time, see c8_recompiler.cc
+typedef enum {
+    C8_CODE_VERIFIED,
+    C8_CODE_WRITTEN,                                                // memory written since last verification
+    C8_CODE_MODIFIED                                                // compiled code is stale, interpret
+} C8_CodeState;
+
+/* Breakpoints */
+#define MAX_BREAKPOINTS 64
+#define C8_BREAK_EXEC   0x1                                         // PC breakpoint
+#define C8_BREAK_READ   0x2                                         // data read by DXYN, 5XY3, F002, FX65
+#define C8_BREAK_WRITE  0x4                                         // data written by 5XY2, FX33, FX55
+#define C8_COND_REG_I   REGISTER_COUNT                              // condition on I instead of VX
+
+typedef enum {
+    C8_COND_ALWAYS,
+    C8_COND_EQ,
+    C8_COND_NE,
+    C8_COND_LT,
+    C8_COND_GT
+} C8_ConditionOp;
+
+typedef struct {
+    C8_ConditionOp  op;
+    int             reg;                                            // 0 to F for VX, C8_COND_REG_I
+    WORD            value;
+} C8_Condition;
+
+typedef struct {
+    int             access;                                         // C8_BREAK_* mask, 0 for a free slot
+    WORD            address;
+    WORD            size;                                           // watched bytes from address
+    C8_Condition    condition;
+} C8_Breakpoint;
+
+typedef struct {
+    int             id;
+    int             access;                                         // the C8_BREAK_* access that triggered
+    WORD            pc;                                             // instruction address
+    WORD            address;                                        // accessed address
+    uint64_t        cycle;                                          // cycles count when execution stopped
+} C8_BreakHit;
+
+// Allocated while any breakpoint is set, see C8_AddBreakpoint
+typedef struct {
+    C8_Breakpoint   breakpoints[MAX_BREAKPOINTS];
+    BYTE            map[MEMORY_SIZE_IN_BYTES];                      // C8_BREAK_* mask of every address
+    int             armed;                                          // C8_BREAK_* mask of all breakpoints
+    unsigned        hits;                                           // incremented on each stop
+    C8_BreakHit     hit;                                            // last stop
+} C8_Debugger;
+
 typedef struct {
     int      wrapy;
+    int      xochip;                                                // 64KiB memory, stack relocated to XO_USER_MEMORY_END+1
 } C8_Config;
 
 typedef struct {
-    C8_BeepCallback beep;
-    void            *user_data;
+    C8_BeepCallback          beep;
+    C8_AudioPatternCallback  pattern;                               // optional, XO-CHIP pattern buffer or pitch changed
+    void                    *user_data;
 } C8_Beeper;
 
 /**
@@ -62,16 +135,26 @@ struct _C8_Context {
     WORD                  sp;                                            // stack pointer. 12 levels of nesting (0xEA0-0xEFF)
     WORD                  addressI;                                      // only 12 lowers bits used
     WORD                  pc;                                            // program counter
-    BYTE                 *display;                                       // uint32 array in order to comply to SDL_Texture pixels array format
+    uint64_t             *display;                                       // SCREEN_PLANE_COUNT packed 128x64 bitmaps, row-major, leftmost pixel in the MSB
+    int                   planes;                                        // XO-CHIP bitplanes mask selected by FN01
+    int                   hires;                                         // SUPER-CHIP 128x64 mode (lores uses the top-left 64x32 corner)
+    BYTE                  rpl[RPL_FLAG_COUNT];                           // SUPER-CHIP RPL user flags (FX75/FX85)
     BYTE                  delay_timer;                                   // Both timers count at 60hz until reaching 0
     BYTE                  sound_timer;
     C8_Error              m_error;
     C8_Config             config;
-    int                   m_keys[16];
+    WORD                  m_keys;                                        // held keys, bit N set while key N is down
     C8_KeyChangeNotifier  m_on_set_key;
     int                   is_running;
     WORD                  last_opcode;
     C8_Beeper            *beeper;
+    BYTE                  audio_pattern[AUDIO_PATTERN_SIZE_IN_BYTES];    // XO-CHIP 1-bit samples, MSB first
+    BYTE                  pitch;                                         // XO-CHIP playback rate is 4000*2^((pitch-64)/48) Hz
+    BYTE                 *fusion;                                        // superinstruction starting at each address, see C8_Run
+    C8_CodeState          code_state;
+    C8_Debugger          *debugger;                                      // NULL unless breakpoints are set
+    uint64_t              cycles;                                        // executed instructions count
+    uint32_t              rng;                                           // CXNN xorshift state, part of the machine state for replays
 };
 
 // font data
@@ -96,6 +179,43 @@ static const BYTE font[] = {
     0xF0, 0x80, 0xF0, 0x80, 0x80,
 };
 
+// SUPER-CHIP 8x10 font data, stored right after the small font
+#define BIG_FONT_START  (sizeof font / sizeof font[0])
+#define BIG_FONT_HEIGHT 10
+static const BYTE big_font[] = {
+    0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF,
+    0x18, 0x78, 0x78, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF,
+    0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF,
+    0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF,
+    0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0x03, 0x03,
+    0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF,
+    0xFF, 0xFF, 0x03, 0x03, 0x06, 0x0C, 0x18, 0x18, 0x18, 0x18,
+    0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF,
+    0x7E, 0xFF, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xC3,
+    0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC,
+    0x3C, 0xFF, 0xC3, 0xC0, 0xC0, 0xC0, 0xC0, 0xC3, 0xFF, 0x3C,
+    0xFC, 0xFE, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFE, 0xFC,
+    0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0,
+};
+
+/* Display access */
+#define C8_DISPLAY_WIDTH(context)   ((context)->hires ? SCREEN_HIRES_WIDTH  : SCREEN_WIDTH)
+#define C8_DISPLAY_HEIGHT(context)  ((context)->hires ? SCREEN_HIRES_HEIGHT : SCREEN_HEIGHT)
+#define C8_PLANE(context, plane)    (&(context)->display[(plane) * SCREEN_BUFFER_SIZE_IN_WORDS])
+#define C8_PLANE_ROW(context, plane, y) (&C8_PLANE(context, plane)[(y) * SCREEN_ROW_WORDS])
+#define C8_DISPLAY_ROW(context, y)  C8_PLANE_ROW(context, 0, y)
+#define C8_GET_PLANE_PIXEL(context, plane, x, y) ((C8_PLANE_ROW(context, plane, y)[(x) >> 6] >> (63 - ((x) & 63))) & 1)
+// Return the pixel color index, one bit per plane
+#define C8_GET_PIXEL(context, x, y) (C8_GET_PLANE_PIXEL(context, 0, x, y) | (C8_GET_PLANE_PIXEL(context, 1, x, y) << 1))
+
+/* Memory layout */
+#define C8_MEMORY_END(context)      ((context)->config.xochip ? XO_USER_MEMORY_END : USER_MEMORY_END)
+#define C8_STACK_START(context)     (C8_MEMORY_END(context) + 1)
+#define C8_STACK_END(context)       (C8_MEMORY_END(context) + STACK_SIZE_IN_BYTES)
+
 /* Macro shortcuts to access registers */
 #define VX (context->registers[X])
 #define VY (context->registers[Y])
@@ -105,28 +225,54 @@ static const BYTE font[] = {
 C8_Error C8_GetError(C8_Context *context);
 void     C8_SetError(C8_Context *context, C8_Error error);
 void     C8_ClearError(C8_Context *context);
+int      C8_Resume(C8_Context *context);               // Clear a fault and continue past its instruction, -1 once exited
+const char *C8_ErrorString(C8_ErrorEnum err);
 
 /* Setup */
 void C8_Reset(C8_Context *context, C8_Beeper *beeper);
+void C8_Restart(C8_Context *context);               // Back to power-on over the same buffers, keeps the beeper, drops breakpoints
 void C8_Destroy(C8_Context *context);
 int  C8_LoadProgram(C8_Context *context, const char *path);
+int  C8_LoadRom(C8_Context *context, const BYTE *rom, size_t size);     // Copy an image already in memory, e.g. a mapped pack
+void C8_Seed(C8_Context *context, uint32_t seed);
+uint64_t C8_Hash(const void *data, size_t size);    // XXH64, stable across runs and hosts
+
+/* Save states (in-process only: callbacks are saved as pointers) */
+size_t C8_StateSize(const C8_Context *context);
+void   C8_SaveState(const C8_Context *context, void *buffer);     // buffer of C8_StateSize bytes
+void   C8_LoadState(C8_Context *context, const void *buffer);
 
 /* Fetch-decode */
-int  C8_Tick(C8_Context *context);                 // Return opcode on success
+int  C8_Tick(C8_Context *context);                 // Return opcode on success, 0 on exit or watchpoint. Ignores PC breakpoints
+int  C8_Run(C8_Context *context, int cycles);      // Execute up to cycles instructions or a breakpoint. Return executed count, -1 on error
 void C8_UpdateTimers(C8_Context *context);
 WORD C8_Fetch(C8_Context *context);
 void C8_Decode(C8_Context *context, WORD opcode);
+void C8_InvalidateCode(C8_Context *context, WORD address, size_t size);    // Call after writing guest memory from outside the core
+
+/* Breakpoints: checked through the superinstruction tags and memory opcodes, only while set */
+int                C8_AddBreakpoint(C8_Context *context, const C8_Breakpoint *breakpoint);  // Return id, -1 if full
+void               C8_RemoveBreakpoint(C8_Context *context, int id);
+void               C8_ClearBreakpoints(C8_Context *context);
+int                C8_AtBreakpoint(C8_Context *context);                // id of the PC breakpoint at pc, -1 if none
+const C8_BreakHit *C8_GetBreakHit(const C8_Context *context);          // last stop, NULL if none
 
 /* Key handling */
 void C8_SetKey(C8_Context *context, int key);
 void C8_UnsetKey(C8_Context *context, int key);
+void C8_SetKeys(C8_Context *context, WORD keys);       // Apply a held keys mask, newly pressed keys may end a FX0A wait
 
 #define INCREMENENT_PC  context->pc += 2
 #define DECREMENENT_PC  context->pc -= 2
 
+// XO-CHIP F000 NNNN is the only 4 bytes long instruction
+#define C8_INSTRUCTION_SIZE_AT(context, address)                                                \
+    (((context)->config.xochip && (context)->memory[address] == 0xF0 && (context)->memory[(address) + 1] == 0x00) ? 4 : 2)
+#define SKIP_NEXT       context->pc += C8_INSTRUCTION_SIZE_AT(context, context->pc)
+
 #define _C8_SKIP_IF_X(field, cond) do {                                                         \
     C8_OPCODE_SELECT_X##field(opcode);                                                          \
-    if ( cond ) { INCREMENENT_PC; }                                                             \
+    if ( cond ) { SKIP_NEXT; }                                                                  \
 } while(0);
 
 #define _C8_SKIP_IF_CMP_TO_X(field, eqPrefix, rhs) _C8_SKIP_IF_X(field, (VX eqPrefix##= rhs))
@@ -160,8 +306,15 @@ void C8_UnsetKey(C8_Context *context, int key);
 
 
 /* Instructions */
+void C8_Opcode00CN(C8_Context *context, WORD opcode);    // Scroll display N rows down (SCHIP11)
+void C8_Opcode00DN(C8_Context *context, WORD opcode);    // Scroll display N rows up (XO-CHIP)
 void C8_Opcode00E0(C8_Context *context, WORD opcode);    // clear screen
 void C8_Opcode00EE(C8_Context *context, WORD opcode);    // return
+void C8_Opcode00FB(C8_Context *context, WORD opcode);    // Scroll display 4 pixels right (SCHIP11)
+void C8_Opcode00FC(C8_Context *context, WORD opcode);    // Scroll display 4 pixels left (SCHIP11)
+void C8_Opcode00FD(C8_Context *context, WORD opcode);    // Exit interpreter (SCHIP)
+void C8_Opcode00FE(C8_Context *context, WORD opcode);    // Disable extended screen mode (SCHIP)
+void C8_Opcode00FF(C8_Context *context, WORD opcode);    // Enable extended 128x64 screen mode (SCHIP)
 void C8_Opcode1NNN(C8_Context *context, WORD opcode);    // Jump to address NNN
 void C8_Opcode2NNN(C8_Context *context, WORD opcode);    // Call subroutine at NNN
 
@@ -172,6 +325,9 @@ void C8_Opcode2NNN(C8_Context *context, WORD opcode);    // Call subroutine at N
 // Skip next instruction if (VX == VY)
 #define C8_Opcode5XY0(context, opcode)      _C8_SKIP_IF_CMP_XYN(=)
 
+void C8_Opcode5XY2(C8_Context *context, WORD opcode);    // Dump VX to VY (included, any order) in memory, starting at address I (XO-CHIP)
+void C8_Opcode5XY3(C8_Context *context, WORD opcode);    // Load memory content in VX to VY (included, any order), starting at address I (XO-CHIP)
+
 // Assign NN to VX
 #define C8_Opcode6XNN(context, opcode)      _C8_SET_VX_WITH_NN()
 // Add NN to VX (carry flag unchanged)
@@ -201,12 +357,16 @@ void C8_OpcodeANNN(C8_Context *context, WORD opcode);    // Assign address NNN t
 void C8_OpcodeBNNN(C8_Context *context, WORD opcode);    // Jump to address NNN + V0
 void C8_OpcodeCXNN(C8_Context *context, WORD opcode);    // Assign (rand number AND NN) to VX
 void C8_OpcodeDXYN(C8_Context *context, WORD opcode);    // Draw sprite of height N pixels at coord (VX, VY). Read sprite data from memory at address in I.
+void C8_OpcodeDXY0(C8_Context *context, WORD opcode);    // Draw 16x16 sprite at coord (VX, VY), two bytes per row (SCHIP)
 
 // Skip next instruction if key in VX pressed
-#define C8_OpcodeEX9E(context, opcode)  _C8_SKIP_IF_X(NN, context->m_keys[VX] != 0)    // NN necessary but dummy 
+#define C8_OpcodeEX9E(context, opcode)  _C8_SKIP_IF_X(NN, (context->m_keys >> (VX & 0xF)) & 1)    // NN necessary but dummy 
 // Skip next instruction if key in VX is not pressed
-#define C8_OpcodeEXA1(context, opcode)  _C8_SKIP_IF_X(NN, context->m_keys[VX] == 0)
+#define C8_OpcodeEXA1(context, opcode)  _C8_SKIP_IF_X(NN, !((context->m_keys >> (VX & 0xF)) & 1))
 
+void C8_OpcodeF000(C8_Context *context, WORD opcode);    // Assign the following 16-bit word to I (XO-CHIP)
+void C8_OpcodeFN01(C8_Context *context, WORD opcode);    // Select bitplanes N for drawing, clearing and scrolling (XO-CHIP)
+void C8_OpcodeF002(C8_Context *context, WORD opcode);    // Load 16 bytes audio pattern from address I (XO-CHIP)
 void C8_OpcodeFX07(C8_Context *context, WORD opcode);    // Assign delay timer's value to VX
 void C8_OpcodeFX0A(C8_Context *context, WORD opcode);    // Wait for any key press and store it in VX (blocking)
 
@@ -218,10 +378,15 @@ void C8_OpcodeFX18(C8_Context *context, WORD opcode);
 #define C8_OpcodeFX1E(context, opcode)  _ASSIGN(NN, context->addressI,   context->registers[X], +)
 // Set I to sprite address for the characheter in VX
 #define C8_OpcodeFX29(context, opcode)  _ASSIGN(NN, context->addressI,   context->registers[X]*FONT_HEIGHT, )
+// Set I to 8x10 sprite address for the digit in VX (SCHIP)
+#define C8_OpcodeFX30(context, opcode)  _ASSIGN(NN, context->addressI,   BIG_FONT_START + (context->registers[X] & 0xF)*BIG_FONT_HEIGHT, )
 
+void C8_OpcodeFX3A(C8_Context *context, WORD opcode);    // Assign VX to audio pitch register (XO-CHIP)
 void C8_OpcodeFX33(C8_Context *context, WORD opcode);    // Store BCD representation of VX (hundreds at I, tens at I+1 and ones at I+2)
 void C8_OpcodeFX55(C8_Context *context, WORD opcode);    // Dump V0 to VX (included) in memory, starting at address I (I unchanged)
 void C8_OpcodeFX65(C8_Context *context, WORD opcode);    // Load memory content in V0 to VX (included), starting at address I (I unchanged)
+void C8_OpcodeFX75(C8_Context *context, WORD opcode);    // Store V0 to VX (included) in RPL user flags (SCHIP)
+void C8_OpcodeFX85(C8_Context *context, WORD opcode);    // Load V0 to VX (included) from RPL user flags (SCHIP)
 
 #ifdef __cplusplus
 }
@@ -1,15 +1,31 @@
 #include "audio.hh"
 #include <iostream>
+#include <cmath>
+#include <cstring>
+
+#define PATTERN_SIZE_IN_BITS (AUDIO_PATTERN_SIZE_IN_BYTES * 8)
 
 // ref: https://stackoverflow.com/a/45002609
 static void beep_callback(void *userdata, Uint8 *rawbuf, int bytes) {
     Sint16 *buffer = (Sint16*)rawbuf;
     int length = bytes / 2;
-    int &sample_nb(*(int*)userdata);
+    Beeper &beeper(*(Beeper*)userdata);
+    int &sample_nb(beeper.sample_nb);
+
+    if (beeper.has_pattern) {
+        for (int i = 0; i < length; ++i) {
+            int bit = (int)beeper.pattern_pos;
+
+            buffer[i] = (beeper.audio_pattern[bit >> 3] >> (7 - (bit & 7))) & 1 ? AMPLITUDE : -AMPLITUDE;
+            beeper.pattern_pos = fmod(beeper.pattern_pos + beeper.pattern_rate * beeper.speed, PATTERN_SIZE_IN_BITS);
+        }
+
+        return;
+    }
 
     for (int i = 0; i < length; ++i, ++sample_nb) {
         double time = (double)sample_nb / (double)SAMPLE_RATE;
-        buffer[i] = (Sint16)(AMPLITUDE * sin(2.0f * M_PI * 441.0f * time));
+        buffer[i] = (Sint16)(AMPLITUDE * sin(2.0f * M_PI * 441.0f * beeper.speed * time));
     }
 }
 
@@ -20,12 +36,16 @@ Uint32 beep_stop_callback(Uint32 interval, void *param) {
 
 Beeper::Beeper() {
     sample_nb        = 0;
+    has_pattern      = false;
+    pattern_rate     = 0;
+    pattern_pos      = 0;
+    speed            = 1;
     want.freq        = SAMPLE_RATE;
     want.format      = AUDIO_S16SYS;
     want.channels    = 1;
     want.samples     = 2048;
     want.callback    = beep_callback;
-    want.userdata    = &sample_nb;
+    want.userdata    = this;
     timerID          = 0;
     is_opened        = true;
 
@@ -50,9 +70,32 @@ Beeper::~Beeper() {
 void Beeper::beep(void *userdata) {
     Beeper &beeper = *(Beeper*)userdata;
 
-    if (!beeper.is_opened) return;
+    if (!beeper.is_opened || beeper.speed == 0) return;
 
-    // play beep for 100 ms
+    // play beep for 100 ms of emulated time
     SDL_PauseAudio(0);
-    beeper.timerID = SDL_AddTimer(100, beep_stop_callback, NULL);
-}
\ No newline at end of file
+    beeper.timerID = SDL_AddTimer((Uint32)(100 / beeper.speed), beep_stop_callback, NULL);
+}
+
+void Beeper::pattern(void *userdata, const BYTE *pattern, BYTE pitch) {
+    Beeper &beeper = *(Beeper*)userdata;
+
+    if (!beeper.is_opened) return;
+
+    // the callback reads the pattern from the audio thread
+    SDL_LockAudio();
+    memcpy(beeper.audio_pattern, pattern, AUDIO_PATTERN_SIZE_IN_BYTES);
+    beeper.has_pattern  = true;
+    beeper.pattern_rate = 4000.0 * pow(2.0, (pitch - 64) / 48.0) / beeper.have.freq;
+    SDL_UnlockAudio();
+}
+
+void Beeper::setSpeed(double speed) {
+    if (!is_opened) return;
+
+    SDL_LockAudio();
+    this->speed = speed;
+    SDL_UnlockAudio();
+
+    if (speed == 0) SDL_PauseAudio(1);
+}
@@ -3,6 +3,7 @@
 
 #include <SDL.h>
 #include <SDL_audio.h>
+#include "chip8.h"
 
 const int AMPLITUDE = 28000;
 const int SAMPLE_RATE = 44100;
@@ -13,8 +14,15 @@ public:
     ~Beeper();
 
     static void beep(void *userdata);
+    static void pattern(void *userdata, const BYTE *pattern, BYTE pitch);
+    void setSpeed(double speed);                                // emulation speed, 0 mutes
 public:
     int              sample_nb;
+    bool             has_pattern;                               // XO-CHIP pattern replaces the default tone
+    BYTE             audio_pattern[AUDIO_PATTERN_SIZE_IN_BYTES];
+    double           pattern_rate;                              // pattern bits per output sample
+    double           pattern_pos;
+    double           speed;                                     // pitch and duration scale
     SDL_AudioSpec    want;
     SDL_AudioSpec    have;
     SDL_TimerID      timerID;
@@ -0,0 +1,29 @@
+#include "backend.hh"
+#include "backend_null.hh"
+#include "backend_sdl.hh"
+#include "backend_terminal.hh"
+#include "c8_grid.hh"
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+uint64_t C8Backend::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void C8Backend::sleep(uint64_t ns) {
+    std::this_thread::sleep_for(std::chrono::nanoseconds(ns));
+}
+
+void C8Backend::presentGrid(C8_Grid &grid, C8_Profiler &profiler) {
+    present(grid.instance(grid.focused()).context, profiler);
+}
+
+C8Backend *create_backend(const char *name) {
+    if (strcmp(name, "sdl") == 0)      return new SDLBackend();
+    if (strcmp(name, "null") == 0)     return new NullBackend();
+    if (strcmp(name, "terminal") == 0) return new TerminalBackend();
+
+    return NULL;
+}
@@ -0,0 +1,47 @@
+#ifndef BACKEND_HH
+#define BACKEND_HH
+
+#include "chip8.h"
+#include "config.h"
+#include <cstdint>
+
+class C8_Profiler;
+class C8_Grid;
+class C8_Browser;
+
+// Something the user did, stamped with the backend clock
+struct BackendEvent {
+    enum Type { QUIT, KEY_DOWN, KEY_UP, NEXT_SPEED, FOCUS, OPEN };
+
+    Type                    type;
+    int                     key;                    // CHIP-8 key for KEY_DOWN and KEY_UP, grid tile for FOCUS, browser entry for OPEN
+    uint64_t                time;                   // nanoseconds, see now()
+};
+
+/**
+ * @brief Video, input, audio and clock of the frontend
+ *
+ * The emulation loop in main.cc only talks to this interface. Nothing is initialized
+ * before init, so backends without a display never touch SDL.
+*/
+class C8Backend {
+public:
+    virtual ~C8Backend() {}
+
+    virtual int  init(const Config &config) = 0;    // Return 0 on success
+    virtual void configure(const Config &config) {} // settings of the program just loaded, e.g. its keys
+    virtual bool poll(BackendEvent &event) = 0;     // false once no event is pending
+    virtual void present(C8_Context &context, C8_Profiler &profiler) = 0;
+    virtual void presentGrid(C8_Grid &grid, C8_Profiler &profiler);    // the focused instance alone unless overridden
+    virtual void setSpeed(float speed) {}           // 0 is unthrottled
+    virtual C8_Beeper *beeper() { return NULL; }    // NULL without audio
+    virtual double refreshRate() { return 0; }      // 0 if unknown
+    virtual bool setBrowser(C8_Browser *browser) { return false; }    // false without a way to show it
+
+    virtual uint64_t now();                         // nanoseconds, monotonic
+    virtual void sleep(uint64_t ns);
+};
+
+C8Backend *create_backend(const char *name);        // "sdl", "null" or "terminal", NULL if unknown
+
+#endif
@@ -0,0 +1,25 @@
+#include "backend_null.hh"
+
+#include <csignal>
+
+static volatile sig_atomic_t interrupted = 0;
+
+static void on_interrupt(int) {
+    interrupted = 1;
+}
+
+int NullBackend::init(const Config &config) {
+    signal(SIGINT, on_interrupt);
+    signal(SIGTERM, on_interrupt);
+
+    return 0;
+}
+
+bool NullBackend::poll(BackendEvent &event) {
+    if (!interrupted) return false;
+
+    event.type = BackendEvent::QUIT;
+    event.key  = 0;
+    event.time = now();
+    return true;
+}
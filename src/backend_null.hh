@@ -0,0 +1,14 @@
+#ifndef BACKEND_NULL_HH
+#define BACKEND_NULL_HH
+
+#include "backend.hh"
+
+// Headless: no display, input or audio. Runs until the program exits or SIGINT.
+class NullBackend : public C8Backend {
+public:
+    int  init(const Config &config) override;
+    bool poll(BackendEvent &event) override;
+    void present(C8_Context &context, C8_Profiler &profiler) override {}
+};
+
+#endif
@@ -0,0 +1,432 @@
+#include "backend_sdl.hh"
+#include "c8_def.h"
+#include "c8_browser.hh"
+#include "c8_grid.hh"
+#include "c8_profiler.hh"
+#include "c8_trace.hh"
+#include "cleanup.hh"
+
+#include "imgui.h"
+#include "imgui_impl_sdl2.h"
+#include "imgui_impl_sdlrenderer2.h"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// 0 to 9 then A to F unless the game binds its own keys
+static const SDL_Keycode default_keymap[] = {
+    SDLK_0, SDLK_1, SDLK_2, SDLK_3, SDLK_4, SDLK_5, SDLK_6, SDLK_7,
+    SDLK_8, SDLK_9, SDLK_a, SDLK_b, SDLK_c, SDLK_d, SDLK_e, SDLK_f
+};
+
+// Colors indexed by plane bits: background, plane 1, plane 2, both planes
+static const Uint32 palette[] = { 0xFF000000, 0xFFFFFFFF, 0xFFAAAAAA, 0xFF555555 };
+
+// Comma separated key names for keys 0 to F, e.g. "X,1,2,3,Q,W,E,A,S,D,Z,C,4,R,F,V"
+void load_keymap(SDL_Keycode keymap[16], const char *names) {
+    char buffer[KEYMAP_MAX_LEN];
+    char *save;
+    int key = 0;
+
+    memcpy(keymap, default_keymap, sizeof default_keymap);
+    if (names[0] == '\0') return;
+
+    strncpy(buffer, names, KEYMAP_MAX_LEN - 1);
+    buffer[KEYMAP_MAX_LEN - 1] = '\0';
+
+    for (char *name = strtok_r(buffer, ",", &save); name != NULL && key < 16; name = strtok_r(NULL, ",", &save), ++key) {
+        while (*name == ' ') ++name;
+
+        SDL_Keycode code = SDL_GetKeyFromName(name);
+        if (code == SDLK_UNKNOWN) {
+            fprintf(stderr, "Unknown key %s for %X, keeping the default\n", name, key);
+        } else {
+            keymap[key] = code;
+        }
+    }
+}
+
+// Into locked texture memory, pitch in bytes
+static void copy_c8_display(void *pixels, int pitch, const C8_Context *context) {
+    Uint32   *base;
+
+    for(int row = 0; row < C8_DISPLAY_HEIGHT(context); ++row) {
+        base = (Uint32*)((Uint8*)pixels + row * pitch);
+
+        for(int col = 0; col < C8_DISPLAY_WIDTH(context); ++col) {
+            *base++ = palette[C8_GET_PIXEL(context, col, row)];
+        }
+    }
+}
+
+SDLBackend::SDLBackend() :
+        m_initialized(false),
+        m_imgui(false),
+        m_window(NULL),
+        m_renderer(NULL),
+        m_texture(NULL),
+        m_atlas(NULL),
+        m_gridCount(0),
+        m_gridColumns(0),
+        m_gridRows(0),
+        m_browser(NULL),
+        m_thumbnails(NULL),
+        m_beeper(NULL) {
+    memcpy(m_keymap, default_keymap, sizeof default_keymap);
+    memset(&m_c8Beeper, 0, sizeof m_c8Beeper);
+}
+
+SDLBackend::~SDLBackend() {
+    if (m_imgui) {
+        ImGui_ImplSDLRenderer2_Shutdown();
+        ImGui_ImplSDL2_Shutdown();
+        ImGui::DestroyContext();
+    }
+
+    delete m_beeper;
+    cleanup(m_thumbnails, m_atlas, m_texture, m_renderer, m_window);
+
+    if (m_initialized) SDL_Quit();
+}
+
+int SDLBackend::init(const Config &config) {
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_GAMECONTROLLER | SDL_INIT_AUDIO) != 0) {
+        printf("SDL_Init Error: %s\n", SDL_GetError());
+        return 1;
+    }
+    m_initialized = true;
+
+    // From 2.0.18: Enable native IME.
+#ifdef SDL_HINT_IME_SHOW_UI
+    SDL_SetHint(SDL_HINT_IME_SHOW_UI, "1");
+#endif
+
+    // Create window with SDL_Renderer graphics context
+    SDL_WindowFlags windowFlags = (SDL_WindowFlags)(SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI);
+    m_window = SDL_CreateWindow("chip8", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, WINDOW_WIDTH, WINDOW_HEIGHT, windowFlags);
+    if (m_window == NULL) {
+        printf("SDL_CreateWindow Error: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    m_renderer = SDL_CreateRenderer(m_window, -1, SDL_RENDERER_ACCELERATED);
+    if (m_renderer == NULL) {
+        printf("SDL_CreateRenderer Error: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    m_texture = SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+    if (m_texture == NULL) {
+        printf("SDL_CreateTexture Error: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    m_beeper                = new Beeper();
+    m_c8Beeper.beep         = Beeper::beep;
+    m_c8Beeper.pattern      = Beeper::pattern;
+    m_c8Beeper.user_data    = (void*)m_beeper;
+
+    configure(config);
+
+    // Setup Dear ImGui context
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO(); (void)io;
+    io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
+    io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
+
+    // Setup Dear ImGui style
+    ImGui::StyleColorsDark();
+
+    // Setup Platform/Renderer backends
+    ImGui_ImplSDL2_InitForSDLRenderer(m_window, m_renderer);
+    ImGui_ImplSDLRenderer2_Init(m_renderer);
+    m_imgui = true;
+
+    return 0;
+}
+
+void SDLBackend::configure(const Config &config) {
+    load_keymap(m_keymap, config.keys);
+}
+
+bool SDLBackend::poll(BackendEvent &out) {
+    SDL_Event event;
+
+    if (!m_pending.empty()) {
+        out = m_pending.front();
+        m_pending.pop_front();
+        return true;
+    }
+
+    while (SDL_PollEvent(&event)) {
+        ImGui_ImplSDL2_ProcessEvent(&event);
+
+        // event timestamps are SDL ticks, moved onto the backend clock
+        Uint64 ticks = SDL_GetTicks64();
+        Uint64 age   = (ticks > event.common.timestamp) ? ticks - event.common.timestamp : 0;
+        out.time     = now() - age * 1000000;
+        out.key      = 0;
+
+        if ( (SDL_QUIT == event.type) ||
+             (SDL_KEYDOWN == event.type && SDLK_ESCAPE == event.key.keysym.sym) ) {
+            out.type = BackendEvent::QUIT;
+            return true;
+        }
+
+        // a click on a grid tile focuses it, unless it's meant for the profiler
+        if (SDL_MOUSEBUTTONDOWN == event.type && SDL_BUTTON_LEFT == event.button.button && m_gridCount > 0 &&
+            !ImGui::GetIO().WantCaptureMouse && event.button.x < VIEWPORT_WIDTH && event.button.y < VIEWPORT_HEIGHT) {
+            int tile = (event.button.y / (VIEWPORT_HEIGHT / m_gridRows)) * m_gridColumns + event.button.x / (VIEWPORT_WIDTH / m_gridColumns);
+            if (tile >= m_gridCount) continue;
+
+            out.type = BackendEvent::FOCUS;
+            out.key  = tile;
+            return true;
+        }
+
+        if (SDL_KEYDOWN == event.type && SDLK_TAB == event.key.keysym.sym) {
+            if (event.key.repeat) continue;
+
+            out.type = BackendEvent::NEXT_SPEED;
+            return true;
+        }
+
+        // key repeats are not transitions
+        if ((SDL_KEYDOWN == event.type && !event.key.repeat) || SDL_KEYUP == event.type) {
+            for (int key = 0; key < 16; ++key) {
+                if (m_keymap[key] == event.key.keysym.sym) {
+                    out.type = (SDL_KEYDOWN == event.type) ? BackendEvent::KEY_DOWN : BackendEvent::KEY_UP;
+                    out.key  = key;
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+void SDLBackend::beginFrame(C8_Profiler &profiler) {
+    ImGuiIO& io = ImGui::GetIO();
+
+    {
+        C8_TRACE_SCOPE("imgui");
+
+        // Start the Dear ImGui frame
+        ImGui_ImplSDLRenderer2_NewFrame();
+        ImGui_ImplSDL2_NewFrame();
+        ImGui::NewFrame();
+
+        profiler.render();
+        if (m_browser != NULL) renderBrowser();
+
+        // Rendering
+        ImGui::Render();
+    }
+    SDL_RenderSetScale(m_renderer, io.DisplayFramebufferScale.x, io.DisplayFramebufferScale.y);
+    SDL_RenderClear(m_renderer);  // Needed as texture doesn't fill the renderer
+}
+
+void SDLBackend::endFrame() {
+    {
+        C8_TRACE_SCOPE("imgui_draw");
+        ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData());
+    }
+    {
+        C8_TRACE_SCOPE("present");
+        SDL_RenderPresent(m_renderer);
+    }
+}
+
+void SDLBackend::present(C8_Context &context, C8_Profiler &profiler) {
+    SDL_Rect srcrect = { 0, 0, C8_DISPLAY_WIDTH(&context), C8_DISPLAY_HEIGHT(&context) };
+    SDL_Rect dstrect = { 0, 0, SCREEN_WIDTH * PIXEL_SCALE, SCREEN_HEIGHT * PIXEL_SCALE };
+    void    *pixels;
+    int      pitch;
+
+    m_gridCount = 0;
+    beginFrame(profiler);
+
+    {
+        C8_TRACE_SCOPE("copy_display");
+        SDL_LockTexture(m_texture, NULL, &pixels, &pitch);
+        copy_c8_display(pixels, pitch, &context);
+        SDL_UnlockTexture(m_texture);
+    }
+    {
+        C8_TRACE_SCOPE("render_copy");
+        SDL_RenderCopy(m_renderer, m_texture, &srcrect, &dstrect);
+    }
+
+    endFrame();
+}
+
+// Square-ish grid of 2:1 tiles over the viewport, the atlas follows the same layout
+void SDLBackend::layoutGrid(size_t count) {
+    int columns = (int)ceil(sqrt((double)count));
+    int rows    = ((int)count + columns - 1) / columns;
+
+    if (m_atlas != NULL && columns == m_gridColumns && rows == m_gridRows) {
+        m_gridCount = (int)count;
+        return;
+    }
+
+    cleanup(m_atlas);
+    m_atlas = SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+                                columns * SCREEN_HIRES_WIDTH, rows * SCREEN_HIRES_HEIGHT);
+    if (m_atlas == NULL) {
+        printf("SDL_CreateTexture Error: %s\n", SDL_GetError());
+        m_gridCount = 0;
+        return;
+    }
+
+    m_gridCount   = (int)count;
+    m_gridColumns = columns;
+    m_gridRows    = rows;
+}
+
+void SDLBackend::presentGrid(C8_Grid &grid, C8_Profiler &profiler) {
+    void    *pixels;
+    int      pitch;
+
+    layoutGrid(grid.size());
+    if (m_gridCount == 0) return;
+
+    int tile_width  = VIEWPORT_WIDTH  / m_gridColumns;
+    int tile_height = VIEWPORT_HEIGHT / m_gridRows;
+
+    beginFrame(profiler);
+
+    {
+        // every tile in one upload
+        C8_TRACE_SCOPE("copy_display");
+        SDL_LockTexture(m_atlas, NULL, &pixels, &pitch);
+
+        for (int i = 0; i < m_gridCount; ++i) {
+            Uint8 *tile = (Uint8*)pixels + (i / m_gridColumns) * SCREEN_HIRES_HEIGHT * pitch
+                                         + (i % m_gridColumns) * SCREEN_HIRES_WIDTH * sizeof(Uint32);
+            copy_c8_display(tile, pitch, &grid.instance(i).context);
+        }
+
+        SDL_UnlockTexture(m_atlas);
+    }
+    {
+        C8_TRACE_SCOPE("render_copy");
+
+        for (int i = 0; i < m_gridCount; ++i) {
+            const C8_Context &context = grid.instance(i).context;
+            SDL_Rect srcrect = { (i % m_gridColumns) * SCREEN_HIRES_WIDTH, (i / m_gridColumns) * SCREEN_HIRES_HEIGHT,
+                                 C8_DISPLAY_WIDTH(&context), C8_DISPLAY_HEIGHT(&context) };
+            SDL_Rect dstrect = { (i % m_gridColumns) * tile_width, (i / m_gridColumns) * tile_height,
+                                 tile_width, tile_height };
+
+            SDL_RenderCopy(m_renderer, m_atlas, &srcrect, &dstrect);
+        }
+
+        // outline the instance receiving input
+        SDL_Rect focus = { ((int)grid.focused() % m_gridColumns) * tile_width, ((int)grid.focused() / m_gridColumns) * tile_height,
+                           tile_width, tile_height };
+        SDL_SetRenderDrawColor(m_renderer, 0xFF, 0x80, 0x00, 0xFF);
+        SDL_RenderDrawRect(m_renderer, &focus);
+        SDL_SetRenderDrawColor(m_renderer, 0x00, 0x00, 0x00, 0xFF);
+    }
+
+    endFrame();
+}
+
+void SDLBackend::setSpeed(float speed) {
+    char title[32];
+
+    // sped up audio stays recognizable up to a point, then it's only noise
+    m_beeper->setSpeed(speed <= MAX_AUDIBLE_SPEED ? speed : 0);
+
+    if (speed == 1)       snprintf(title, sizeof title, "chip8");
+    else if (speed == 0)  snprintf(title, sizeof title, "chip8 [unthrottled]");
+    else                  snprintf(title, sizeof title, "chip8 [%gx]", speed);
+    SDL_SetWindowTitle(m_window, title);
+}
+
+bool SDLBackend::setBrowser(C8_Browser *browser) {
+    m_browser = browser;
+    return true;
+}
+
+// Thumbnails share one texture, refreshed in a single pass before the window lists them
+void SDLBackend::renderBrowser() {
+    size_t   count   = m_browser->size();
+    int      rows    = ((int)count + BROWSER_ATLAS_COLUMNS - 1) / BROWSER_ATLAS_COLUMNS;
+    size_t   n       = (size_t)(SDL_GetTicks64() * 60 / (1000 * THUMBNAIL_FRAME_STEP));    // kept frames play in real time
+    ImVec2   size(SCREEN_WIDTH * THUMBNAIL_SCALE, SCREEN_HEIGHT * THUMBNAIL_SCALE);
+    void    *pixels;
+    int      pitch;
+
+    if (count == 0) return;
+
+    if (m_thumbnails == NULL) {
+        m_thumbnails = SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+                                         BROWSER_ATLAS_COLUMNS * SCREEN_WIDTH, rows * SCREEN_HEIGHT);
+        if (m_thumbnails == NULL) {
+            printf("SDL_CreateTexture Error: %s\n", SDL_GetError());
+            m_browser = NULL;
+            return;
+        }
+    }
+
+    SDL_LockTexture(m_thumbnails, NULL, &pixels, &pitch);
+    for (size_t i = 0; i < count; ++i) {
+        const BYTE *frame = m_browser->frame(i, n);
+        Uint8      *tile  = (Uint8*)pixels + (i / BROWSER_ATLAS_COLUMNS) * SCREEN_HEIGHT * pitch
+                                           + (i % BROWSER_ATLAS_COLUMNS) * SCREEN_WIDTH * sizeof(Uint32);
+
+        for (int row = 0; row < SCREEN_HEIGHT; ++row) {
+            Uint32 *base = (Uint32*)(tile + row * pitch);
+
+            for (int col = 0; col < SCREEN_WIDTH; ++col) {
+                *base++ = (frame != NULL) ? palette[frame[row * SCREEN_WIDTH + col]] : BROWSER_LOADING_COLOR;
+            }
+        }
+    }
+    SDL_UnlockTexture(m_thumbnails);
+
+    ImGui::SetNextWindowPos(ImVec2(VIEWPORT_WIDTH / 2, 0), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(VIEWPORT_WIDTH / 2, VIEWPORT_HEIGHT), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowCollapsed(true, ImGuiCond_FirstUseEver);
+
+    if (ImGui::Begin("Games")) {
+        int columns = std::max(1, (int)(ImGui::GetContentRegionAvail().x / (size.x + 8)));
+
+        for (size_t i = 0; i < count; ++i) {
+            const C8_BrowserEntry &entry = m_browser->entry(i);
+            float u = (float)(i % BROWSER_ATLAS_COLUMNS) / BROWSER_ATLAS_COLUMNS;
+            float v = (float)(i / BROWSER_ATLAS_COLUMNS) / rows;
+
+            ImGui::PushID((int)i);
+            ImGui::BeginGroup();
+            if (ImGui::ImageButton("##thumbnail", (ImTextureID)m_thumbnails, size,
+                                   ImVec2(u, v), ImVec2(u + 1.0f / BROWSER_ATLAS_COLUMNS, v + 1.0f / rows))) {
+                BackendEvent event = { BackendEvent::OPEN, (int)i, now() };
+                m_pending.push_back(event);
+            }
+            if (ImGui::IsItemHovered()) ImGui::SetTooltip("%s", entry.path.c_str());
+            ImGui::TextUnformatted(entry.name.c_str());
+            ImGui::EndGroup();
+            ImGui::PopID();
+
+            if ((i + 1) % columns != 0) ImGui::SameLine();
+        }
+    }
+    ImGui::End();
+}
+
+C8_Beeper *SDLBackend::beeper() {
+    return &m_c8Beeper;
+}
+
+double SDLBackend::refreshRate() {
+    SDL_DisplayMode mode;
+
+    if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(m_window), &mode) != 0) return 0;
+    return mode.refresh_rate;
+}
@@ -0,0 +1,54 @@
+#ifndef BACKEND_SDL_HH
+#define BACKEND_SDL_HH
+
+#include "backend.hh"
+#include "audio.hh"
+
+#include <SDL.h>
+#include <deque>
+
+#if !SDL_VERSION_ATLEAST(2,0,17)
+#error This backend requires SDL 2.0.17+ because of SDL_RenderGeometry() function
+#endif
+
+// Window with the profiler, SDL audio and keyboard
+class SDLBackend : public C8Backend {
+public:
+    SDLBackend();
+    ~SDLBackend();
+
+    int  init(const Config &config) override;
+    void configure(const Config &config) override;
+    bool poll(BackendEvent &event) override;
+    void present(C8_Context &context, C8_Profiler &profiler) override;
+    void presentGrid(C8_Grid &grid, C8_Profiler &profiler) override;
+    void setSpeed(float speed) override;
+    C8_Beeper *beeper() override;
+    double refreshRate() override;
+    bool setBrowser(C8_Browser *browser) override;
+
+private:
+    void beginFrame(C8_Profiler &profiler);
+    void endFrame();
+    void layoutGrid(size_t count);
+    void renderBrowser();
+
+    bool             m_initialized;
+    bool             m_imgui;
+    SDL_Window      *m_window;
+    SDL_Renderer    *m_renderer;
+    SDL_Texture     *m_texture;
+    SDL_Texture     *m_atlas;                       // every grid instance in one texture, a hires sized tile each
+    int              m_gridCount;                   // 0 outside of a grid
+    int              m_gridColumns, m_gridRows;
+    C8_Browser      *m_browser;
+    SDL_Texture     *m_thumbnails;                  // current frame of every thumbnail, BROWSER_ATLAS_COLUMNS wide
+    std::deque<BackendEvent> m_pending;             // raised by the UI while presenting
+    Beeper          *m_beeper;                      // opens the audio device, created once SDL is up
+    C8_Beeper        m_c8Beeper;
+    SDL_Keycode      m_keymap[16];
+};
+
+void load_keymap(SDL_Keycode keymap[16], const char *names);
+
+#endif
@@ -0,0 +1,298 @@
+#include "backend_terminal.hh"
+#include "c8_def.h"
+#include "c8_trace.hh"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+// Escape sequences of the arrow keys end with A to D, they map past the byte range
+#define ARROW_KEY(final) (256 + ((final) - 'A'))
+
+#define ESC         "\x1b"
+#define UPPER_HALF  "\xe2\x96\x80"                  // U+2580, foreground on top, background below
+
+// 256 color palette indexed by plane bits: background, plane 1, plane 2, both planes
+static const int palette[] = { 16, 231, 248, 240 };
+
+static const char default_keys[] = "0123456789abcdef";
+
+// Same names as the SDL frontend, which a terminal can tell apart
+static int key_code(const char *name) {
+    if (name[0] != '\0' && name[1] == '\0') return tolower((unsigned char)name[0]);
+
+    if (strcasecmp(name, "Space") == 0) return ' ';
+    if (strcasecmp(name, "Up") == 0)    return ARROW_KEY('A');
+    if (strcasecmp(name, "Down") == 0)  return ARROW_KEY('B');
+    if (strcasecmp(name, "Right") == 0) return ARROW_KEY('C');
+    if (strcasecmp(name, "Left") == 0)  return ARROW_KEY('D');
+
+    return -1;
+}
+
+TerminalBackend::TerminalBackend() :
+        m_raw(false),
+        m_width(0),
+        m_height(0),
+        m_row(-1),
+        m_col(-1),
+        m_fg(-1),
+        m_bg(-1),
+        m_speed(1),
+        m_bell(false) {
+    for (int key = 0; key < 16; ++key) {
+        m_keymap[key]  = default_keys[key];
+        m_release[key] = 0;
+    }
+
+    memset(m_cells, 0xFF, sizeof m_cells);
+    memset(&m_c8Beeper, 0, sizeof m_c8Beeper);
+    m_c8Beeper.beep      = bell;
+    m_c8Beeper.user_data = (void*)this;
+}
+
+TerminalBackend::~TerminalBackend() {
+    static const char restore[] = ESC "[0m" ESC "[?25h" ESC "[?1049l";
+
+    if (!m_raw) return;
+
+    if (write(STDOUT_FILENO, restore, sizeof restore - 1) < 0) {}
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &m_saved);
+}
+
+int TerminalBackend::init(const Config &config) {
+    static const char setup[] = ESC "[?1049h" ESC "[?25l" ESC "[2J";
+    struct termios raw;
+
+    if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO)) {
+        fprintf(stderr, "The terminal backend needs a terminal\n");
+        return 1;
+    }
+
+    configure(config);
+
+    // no line buffering, echo or signals: ^C arrives as a byte and quits
+    if (tcgetattr(STDIN_FILENO, &m_saved) != 0) return 1;
+    raw = m_saved;
+    raw.c_lflag &= ~(ICANON | ECHO | ISIG | IEXTEN);
+    raw.c_iflag &= ~(IXON | ICRNL);
+    raw.c_cc[VMIN]  = 0;
+    raw.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) != 0) return 1;
+    m_raw = true;
+
+    if (write(STDOUT_FILENO, setup, sizeof setup - 1) < 0) return 1;
+    m_out.reserve(TERMINAL_OUTPUT_RESERVE);
+
+    return 0;
+}
+
+// Comma separated key names for keys 0 to F
+void TerminalBackend::configure(const Config &config) {
+    char  buffer[KEYMAP_MAX_LEN];
+    char *save;
+    int   key = 0;
+
+    for (int i = 0; i < 16; ++i) {
+        m_keymap[i] = default_keys[i];
+    }
+    if (config.keys[0] == '\0') return;
+
+    strncpy(buffer, config.keys, KEYMAP_MAX_LEN - 1);
+    buffer[KEYMAP_MAX_LEN - 1] = '\0';
+
+    for (char *name = strtok_r(buffer, ",", &save); name != NULL && key < 16; name = strtok_r(NULL, ",", &save), ++key) {
+        while (*name == ' ') ++name;
+
+        int code = key_code(name);
+        if (code < 0) {
+            fprintf(stderr, "Unknown key %s for %X, keeping the default\n", name, key);
+        } else {
+            m_keymap[key] = code;
+        }
+    }
+}
+
+void TerminalBackend::push(BackendEvent::Type type, int key, uint64_t time) {
+    BackendEvent event = { type, key, time };
+    m_events.push_back(event);
+}
+
+// A repeat only extends the hold
+void TerminalBackend::press(int code, uint64_t time) {
+    for (int key = 0; key < 16; ++key) {
+        if (m_keymap[key] != code) continue;
+
+        if (m_release[key] == 0) push(BackendEvent::KEY_DOWN, key, time);
+        m_release[key] = time + TERMINAL_KEY_HOLD_MS * 1000000ull;
+    }
+}
+
+void TerminalBackend::read_input() {
+    unsigned char buffer[64];
+    ssize_t       count;
+
+    while ((count = read(STDIN_FILENO, buffer, sizeof buffer)) > 0) {
+        uint64_t time = now();
+
+        for (ssize_t i = 0; i < count; ++i) {
+            unsigned char c = buffer[i];
+
+            if (c == 0x03) {
+                push(BackendEvent::QUIT, 0, time);
+            } else if (c == 0x1b && i + 2 < count && (buffer[i + 1] == '[' || buffer[i + 1] == 'O')) {
+                // arrows, other sequences are skipped up to their final byte
+                unsigned char final = buffer[i + 2];
+                i += 2;
+                if (final >= 'A' && final <= 'D') press(ARROW_KEY(final), time);
+                else while (i < count && !(buffer[i] >= 0x40 && buffer[i] <= 0x7E)) ++i;
+            } else if (c == 0x1b) {
+                // a lone escape, sequences arrive in one read
+                push(BackendEvent::QUIT, 0, time);
+            } else if (c == '\t') {
+                push(BackendEvent::NEXT_SPEED, 0, time);
+            } else {
+                press(tolower(c), time);
+            }
+        }
+    }
+}
+
+bool TerminalBackend::poll(BackendEvent &event) {
+    if (m_events.empty()) {
+        uint64_t time = now();
+
+        read_input();
+
+        for (int key = 0; key < 16; ++key) {
+            if (m_release[key] != 0 && m_release[key] <= time) {
+                push(BackendEvent::KEY_UP, key, m_release[key]);
+                m_release[key] = 0;
+            }
+        }
+
+        if (m_events.empty()) return false;
+    }
+
+    event = m_events.front();
+    m_events.pop_front();
+    return true;
+}
+
+void TerminalBackend::move_to(int row, int col) {
+    char sequence[16];
+
+    if (row == m_row && col == m_col) return;
+
+    snprintf(sequence, sizeof sequence, ESC "[%d;%dH", row + 1, col + 1);
+    m_out += sequence;
+    m_row = row;
+    m_col = col;
+}
+
+// Negative colors are left as they are
+void TerminalBackend::color(int fg, int bg) {
+    char sequence[16];
+
+    if (fg >= 0 && fg != m_fg) {
+        snprintf(sequence, sizeof sequence, ESC "[38;5;%dm", fg);
+        m_out += sequence;
+        m_fg = fg;
+    }
+    if (bg >= 0 && bg != m_bg) {
+        snprintf(sequence, sizeof sequence, ESC "[48;5;%dm", bg);
+        m_out += sequence;
+        m_bg = bg;
+    }
+}
+
+void TerminalBackend::present(C8_Context &context, C8_Profiler &profiler) {
+    int  width  = C8_DISPLAY_WIDTH(&context);
+    int  height = C8_DISPLAY_HEIGHT(&context);
+    char status[64];
+
+    m_out.clear();
+
+    // a resolution switch redraws everything
+    if (width != m_width || height != m_height) {
+        m_out += ESC "[0m" ESC "[2J";
+        memset(m_cells, 0xFF, sizeof m_cells);
+        m_width  = width;
+        m_height = height;
+        m_fg     = m_bg  = -1;
+        m_row    = m_col = -1;
+        m_status.clear();
+    }
+
+    {
+        C8_TRACE_SCOPE("copy_display");
+
+        for (int row = 0; row < height / 2; ++row) {
+            for (int col = 0; col < width; ++col) {
+                int            top    = C8_GET_PIXEL(&context, col, row * 2);
+                int            bottom = C8_GET_PIXEL(&context, col, row * 2 + 1);
+                unsigned char  cell   = (unsigned char)(top | bottom << 2);
+                unsigned char &shown  = m_cells[row * width + col];
+
+                if (cell == shown) continue;
+                shown = cell;
+
+                move_to(row, col);
+                if (top == bottom) {
+                    color(-1, palette[top]);
+                    m_out += ' ';
+                } else {
+                    color(palette[top], palette[bottom]);
+                    m_out += UPPER_HALF;
+                }
+                ++m_col;
+            }
+        }
+    }
+
+    if (m_speed == 1)       snprintf(status, sizeof status, "chip8  Tab speed, Esc quit");
+    else if (m_speed == 0)  snprintf(status, sizeof status, "chip8 [unthrottled]  Tab speed, Esc quit");
+    else                    snprintf(status, sizeof status, "chip8 [%gx]  Tab speed, Esc quit", m_speed);
+
+    if (m_status != status) {
+        m_status = status;
+        move_to(height / 2, 0);
+        m_out += ESC "[0m";
+        m_out += m_status;
+        m_out += ESC "[K";
+        m_fg  = m_bg  = -1;
+        m_row = m_col = -1;
+    }
+
+    if (m_bell) {
+        m_out += '\a';
+        m_bell = false;
+    }
+
+    {
+        C8_TRACE_SCOPE("present");
+
+        for (size_t done = 0; done < m_out.size(); ) {
+            ssize_t n = write(STDOUT_FILENO, m_out.data() + done, m_out.size() - done);
+            if (n <= 0) break;
+            done += (size_t)n;
+        }
+    }
+}
+
+void TerminalBackend::setSpeed(float speed) {
+    m_speed = speed;
+}
+
+C8_Beeper *TerminalBackend::beeper() {
+    return &m_c8Beeper;
+}
+
+// Rung on the next frame, sped up emulations stay quiet like the SDL audio
+void TerminalBackend::bell(void *userdata) {
+    TerminalBackend &backend = *(TerminalBackend*)userdata;
+
+    if (backend.m_speed != 0 && backend.m_speed <= MAX_AUDIBLE_SPEED) backend.m_bell = true;
+}
@@ -0,0 +1,55 @@
+#ifndef BACKEND_TERMINAL_HH
+#define BACKEND_TERMINAL_HH
+
+#include "backend.hh"
+
+#include <deque>
+#include <string>
+#include <termios.h>
+
+/**
+ * @brief ANSI terminal: two pixels per cell with upper half blocks, raw keyboard input
+ *
+ * Only cells that changed since the last frame are written, in one write per frame.
+ * Terminals report presses but not releases, a key is held for TERMINAL_KEY_HOLD_MS
+ * after its last press or repeat.
+*/
+class TerminalBackend : public C8Backend {
+public:
+    TerminalBackend();
+    ~TerminalBackend();
+
+    int  init(const Config &config) override;
+    void configure(const Config &config) override;
+    bool poll(BackendEvent &event) override;
+    void present(C8_Context &context, C8_Profiler &profiler) override;
+    void setSpeed(float speed) override;
+    C8_Beeper *beeper() override;
+
+private:
+    static void bell(void *userdata);
+
+    void read_input();
+    void push(BackendEvent::Type type, int key, uint64_t time);
+    void press(int code, uint64_t time);
+    void move_to(int row, int col);
+    void color(int fg, int bg);
+
+    bool                    m_raw;
+    struct termios          m_saved;
+    int                     m_keymap[16];           // bytes, or the arrow codes above 255
+    uint64_t                m_release[16];          // when held keys are released, 0 if up
+    std::deque<BackendEvent> m_events;
+
+    unsigned char           m_cells[SCREEN_HIRES_WIDTH * SCREEN_HIRES_HEIGHT / 2];  // plane bits of the top pixel, then the bottom one
+    int                     m_width, m_height;      // display size drawn last, in pixels
+    int                     m_row, m_col;           // cursor position, 0 based
+    int                     m_fg, m_bg;             // current colors, -1 if unknown
+    std::string             m_out;
+    std::string             m_status;
+    float                   m_speed;
+    bool                    m_bell;
+    C8_Beeper               m_c8Beeper;
+};
+
+#endif
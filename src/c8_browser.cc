@@ -0,0 +1,187 @@
+#include "c8_browser.hh"
+#include "c8_file.h"
+#include "config.h"
+#include "loader.hh"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+
+#define THUMBNAIL_FRAME_SIZE (SCREEN_WIDTH * SCREEN_HEIGHT)
+
+// Cached thumbnail file, followed by the frames
+struct _C8_ThumbnailHeader {
+    char                    magic[4];               // "C8TN"
+    uint32_t                version;                // THUMBNAIL_VERSION
+    uint32_t                frames;
+    uint32_t                width, height;
+};
+
+// $XDG_CACHE_HOME/chip8/thumbnails or ~/.cache/chip8/thumbnails, created as needed
+static std::string cache_dir() {
+    const char *xdg  = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    std::string dir;
+
+    if (xdg != NULL && xdg[0] != '\0')         dir = xdg;
+    else if (home != NULL && home[0] != '\0')  dir = std::string(home) + "/.cache";
+    else                                       return "";
+
+    for (const char *sub : { "", "/chip8", "/chip8/thumbnails" }) {
+        if (mkdir((dir + sub).c_str(), 0755) != 0 && errno != EEXIST) return "";
+    }
+
+    return dir + "/chip8/thumbnails";
+}
+
+// Hires displays are halved, a thumbnail pixel is lit if any of its four is
+static void capture(const C8_Context *context, BYTE *dst) {
+    int scale = context->hires ? 2 : 1;
+
+    for (int y = 0; y < SCREEN_HEIGHT; ++y) {
+        for (int x = 0; x < SCREEN_WIDTH; ++x) {
+            BYTE pixel = 0;
+
+            for (int dy = 0; dy < scale; ++dy) {
+                for (int dx = 0; dx < scale; ++dx) {
+                    pixel |= C8_GET_PIXEL(context, x * scale + dx, y * scale + dy);
+                }
+            }
+
+            *dst++ = pixel;
+        }
+    }
+}
+
+C8_Browser::C8_Browser() : m_cancel(false) {}
+
+C8_Browser::~C8_Browser() {
+    m_cancel = true;
+    if (m_generator.joinable()) m_generator.join();
+}
+
+void C8_Browser::scan(const std::string &dir) {
+    C8Loader loader;
+
+    m_cacheDir = cache_dir();
+
+    for (const std::string &path : C8Loader::list_games(dir)) {
+        std::unique_ptr<C8_BrowserEntry> entry(new C8_BrowserEntry());
+
+        if (!loader.hash_game(path, entry->hash)) continue;
+
+        entry->path  = path;
+        entry->name  = path.substr(path.find_last_of("/\\") + 1);
+        entry->ready = false;
+        m_entries.push_back(std::move(entry));
+    }
+
+    // the emulation keeps the calling thread, thumbnails use the rest
+    m_generator = std::thread([this] {
+        unsigned    cores = std::thread::hardware_concurrency();
+        C8_WorkPool pool(cores > 1 ? cores - 1 : 1);
+
+        pool.run(m_entries.size(), [this](size_t i) {
+            if (!m_cancel) generate(*m_entries[i]);
+        });
+    });
+}
+
+const BYTE *C8_Browser::frame(size_t index, size_t n) const {
+    const C8_BrowserEntry &e = *m_entries[index];
+
+    if (!e.ready.load(std::memory_order_acquire)) return NULL;
+
+    return e.frames.data() + (n % THUMBNAIL_FRAMES) * THUMBNAIL_FRAME_SIZE;
+}
+
+void C8_Browser::generate(C8_BrowserEntry &entry) {
+    C8_Context context;
+    Config     config;
+    C8Loader   loader;
+    double     next_timer_slot;
+    uint64_t   slots = 0;
+    int        captured = 0;
+
+    if (loadCache(entry)) {
+        entry.ready.store(true, std::memory_order_release);
+        return;
+    }
+
+    C8_Reset(&context, NULL);
+    if (loader.load(entry.path, config, context) != 0) {
+        C8_Destroy(&context);
+        return;
+    }
+
+    // same pacing as the frontend at 1x, without input
+    entry.frames.resize(THUMBNAIL_FRAMES * THUMBNAIL_FRAME_SIZE);
+    next_timer_slot = config.clockspeed / 60.0;
+
+    for (int frame = 0; frame < THUMBNAIL_RUN_FRAMES && !m_cancel; ++frame) {
+        uint64_t until = (uint64_t)ceil(next_timer_slot) - slots;
+
+        if (C8_Run(&context, (int)until) < 0) break;
+        C8_UpdateTimers(&context);
+        slots           += until;
+        next_timer_slot += config.clockspeed / 60.0;
+
+        if (frame % THUMBNAIL_FRAME_STEP == THUMBNAIL_FRAME_STEP - 1) {
+            capture(&context, entry.frames.data() + captured++ * THUMBNAIL_FRAME_SIZE);
+        }
+    }
+
+    // programs that exited or faulted early keep their last frame
+    for (; captured < THUMBNAIL_FRAMES && !m_cancel; ++captured) {
+        capture(&context, entry.frames.data() + captured * THUMBNAIL_FRAME_SIZE);
+    }
+
+    C8_Destroy(&context);
+    if (m_cancel) return;
+
+    saveCache(entry);
+    entry.ready.store(true, std::memory_order_release);
+}
+
+std::string C8_Browser::cachePath(const C8_BrowserEntry &entry) const {
+    char name[32];
+
+    snprintf(name, sizeof name, "/%016llx.thumb", (unsigned long long)entry.hash);
+    return m_cacheDir + name;
+}
+
+bool C8_Browser::loadCache(C8_BrowserEntry &entry) const {
+    _C8_ThumbnailHeader header;
+    size_t              size;
+    char               *data;
+
+    if (m_cacheDir.empty() || (data = c8_read_file(cachePath(entry).c_str(), &size)) == NULL) return false;
+
+    if (size >= sizeof header) memcpy(&header, data, sizeof header);
+    bool ok = size == sizeof header + THUMBNAIL_FRAMES * THUMBNAIL_FRAME_SIZE && memcmp(header.magic, "C8TN", 4) == 0 &&
+              header.version == THUMBNAIL_VERSION && header.frames == THUMBNAIL_FRAMES &&
+              header.width == SCREEN_WIDTH && header.height == SCREEN_HEIGHT;
+
+    if (ok) entry.frames.assign(data + sizeof header, data + size);
+    free(data);
+
+    return ok;
+}
+
+// Duplicate ROMs share a path, each writer gets its own temporary file
+void C8_Browser::saveCache(const C8_BrowserEntry &entry) const {
+    _C8_ThumbnailHeader header = { { 'C', '8', 'T', 'N' }, THUMBNAIL_VERSION, THUMBNAIL_FRAMES, SCREEN_WIDTH, SCREEN_HEIGHT };
+    std::string         path   = cachePath(entry);
+    char                tmp[PATH_MAX_LEN];
+    FILE               *fp;
+
+    if (m_cacheDir.empty() || (fp = c8_write_begin(path.c_str(), tmp)) == NULL) return;
+
+    bool ok = fwrite(&header, sizeof header, 1, fp) == 1 &&
+              fwrite(entry.frames.data(), 1, entry.frames.size(), fp) == entry.frames.size();
+
+    c8_write_end(fp, tmp, path.c_str(), ok);
+}
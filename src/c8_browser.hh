@@ -0,0 +1,52 @@
+#ifndef C8_BROWSER_HH
+#define C8_BROWSER_HH
+
+#include "chip8.h"
+#include "c8_def.h"
+#include "c8_pool.hh"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct C8_BrowserEntry {
+    std::string             path;
+    std::string             name;
+    uint64_t                hash;                   // of the ROM content, names the cached thumbnail
+    std::vector<BYTE>       frames;                 // THUMBNAIL_FRAMES lores frames of plane bits, row major
+    std::atomic<bool>       ready;                  // frames are complete, set once by a worker
+};
+
+/**
+ * @brief ROMs of a directory with animated thumbnails
+ *
+ * Thumbnails come from running each ROM headlessly for THUMBNAIL_RUN_FRAMES frames on
+ * background workers. They are cached on disk under the hash of the ROM content, so
+ * a renamed ROM keeps its thumbnail and an edited one gets a new one.
+*/
+class C8_Browser {
+public:
+    C8_Browser();
+    ~C8_Browser();
+
+    void scan(const std::string &dir);              // lists the ROMs, thumbnails follow in the background
+
+    size_t size() const { return m_entries.size(); }
+    const C8_BrowserEntry &entry(size_t index) const { return *m_entries[index]; }
+    const BYTE *frame(size_t index, size_t n) const;    // NULL until the thumbnail is ready
+
+private:
+    void generate(C8_BrowserEntry &entry);
+    bool loadCache(C8_BrowserEntry &entry) const;
+    void saveCache(const C8_BrowserEntry &entry) const;
+    std::string cachePath(const C8_BrowserEntry &entry) const;
+
+    std::vector<std::unique_ptr<C8_BrowserEntry>> m_entries;
+    std::string m_cacheDir;                         // empty without a cache
+    std::thread m_generator;
+    std::atomic<bool> m_cancel;
+};
+
+#endif
@@ -0,0 +1,120 @@
+#include "chipper.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SOURCE_EXT ".chp"
+#define LIST_EXT   ".lst"
+
+static const char *help_msg = "Usage: c8chipper <TARGET> [SOURCE] [LIST]\n"
+                              "       SOURCE defaults to TARGET" SOURCE_EXT ", LIST to TARGET" LIST_EXT ".\n"
+                              "       \".\" picks the default, \"-\" reads stdin or lists to stdout.\n";
+
+// "." or a missing argument is the target with an extension
+static char *file_name(int argc, char **argv, int index, const char *ext) {
+    const char *target = argv[1];
+    char       *name;
+
+    if (index < argc && strcmp(argv[index], ".") != 0) return strdup(argv[index]);
+
+    name = (char*)malloc(strlen(target) + strlen(ext) + 1);
+    if (name != NULL) sprintf(name, "%s%s", target, ext);
+
+    return name;
+}
+
+static char *read_stream(FILE *fp, size_t *size) {
+    size_t capacity = 4096;
+    char  *buffer   = (char*)malloc(capacity);
+    size_t n;
+
+    *size = 0;
+    while (buffer != NULL && (n = fread(buffer + *size, 1, capacity - *size, fp)) > 0) {
+        *size += n;
+        if (*size == capacity) {
+            char *grown = (char*)realloc(buffer, capacity * 2);
+
+            if (grown == NULL) free(buffer);
+            buffer    = grown;
+            capacity *= 2;
+        }
+    }
+
+    return buffer;
+}
+
+int main(int argc, char **argv) {
+    Chipper_Options options = { NULL, 1, NULL, NULL };
+    Chipper_Result  result;
+    char           *source_name, *list_name;
+    char           *source;
+    size_t          size;
+    FILE           *target, *list;
+    int             use_stdin, use_stdout;
+    int             rv;
+
+    fprintf(stderr, "%s\n\n", CHIPPER_VERSION);
+
+    if (argc < 2 || argc > 4) {
+        fprintf(stderr, "%s", help_msg);
+        return 1;
+    }
+
+    source_name = file_name(argc, argv, 2, SOURCE_EXT);
+    list_name   = file_name(argc, argv, 3, LIST_EXT);
+    if (source_name == NULL || list_name == NULL) return 1;
+
+    use_stdin  = strcmp(source_name, "-") == 0;
+    use_stdout = strcmp(list_name, "-") == 0;
+    if (use_stdin)  { free(source_name); source_name = strdup("stdin"); }
+    if (use_stdout) { free(list_name);   list_name   = strdup("stdout"); }
+    if (source_name == NULL || list_name == NULL) return 1;
+
+    fprintf(stderr, "TargetFile: %s\nSourceFile: %s\nListFile: %s\n\n", argv[1], source_name, list_name);
+
+    if (use_stdin) {
+        source = read_stream(stdin, &size);
+    } else {
+        FILE *fp = fopen(source_name, "rb");
+
+        source = fp ? read_stream(fp, &size) : NULL;
+        if (fp) fclose(fp);
+    }
+    if (source == NULL) {
+        fprintf(stderr, "Cannot read %s\n", source_name);
+        return 1;
+    }
+
+    target = fopen(argv[1], "wb");
+    list   = use_stdout ? stdout : fopen(list_name, "w");
+    if (target == NULL || list == NULL) {
+        fprintf(stderr, "Cannot open %s\n", target == NULL ? argv[1] : list_name);
+        return 1;
+    }
+
+    options.name = source_name;
+    rv = Chipper_Assemble(source, size, &options, &result);
+
+    if (result.messages != NULL) fputs(result.messages, stderr);
+    fprintf(stderr, "Total number of warnings: %u\n", result.warnings);
+
+    fprintf(list, "%s\n\nTargetFile: %s\nSourceFile: %s\nListFile: %s\n\n", CHIPPER_VERSION, argv[1], source_name, list_name);
+    if (result.listing != NULL) fputs(result.listing, list);
+
+    // a failed assembly leaves the target empty, as chipper did
+    if (rv == CHIPPER_OK && fwrite(result.output, 1, result.output_size, target) != result.output_size) {
+        fprintf(stderr, "Failed to write %s\n", argv[1]);
+        rv = CHIPPER_ERROR;
+    }
+
+    if (fclose(target) != 0) rv = CHIPPER_ERROR;
+    if (list != stdout && fclose(list) != 0) rv = CHIPPER_ERROR;
+
+    Chipper_Free(&result);
+    free(source);
+    free(source_name);
+    free(list_name);
+
+    return rv == CHIPPER_OK ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+#include "c8_config_watch.hh"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+static bool read_text(const std::string &path, std::string &text) {
+    FILE *fp = fopen(path.c_str(), "rb");
+    char  buffer[4096];
+    size_t n;
+
+    if (fp == NULL) return false;
+
+    text.clear();
+    while ((n = fread(buffer, 1, sizeof buffer, fp)) > 0) text.append(buffer, n);
+
+    fclose(fp);
+    return true;
+}
+
+static std::string trim(const std::string &s) {
+    std::size_t first = s.find_first_not_of(" \t\r");
+    std::size_t last  = s.find_last_not_of(" \t\r");
+
+    return (first == std::string::npos) ? "" : s.substr(first, last - first + 1);
+}
+
+C8_ConfigWatcher::C8_ConfigWatcher() : m_hash(0), m_fd(-1), m_wake{ -1, -1 }, m_ready(false) {
+    config_defaults(&m_base);
+    config_defaults(&m_pending);
+}
+
+C8_ConfigWatcher::~C8_ConfigWatcher() {
+    stop();
+}
+
+bool C8_ConfigWatcher::watch(const std::string &path, const Config &config, uint64_t hash) {
+    std::size_t found = path.find_last_of('/');
+
+    stop();
+
+    m_path = path;
+    m_dir  = (found == std::string::npos) ? "." : path.substr(0, found);
+    m_name = path.substr(found + 1);
+    m_hash = hash;
+
+    // the memory layout is only chosen at load
+    config_defaults(&m_base);
+    memcpy(m_base.game_name, config.game_name, GAME_NAME_MAX_LEN);
+    m_base.xochip = config.xochip;
+
+    // the directory is watched as editors may rename a new file over config.cfg
+    m_fd = inotify_init1(IN_CLOEXEC);
+    if (m_fd < 0 || inotify_add_watch(m_fd, m_dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0 || pipe(m_wake) != 0) {
+        stop();
+        return false;
+    }
+
+    m_ready  = false;
+    m_thread = std::thread(&C8_ConfigWatcher::run, this);
+
+    return true;
+}
+
+void C8_ConfigWatcher::stop() {
+    if (m_thread.joinable()) {
+        if (write(m_wake[1], "", 1) != 1) perror("config watcher");
+        m_thread.join();
+    }
+
+    for (int *fd : { &m_fd, &m_wake[0], &m_wake[1] }) {
+        if (*fd >= 0) close(*fd);
+        *fd = -1;
+    }
+}
+
+bool C8_ConfigWatcher::take(Config &config) {
+    if (!m_ready.load(std::memory_order_acquire)) return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    config  = m_pending;
+    m_ready = false;
+
+    return true;
+}
+
+void C8_ConfigWatcher::run() {
+    alignas(struct inotify_event) char buffer[4096];
+    struct pollfd fds[2] = { { m_fd, POLLIN, 0 }, { m_wake[0], POLLIN, 0 } };
+    std::string   text;
+
+    // what the game was loaded with
+    if (read_text(m_path, text)) m_sections = sections(text);
+
+    for (;;) {
+        bool    saved = false;
+        ssize_t length;
+
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (fds[1].revents) return;
+
+        length = read(m_fd, buffer, sizeof buffer);
+        for (char *p = buffer; p < buffer + length; ) {
+            const struct inotify_event *event = (const struct inotify_event*)p;
+
+            if ((event->mask & IN_Q_OVERFLOW) || (event->len > 0 && m_name == event->name)) saved = true;
+            p += sizeof(struct inotify_event) + event->len;
+        }
+
+        if (saved) reload();
+    }
+}
+
+void C8_ConfigWatcher::reload() {
+    std::string text;
+    Config      config = m_base;
+
+    if (!read_text(m_path, text)) return;
+
+    text = sections(text);
+    if (text == m_sections) return;             // another game's entry changed
+    m_sections = text;
+
+    if (load_config_string(&config, m_base.game_name, m_hash, text.c_str()) != 0) {
+        fprintf(stderr, "Ignored invalid lines of [%s] in %s\n", m_base.game_name, m_path.c_str());
+    }
+
+    if (config.xochip != m_base.xochip) {
+        fprintf(stderr, "xochip changes apply when %s is loaded again\n", m_base.game_name);
+        config.xochip = m_base.xochip;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending = config;
+    m_ready.store(true, std::memory_order_release);
+}
+
+// Sections naming the game or its hash, headers included, in file order
+std::string C8_ConfigWatcher::sections(const std::string &text) const {
+    std::istringstream lines(text);
+    std::string        line, result;
+    bool               game = false;
+
+    while (std::getline(lines, line)) {
+        std::string trimmed = trim(line);
+
+        if (!trimmed.empty() && trimmed[0] == '[') {
+            std::size_t end = trimmed.find(']');
+
+            game = end != std::string::npos &&
+                   config_matches(trim(trimmed.substr(1, end - 1)).c_str(), m_base.game_name, m_hash);
+        }
+
+        if (game) result += line + "\n";
+    }
+
+    return result;
+}
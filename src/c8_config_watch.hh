@@ -0,0 +1,52 @@
+#ifndef C8_CONFIG_WATCH_HH
+#define C8_CONFIG_WATCH_HH
+
+#include "config.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Follows the config.cfg of the running game
+ *
+ * A background thread waits on inotify for the file to be saved. It then reads the file
+ * and keeps only the sections of the game. Those are parsed only when their text
+ * changed. Edits to other games cost one read. The new settings wait in a single slot
+ * until the frontend takes them between two frames.
+*/
+class C8_ConfigWatcher {
+public:
+    C8_ConfigWatcher();
+    ~C8_ConfigWatcher();
+    C8_ConfigWatcher(const C8_ConfigWatcher&) = delete;
+    C8_ConfigWatcher &operator=(const C8_ConfigWatcher&) = delete;
+
+    bool watch(const std::string &path, const Config &config, uint64_t hash);   // config.cfg the game's config was read from
+    void stop();
+
+    bool take(Config &config);                      // true with the latest settings if they changed since the last call
+
+private:
+    void run();
+    void reload();
+    std::string sections(const std::string &text) const;
+
+    std::string m_path;
+    std::string m_dir;
+    std::string m_name;                             // of config.cfg in m_dir
+    Config m_base;                                  // defaults, with the settings that need a restart as loaded
+    uint64_t m_hash;
+    std::string m_sections;                         // text of the game's sections at the last parse
+
+    int m_fd;                                       // inotify instance
+    int m_wake[2];                                  // written by stop
+    std::thread m_thread;
+
+    std::mutex m_mutex;
+    Config m_pending;
+    std::atomic<bool> m_ready;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#include "config_db.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+
+static const char *help_msg = "Usage: c8configdb <DB_PATH> <CONFIG_PATH|GAMES_DIR>...\n"
+                              "       c8configdb --list <DB_PATH>\n";
+
+static void print_record(const ConfigDB *db, const ConfigRecord *r) {
+    printf("%016" PRIx64 "  %-16s", r->hash, config_db_string(db, r->name));
+
+    if (r->fields & CONFIG_WRAPY)      printf("  wrapy=%d", r->wrapy);
+    if (r->fields & CONFIG_XOCHIP)     printf("  xochip=%d", r->xochip);
+    if (r->fields & CONFIG_CLOCKSPEED) printf("  clockspeed=%g", r->clockspeed);
+    if (r->fields & CONFIG_FPS)        printf("  fps=%g", r->fps);
+    if (r->fields & CONFIG_SPEED)      printf("  speed=%g", r->speed);
+    if (r->fields & CONFIG_KEYS)       printf("  keys=%s", config_db_string(db, r->keys));
+    printf("\n");
+}
+
+static int list(const char *path) {
+    ConfigDB db;
+
+    if (config_db_open(&db, path) != 0) {
+        fprintf(stderr, "Not a config database: %s\n", path);
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < db.count; ++i) {
+        print_record(&db, &db.records[i]);
+    }
+
+    config_db_close(&db);
+    return 0;
+}
+
+static void free_configs(const char **configs, int count, char **argv) {
+    // directories were given as their malloc'd config.cfg path
+    for (int i = 0; i < count; ++i) {
+        if (configs[i] != argv[i + 2]) free((void*)configs[i]);
+    }
+    free(configs);
+}
+
+int main(int argc, char **argv) {
+    const char **configs;
+    int          count = 0;
+    int          rv;
+
+    if (argc == 3 && strcmp(argv[1], "--list") == 0) return list(argv[2]);
+
+    if (argc < 3) {
+        fprintf(stderr, "%s", help_msg);
+        return 1;
+    }
+
+    configs = (const char**)calloc(argc, sizeof(char*));
+    if (configs == NULL) return 1;
+
+    // a games directory stands for its config.cfg
+    for (int i = 2; i < argc; ++i) {
+        struct stat st;
+
+        if (stat(argv[i], &st) == 0 && S_ISDIR(st.st_mode)) {
+            char *path = (char*)malloc(strlen(argv[i]) + sizeof("/config.cfg"));
+
+            if (path == NULL) {
+                free_configs(configs, count, argv);
+                return 1;
+            }
+            sprintf(path, "%s/config.cfg", argv[i]);
+            configs[count++] = path;
+        } else {
+            configs[count++] = argv[i];
+        }
+    }
+
+    rv = config_db_compile(argv[1], configs, count);
+    free_configs(configs, count, argv);
+    if (rv < 0) {
+        fprintf(stderr, "Failed to compile %s\n", argv[1]);
+        return 1;
+    }
+
+    printf("%d games written to %s\n", rv, argv[1]);
+    return 0;
+}
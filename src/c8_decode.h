@@ -1,21 +1,50 @@
 #ifndef C8_DECODE_H
 #define C8_DECODE_H
 
-#define C8_DECODE_FUNC_GEN(funcName, contextType, opFunPrefix)                          \
+// XO-CHIP opcodes are only decoded when the xochip expression over context holds, they
+// are invalid otherwise, as C8_INSTRUCTION_SIZE_AT only sizes F000 NNNN with XO-CHIP
+#define C8_DECODE_FUNC_GEN(funcName, contextType, opFunPrefix, xochip)                  \
     int funcName(contextType context, WORD opcode) {                                    \
         switch(C8_OPCODE_SELECT_OP(opcode)) {                                           \
             case 0x0:                                                                   \
                 switch(opcode) {                                                        \
                     case 0x00E0: opFunPrefix##00E0(context, opcode); break;             \
                     case 0x00EE: opFunPrefix##00EE(context, opcode); break;             \
-                    default: return opcode;                                             \
+                    case 0x00FB: opFunPrefix##00FB(context, opcode); break;             \
+                    case 0x00FC: opFunPrefix##00FC(context, opcode); break;             \
+                    case 0x00FD: opFunPrefix##00FD(context, opcode); break;             \
+                    case 0x00FE: opFunPrefix##00FE(context, opcode); break;             \
+                    case 0x00FF: opFunPrefix##00FF(context, opcode); break;             \
+                    default:                                                            \
+                        switch(opcode & 0xFFF0) {                                       \
+                            case 0x00C0: opFunPrefix##00CN(context, opcode); break;     \
+                            case 0x00D0:                                                \
+                                if (!(xochip)) return opcode;                           \
+                                opFunPrefix##00DN(context, opcode);                     \
+                                break;                                                  \
+                            default: return opcode;                                     \
+                        }                                                               \
+                        break;                                                          \
                 }                                                                       \
                 break;                                                                  \
             case 0x1: opFunPrefix##1NNN(context, opcode); break;                        \
             case 0x2: opFunPrefix##2NNN(context, opcode); break;                        \
             case 0x3: opFunPrefix##3XNN(context, opcode); break;                        \
             case 0x4: opFunPrefix##4XNN(context, opcode); break;                        \
-            case 0x5: opFunPrefix##5XY0(context, opcode); break;                        \
+            case 0x5:                                                                   \
+                switch(C8_OPCODE_SELECT_N(opcode)) {                                    \
+                    case 0x0: opFunPrefix##5XY0(context, opcode); break;                \
+                    case 0x2:                                                           \
+                        if (!(xochip)) return opcode;                                   \
+                        opFunPrefix##5XY2(context, opcode);                             \
+                        break;                                                          \
+                    case 0x3:                                                           \
+                        if (!(xochip)) return opcode;                                   \
+                        opFunPrefix##5XY3(context, opcode);                             \
+                        break;                                                          \
+                    default: return opcode;                                             \
+                }                                                                       \
+                break;                                                                  \
             case 0x6: opFunPrefix##6XNN(context, opcode); break;                        \
             case 0x7: opFunPrefix##7XNN(context, opcode); break;                        \
             case 0x8:                                                                   \
@@ -36,7 +65,10 @@
             case 0xA: opFunPrefix##ANNN(context, opcode); break;                        \
             case 0xB: opFunPrefix##BNNN(context, opcode); break;                        \
             case 0xC: opFunPrefix##CXNN(context, opcode); break;                        \
-            case 0xD: opFunPrefix##DXYN(context, opcode); break;                        \
+            case 0xD:                                                                   \
+                if (C8_OPCODE_SELECT_N(opcode)) opFunPrefix##DXYN(context, opcode);     \
+                else                            opFunPrefix##DXY0(context, opcode);     \
+                break;                                                                  \
             case 0xE:                                                                   \
                 switch(C8_OPCODE_SELECT_NN(opcode)) {                                   \
                     case 0x9E: opFunPrefix##EX9E(context, opcode); break;               \
@@ -46,15 +78,34 @@
                 break;                                                                  \
             case 0xF:                                                                   \
                 switch(C8_OPCODE_SELECT_NN(opcode)) {                                   \
+                    case 0x00:                                                          \
+                        if (opcode != 0xF000 || !(xochip)) return opcode;               \
+                        opFunPrefix##F000(context, opcode);                             \
+                        break;                                                          \
+                    case 0x01:                                                          \
+                        if (!(xochip)) return opcode;                                   \
+                        opFunPrefix##FN01(context, opcode);                             \
+                        break;                                                          \
+                    case 0x02:                                                          \
+                        if (opcode != 0xF002 || !(xochip)) return opcode;               \
+                        opFunPrefix##F002(context, opcode);                             \
+                        break;                                                          \
                     case 0x07: opFunPrefix##FX07(context, opcode); break;               \
                     case 0x0A: opFunPrefix##FX0A(context, opcode); break;               \
                     case 0x15: opFunPrefix##FX15(context, opcode); break;               \
                     case 0x18: opFunPrefix##FX18(context, opcode); break;               \
                     case 0x1E: opFunPrefix##FX1E(context, opcode); break;               \
                     case 0x29: opFunPrefix##FX29(context, opcode); break;               \
+                    case 0x30: opFunPrefix##FX30(context, opcode); break;               \
                     case 0x33: opFunPrefix##FX33(context, opcode); break;               \
+                    case 0x3A:                                                          \
+                        if (!(xochip)) return opcode;                                   \
+                        opFunPrefix##FX3A(context, opcode);                             \
+                        break;                                                          \
                     case 0x55: opFunPrefix##FX55(context, opcode); break;               \
                     case 0x65: opFunPrefix##FX65(context, opcode); break;               \
+                    case 0x75: opFunPrefix##FX75(context, opcode); break;               \
+                    case 0x85: opFunPrefix##FX85(context, opcode); break;               \
                     default: return opcode;                                             \
                 }                                                                       \
                 break;                                                                  \
@@ -12,5 +12,35 @@
 #define DEFAULT_FPS 60
 #define DEFAULT_CLOCKSPEED 500
 #define DEFAULT_WRAPY 1
+#define DEFAULT_XOCHIP 0
+#define DEFAULT_SPEED 1                                         // emulation speed multiplier, 0 runs unthrottled
+
+#define MAX_AUDIBLE_SPEED 4                                     // audio is muted above
+#define MAX_FRAMESKIP 8                                         // frames skipped in a row while the emulation is behind
+#define MAX_BACKLOG_IN_SECONDS 0.25                             // owed emulation time, the rest is dropped
+#define TURBO_PRESENT_SHARE 0.1                                 // time left to presentation away from 1x
+
+#define PROFILER_KEYFRAME_INTERVAL 1000                         // cycles replayed at most by a seek
+#define PROFILER_HISTORY_BUDGET_IN_BYTES (32 * 1024 * 1024)      // keyframes and inputs, oldest dropped first
+#define PROFILER_LATENCY_SAMPLES 120                            // input latencies averaged by the profiler
+#define PROFILER_HEAT_DECAY 4                                   // memory view heat lost per frame, a write fades in about a second
+#define PROFILER_MEMORY_HEIGHT 160                              // memory view rows in pixels
+
+#define TRACE_BUFFER_EVENTS (1 << 18)                           // timed scopes kept per thread for export
+#define TRACE_FRAME_HISTORY 512                                 // frames shown by the profiler
+#define TRACE_MAX_ZONES 16                                      // distinct scope names broken down per frame
+#define TRACE_HISTOGRAM_BUCKETS 34                              // 1 ms wide, the last one holds longer frames
+
+#define THUMBNAIL_RUN_FRAMES 300                                // frames each ROM runs headlessly for its thumbnail
+#define THUMBNAIL_FRAME_STEP 10                                 // frames between two kept thumbnail frames
+#define THUMBNAIL_FRAMES (THUMBNAIL_RUN_FRAMES / THUMBNAIL_FRAME_STEP)
+#define THUMBNAIL_VERSION 2                                     // bump when thumbnails change, invalidates the cache
+#define THUMBNAIL_SCALE 2                                       // shown at twice the lores size
+#define BROWSER_ATLAS_COLUMNS 16                                // thumbnails per row of the browser texture
+#define BROWSER_LOADING_COLOR 0xFF202020                        // thumbnails still being generated
+
+#define DEFAULT_BACKEND "sdl"                                   // overridden by CHIP8_BACKEND
+#define TERMINAL_KEY_HOLD_MS 150                                // terminals report no releases, keys are held this long
+#define TERMINAL_OUTPUT_RESERVE (64 * 1024)                     // frame output buffered before the single write
 
 #endif
\ No newline at end of file
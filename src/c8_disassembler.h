@@ -27,20 +27,29 @@ extern "C" {
 #define FMT_X(mnemonic)                 C8_DISASSEMBLE_CORE("%s\tV%X",      mnemonic, C8_OPCODE_SELECT_X(opcode))
 #define FMT_SX(mnemonic, s)             C8_DISASSEMBLE_CORE("%s\t%s, V%X",  mnemonic, s, C8_OPCODE_SELECT_X(opcode))
 #define FMT_XS(mnemonic, s)             C8_DISASSEMBLE_CORE("%s\tV%X, %s",  mnemonic, C8_OPCODE_SELECT_X(opcode), s)
+#define FMT_N(mnemonic)                 C8_DISASSEMBLE_CORE("%s\t#%X",      mnemonic, C8_OPCODE_SELECT_N(opcode))
 
 inline void c8_disassembleFX1E(char **context, WORD opcode) { FMT_SX("ADD", "I") }
+inline void c8_disassembleF002(char **context, WORD opcode) { *context = strdup("AUDIO"); }
 inline void c8_disassemble7XNN(char **context, WORD opcode) { FMT_XNN("ADD") }
 inline void c8_disassemble8XY4(char **context, WORD opcode) { FMT_XY("ADD") }
 inline void c8_disassemble8XY2(char **context, WORD opcode) { FMT_XY("AND") }
 inline void c8_disassemble2NNN(char **context, WORD opcode) { FMT_NNN("CALL") }
 inline void c8_disassemble00E0(char **context, WORD opcode) { *context = strdup("CLS"); }
 inline void c8_disassembleDXYN(char **context, WORD opcode) { FMT_XYN("DRW") }
+inline void c8_disassembleDXY0(char **context, WORD opcode) { FMT_XYN("DRW") }
+inline void c8_disassemble00FD(char **context, WORD opcode) { *context = strdup("EXIT"); }
+inline void c8_disassemble00FF(char **context, WORD opcode) { *context = strdup("HIGH"); }
 inline void c8_disassemble1NNN(char **context, WORD opcode) { FMT_NNN("JP") }
 inline void c8_disassembleBNNN(char **context, WORD opcode) { FMT_HNNN("JP", 0) }
 inline void c8_disassembleFX33(char **context, WORD opcode) { FMT_SX("LD", "B") }
 inline void c8_disassembleFX15(char **context, WORD opcode) { FMT_SX("LD", "DT") }
 inline void c8_disassembleFX29(char **context, WORD opcode) { FMT_SX("LD", "F") }
+inline void c8_disassembleFX30(char **context, WORD opcode) { FMT_SX("LD", "HF") }
+inline void c8_disassembleFX75(char **context, WORD opcode) { FMT_SX("LD", "R") }
+inline void c8_disassembleFX85(char **context, WORD opcode) { FMT_XS("LD", "R") }
 inline void c8_disassembleANNN(char **context, WORD opcode) { FMT_NNN_REG("LD", "I") }
+inline void c8_disassembleF000(char **context, WORD opcode) { *context = strdup("LD\tI, LONG"); }
 inline void c8_disassembleFX18(char **context, WORD opcode) { FMT_SX("LD", "ST") }
 inline void c8_disassemble6XNN(char **context, WORD opcode) { FMT_XNN("LD") }
 inline void c8_disassembleFX07(char **context, WORD opcode) { FMT_XS("LD", "DT") }
@@ -48,9 +57,18 @@ inline void c8_disassembleFX0A(char **context, WORD opcode) { FMT_XS("LD", "K")
 inline void c8_disassemble8XY0(char **context, WORD opcode) { FMT_XY("LD") }
 inline void c8_disassembleFX65(char **context, WORD opcode) { FMT_XS("LD", "[I]") }
 inline void c8_disassembleFX55(char **context, WORD opcode) { FMT_SX("LD", "[I]") }
+inline void c8_disassemble00FE(char **context, WORD opcode) { *context = strdup("LOW"); }
 inline void c8_disassemble8XY1(char **context, WORD opcode) { FMT_XY("OR") }
+inline void c8_disassemble5XY3(char **context, WORD opcode) { FMT_XY("LOAD") }
+inline void c8_disassembleFX3A(char **context, WORD opcode) { FMT_X("PITCH") }
+inline void c8_disassembleFN01(char **context, WORD opcode) { C8_DISASSEMBLE_CORE("%s\t#%X", "PLANE", C8_OPCODE_SELECT_X(opcode)) }
 inline void c8_disassemble00EE(char **context, WORD opcode) { *context = strdup("RET"); }
 inline void c8_disassembleCXNN(char **context, WORD opcode) { FMT_XNN("RND") }
+inline void c8_disassemble00CN(char **context, WORD opcode) { FMT_N("SCD") }
+inline void c8_disassemble00FC(char **context, WORD opcode) { *context = strdup("SCL"); }
+inline void c8_disassemble00FB(char **context, WORD opcode) { *context = strdup("SCR"); }
+inline void c8_disassemble5XY2(char **context, WORD opcode) { FMT_XY("SAVE") }
+inline void c8_disassemble00DN(char **context, WORD opcode) { FMT_N("SCU") }
 inline void c8_disassemble3XNN(char **context, WORD opcode) { FMT_XNN("SE") }
 inline void c8_disassemble5XY0(char **context, WORD opcode) { FMT_XY("SE") }
 inline void c8_disassemble8XYE(char **context, WORD opcode) { FMT_X("SHL") }
@@ -63,7 +81,7 @@ inline void c8_disassemble8XY5(char **context, WORD opcode) { FMT_XY("SUB") }
 inline void c8_disassemble8XY7(char **context, WORD opcode) { FMT_XY("SUBN") }
 inline void c8_disassemble8XY3(char **context, WORD opcode) { FMT_XY("XOR") }
 
-inline C8_DECODE_FUNC_GEN(c8_dec, char **, c8_disassemble)
+inline C8_DECODE_FUNC_GEN(c8_dec, char **, c8_disassemble, 1)
 
 // dst must be large enough, e.g const char dst[255];
 inline int c8_disassemble(WORD opcode, char *dst) { 
@@ -71,7 +89,7 @@ inline int c8_disassemble(WORD opcode, char *dst) {
     c8_dec(&res, opcode);
 
     if (res != NULL) {
-        strcpy(res, dst);
+        strcpy(dst, res);
         free((void*)res);
 
         return 0;
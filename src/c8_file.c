@@ -0,0 +1,77 @@
+#include "c8_file.h"
+
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+char *c8_read_file(const char *path, size_t *size) {
+    char *buffer;
+    long  sz;
+    FILE *fp = fopen(path, "rb");
+
+    if (fp == NULL) return NULL;
+
+    if (fseek(fp, 0L, SEEK_END) != 0 || (sz = ftell(fp)) < 0 || fseek(fp, 0L, SEEK_SET) != 0) {
+        fclose(fp);
+        return NULL;
+    }
+
+    buffer = (char*)malloc(sz + 1);
+    if (buffer != NULL && fread(buffer, 1, sz, fp) != (size_t)sz) {
+        free(buffer);
+        buffer = NULL;
+    }
+    fclose(fp);
+
+    if (buffer != NULL) buffer[sz] = '\0';
+    *size = sz;
+    return buffer;
+}
+
+// Configs and notes are left out
+int c8_is_rom_name(const char *name) {
+    const char *ext = strrchr(name, '.');
+
+    if (name[0] == '.') return 0;
+    if (ext == NULL)    return 1;
+
+    return strcasecmp(ext, ".ch8") == 0 || strcasecmp(ext, ".c8") == 0 || strcasecmp(ext, ".xo8") == 0;
+}
+
+uint32_t c8_append_string(char *strings, uint32_t *size, const char *s) {
+    uint32_t offset = *size;
+    size_t   len    = strlen(s) + 1;
+
+    memcpy(strings + offset, s, len);
+    *size += len;
+
+    return offset;
+}
+
+FILE *c8_write_begin(const char *path, char *tmp) {
+    FILE *fp;
+    int   fd;
+
+    // unique across processes and threads writing the same path
+    if (snprintf(tmp, PATH_MAX_LEN, "%s.XXXXXX", path) >= PATH_MAX_LEN) return NULL;
+
+    fd = mkstemp(tmp);
+    if (fd < 0) return NULL;
+
+    if (fchmod(fd, 0644) != 0 || (fp = fdopen(fd, "wb")) == NULL) {
+        close(fd);
+        remove(tmp);
+        return NULL;
+    }
+
+    return fp;
+}
+
+int c8_write_end(FILE *fp, const char *tmp, const char *path, int ok) {
+    if (fclose(fp) == 0 && ok && rename(tmp, path) == 0) return 0;
+
+    remove(tmp);
+    return -1;
+}
@@ -0,0 +1,33 @@
+#ifndef C8_FILE_H
+#define C8_FILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define PATH_MAX_LEN 4096
+
+char *c8_read_file(const char *path, size_t *size);                   // malloc'd with a NUL past the end, NULL if unreadable
+int   c8_is_rom_name(const char *name);                               // no extension or a CHIP-8 one, not hidden
+
+// Append a NUL terminated string to a string table, return its offset
+uint32_t c8_append_string(char *strings, uint32_t *size, const char *s);
+
+/**
+ * @brief Replace a file without readers ever seeing a partial one
+ *
+ * The content is written to a temporary file next to `path`, which c8_write_end renames
+ * over `path`. Programs mapping the previous file keep their mapping. `tmp` receives the
+ * temporary name and must hold PATH_MAX_LEN bytes.
+*/
+FILE *c8_write_begin(const char *path, char *tmp);                    // NULL if it cannot be created
+int   c8_write_end(FILE *fp, const char *tmp, const char *path, int ok);    // 0 once renamed, the file is removed otherwise
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,84 @@
+#include "c8_grid.hh"
+#include "c8_profiler.hh"
+#include "loader.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+C8_Grid::C8_Grid(unsigned threads)
+    :   m_pool(threads),
+        m_focus(0) {}
+
+C8_Grid::~C8_Grid() {
+    for (auto &instance : m_instances) {
+        C8_Destroy(&instance->context);
+    }
+}
+
+int C8_Grid::load(const std::vector<std::string> &paths) {
+    C8Loader loader;
+
+    for (const std::string &path : paths) {
+        std::unique_ptr<C8_Instance> instance(new C8_Instance());
+
+        C8_Reset(&instance->context, NULL);
+        if (loader.load(path, instance->config, instance->context) != 0) {
+            fprintf(stderr, "Skipping %s\n", path.c_str());
+            C8_Destroy(&instance->context);
+            continue;
+        }
+
+        C8_ClearError(&instance->context);
+        instance->name            = loader.game_name;
+        instance->running         = true;
+        instance->slots           = 0;
+        instance->next_timer_slot = instance->config.clockspeed / 60.0;
+        m_instances.push_back(std::move(instance));
+    }
+
+    return (int)m_instances.size();
+}
+
+void C8_Grid::focus(size_t index, C8_Beeper *beeper, C8_Profiler &profiler) {
+    if (index >= m_instances.size()) return;
+
+    m_instances[m_focus]->context.beeper = NULL;
+    m_focus = index;
+    m_instances[m_focus]->context.beeper = beeper;
+
+    // history recorded on another instance means nothing here
+    profiler.attach(m_instances[m_focus]->context);
+}
+
+bool C8_Grid::running() const {
+    return std::any_of(m_instances.begin(), m_instances.end(),
+        [](const std::unique_ptr<C8_Instance> &instance) { return instance->running; });
+}
+
+// The profiler is only given for the focused instance
+void C8_Grid::run(C8_Instance &instance, C8_Profiler *profiler) {
+    uint64_t until = (uint64_t)ceil(instance.next_timer_slot) - instance.slots;
+    int      rv;
+
+    // the profiler steps a paused instance from the main thread
+    if (!instance.running || (profiler != NULL && profiler->paused())) return;
+
+    // inputs and keyframes go through the profiler for time travel
+    rv = (profiler != NULL) ? profiler->run(until) : C8_Run(&instance.context, (int)until);
+
+    instance.slots += until;
+    if (profiler != NULL) profiler->updateTimers();
+    else                  C8_UpdateTimers(&instance.context);
+    instance.next_timer_slot += instance.config.clockspeed / 60.0;
+
+    if (rv < 0 || C8_GetError(&instance.context).err == C8_EXIT) {
+        instance.running = false;
+    }
+}
+
+void C8_Grid::step(C8_Profiler &profiler) {
+    m_pool.run(m_instances.size(), [&](size_t i) {
+        run(*m_instances[i], (i == m_focus) ? &profiler : NULL);
+    });
+}
@@ -0,0 +1,52 @@
+#ifndef C8_GRID_HH
+#define C8_GRID_HH
+
+#include "chip8.h"
+#include "config.h"
+#include "c8_pool.hh"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class C8_Profiler;
+
+struct C8_Instance {
+    C8_Context              context;
+    Config                  config;
+    std::string             name;
+    bool                    running;                // false once the program exited or failed
+    uint64_t                slots;                  // instruction slots run, idle ones included
+    double                  next_timer_slot;
+};
+
+/**
+ * @brief Several programs emulated side by side
+ *
+ * Instances advance one 60hz timer period of emulated time per step, each at its own
+ * clock speed, spread over a work-stealing pool. The focused one receives the input,
+ * the beeper and the profiler, which runs it for time travel like a single program.
+*/
+class C8_Grid {
+public:
+    explicit C8_Grid(unsigned threads = 0);
+    ~C8_Grid();
+
+    int  load(const std::vector<std::string> &paths);   // Return the number of programs loaded
+    void step(C8_Profiler &profiler);                   // one timer period on every instance
+    void focus(size_t index, C8_Beeper *beeper, C8_Profiler &profiler);
+
+    size_t size() const { return m_instances.size(); }
+    size_t focused() const { return m_focus; }
+    C8_Instance &instance(size_t index) { return *m_instances[index]; }
+    bool running() const;
+
+private:
+    void run(C8_Instance &instance, C8_Profiler *profiler);
+
+    std::vector<std::unique_ptr<C8_Instance>> m_instances;
+    C8_WorkPool m_pool;
+    size_t m_focus;
+};
+
+#endif
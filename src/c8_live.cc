@@ -0,0 +1,159 @@
+#include "c8_live.hh"
+#include "c8_trace.hh"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+static std::string dir_name(const std::string &path) {
+    std::size_t found = path.find_last_of('/');
+
+    return (found == std::string::npos) ? "" : path.substr(0, found);
+}
+
+C8_LiveSource::C8_LiveSource() : m_fd(-1) {}
+
+C8_LiveSource::~C8_LiveSource() {
+    stop();
+}
+
+bool C8_LiveSource::watch(const std::string &path) {
+    stop();
+
+    if (!Chipper_IsSource(path.c_str())) return false;
+
+    m_path = path;
+
+    // editors save in place or rename a new file over the source
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0 || !assemble(m_image)) {
+        stop();
+        return false;
+    }
+
+    return true;
+}
+
+void C8_LiveSource::stop() {
+    if (m_fd >= 0) close(m_fd);
+
+    m_fd = -1;
+    m_dirs.clear();
+    m_files.clear();
+    m_image.clear();
+    m_symbols.clear();
+}
+
+bool C8_LiveSource::assemble(std::vector<BYTE> &image) {
+    Chipper_Result        result;
+    std::set<std::string> read = { m_path };
+    bool                  ok;
+
+    // includes are read next to the source, as the assembler does by default
+    ok = Chipper_AssembleFile(m_path.c_str(), NULL, &result) == CHIPPER_OK;
+
+    for (const char *line = result.includes; line != NULL && *line; ) {
+        const char *end = strchr(line, '\n');
+
+        read.insert(std::string(line, end - line));
+        line = end + 1;
+    }
+
+    if (ok) {
+        image.assign(result.image, result.image + result.image_size);
+        m_symbols.assign(result.symbols, result.symbols + result.symbol_count);
+        m_files.swap(read);
+    } else {
+        // a file included before the error may be the one to fix
+        fprintf(stderr, "Cannot assemble %s\n%s", m_path.c_str(), result.messages ? result.messages : "");
+        m_files.insert(read.begin(), read.end());
+    }
+
+    Chipper_Free(&result);
+
+    for (const std::string &file : m_files) addWatch(file);
+
+    return ok;
+}
+
+void C8_LiveSource::addWatch(const std::string &file) {
+    std::string dir = dir_name(file);
+    int         wd;
+
+    for (const auto &watched : m_dirs) {
+        if (watched.second == dir) return;
+    }
+
+    wd = inotify_add_watch(m_fd, dir.empty() ? "." : dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd >= 0) m_dirs[wd] = dir;
+}
+
+// Drain the pending events, true if one names a file of the last assembly, read at `when`
+bool C8_LiveSource::changed(uint64_t &when) {
+    alignas(struct inotify_event) char buffer[4096];
+    bool    found = false;
+    ssize_t length;
+
+    while ((length = read(m_fd, buffer, sizeof buffer)) > 0) {
+        if (!found) when = C8_TraceNow();
+
+        for (char *p = buffer; p < buffer + length; ) {
+            const struct inotify_event *event = (const struct inotify_event*)p;
+            auto                        dir   = m_dirs.find(event->wd);
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                found = true;
+            } else if (event->len > 0 && dir != m_dirs.end()) {
+                std::string file = dir->second.empty() ? event->name : dir->second + "/" + event->name;
+
+                if (m_files.count(file)) found = true;
+            }
+
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+
+    return found;
+}
+
+C8_LivePatch C8_LiveSource::poll(C8_Context &context) {
+    C8_LivePatch      patch = { C8_LivePatch::NONE, 0, 0, 0, 0 };
+    std::vector<BYTE> image;
+    uint64_t          start = 0;
+
+    if (!active() || !changed(start)) return patch;
+
+    C8_TRACE_SCOPE("live");
+
+    patch.status = C8_LivePatch::FAILED;
+    if (!assemble(image)) return patch;
+
+    size_t available = C8_MEMORY_END(&context) - USER_MEMORY_START;
+    if (image.size() > available) {
+        fprintf(stderr, "%s does not fit in memory (%zu bytes)\n", m_path.c_str(), image.size());
+        return patch;
+    }
+
+    // bytes past the end of a shorter image are cleared, as before the load
+    size_t end = std::max(image.size(), m_image.size());
+    for (size_t i = 0; i < end; ++i) {
+        BYTE value    = i < image.size()   ? image[i]   : 0;
+        BYTE previous = i < m_image.size() ? m_image[i] : 0;
+
+        if (value == previous) continue;
+
+        context.memory[USER_MEMORY_START + i] = value;
+        if (patch.bytes++ == 0) patch.first = (WORD)(USER_MEMORY_START + i);
+        patch.last = (WORD)(USER_MEMORY_START + i);
+    }
+
+    if (patch.bytes > 0) C8_InvalidateCode(&context, patch.first, patch.last - patch.first + 1);
+
+    m_image.swap(image);
+    patch.status = C8_LivePatch::PATCHED;
+    patch.ms     = (C8_TraceNow() - start) / 1e6;
+
+    return patch;
+}
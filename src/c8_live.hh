@@ -0,0 +1,57 @@
+#ifndef C8_LIVE_HH
+#define C8_LIVE_HH
+
+#include "chip8.h"
+#include "chipper.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// Outcome of a poll
+struct C8_LivePatch {
+    enum Status { NONE, PATCHED, FAILED };
+
+    Status                  status;
+    size_t                  bytes;                  // bytes written to guest memory
+    WORD                    first, last;            // patched range, last included
+    double                  ms;                     // from reading the event to the patched memory
+};
+
+/**
+ * @brief Keeps a running program in sync with its CHIPPER source
+ *
+ * The source and its include files are watched with inotify. After a save, the source
+ * is assembled again and the bytes that differ from the previous image are written to
+ * guest memory, without a reset. Bytes the program changed itself, e.g. variables
+ * declared in the source, are kept unless the source changed them too.
+*/
+class C8_LiveSource {
+public:
+    C8_LiveSource();
+    ~C8_LiveSource();
+    C8_LiveSource(const C8_LiveSource&) = delete;
+    C8_LiveSource &operator=(const C8_LiveSource&) = delete;
+
+    bool watch(const std::string &path);            // false if path is not a source that assembles
+    void stop();
+    bool active() const { return m_fd >= 0; }
+
+    C8_LivePatch poll(C8_Context &context);         // never blocks
+    const std::vector<Chipper_Symbol> &symbols() const { return m_symbols; }
+
+private:
+    bool assemble(std::vector<BYTE> &image);
+    bool changed(uint64_t &when);
+    void addWatch(const std::string &file);
+
+    int m_fd;                                       // inotify instance, -1 when stopped
+    std::string m_path;
+    std::map<int, std::string> m_dirs;              // watch descriptor to directory
+    std::set<std::string> m_files;                  // read by the last assembly
+    std::vector<BYTE> m_image;                      // loaded in guest memory
+    std::vector<Chipper_Symbol> m_symbols;
+};
+
+#endif
@@ -0,0 +1,116 @@
+#include "c8_pack.h"
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Offsets are checked once here, lookups trust them afterwards
+static int validate(const BYTE *base, size_t size) {
+    const C8_PackHeader *header = (const C8_PackHeader*)base;
+    const C8_PackEntry  *entries;
+    size_t               index_end;
+
+    if (size < sizeof(C8_PackHeader)) return -1;
+    if (header->magic != C8_PACK_MAGIC || header->version != C8_PACK_VERSION || header->size != size) return -1;
+
+    index_end = sizeof(C8_PackHeader) + (size_t)header->count * sizeof(C8_PackEntry);
+    if (index_end > size || header->strings < index_end || header->strings_size == 0) return -1;
+    if ((size_t)header->strings + header->strings_size > size || base[header->strings + header->strings_size - 1] != '\0') return -1;
+
+    entries = (const C8_PackEntry*)(header + 1);
+    for (uint32_t i = 0; i < header->count; ++i) {
+        const C8_PackEntry *e = &entries[i];
+
+        if (e->name >= header->strings_size || e->keys >= header->strings_size) return -1;
+        if ((size_t)e->offset + e->size > size) return -1;
+    }
+
+    return 0;
+}
+
+int C8_PackOpen(C8_Pack *pack, const char *path) {
+    const C8_PackHeader *header;
+    struct stat          st;
+    void                *addr;
+    int                  fd;
+
+    memset(pack, 0, sizeof *pack);
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || (size_t)st.st_size < sizeof(C8_PackHeader)) {
+        close(fd);
+        return -1;
+    }
+
+    addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);      // the mapping keeps the file
+    if (addr == MAP_FAILED) return -1;
+
+    if (validate((const BYTE*)addr, st.st_size) != 0) {
+        munmap(addr, st.st_size);
+        return -1;
+    }
+
+    header             = (const C8_PackHeader*)addr;
+    pack->base         = (const BYTE*)addr;
+    pack->size         = st.st_size;
+    pack->entries      = (const C8_PackEntry*)(header + 1);
+    pack->count        = header->count;
+    pack->strings      = (const char*)addr + header->strings;
+    pack->strings_size = header->strings_size;
+
+    return 0;
+}
+
+void C8_PackClose(C8_Pack *pack) {
+    if (pack->base != NULL) munmap((void*)pack->base, pack->size);
+    memset(pack, 0, sizeof *pack);
+}
+
+int C8_IsPack(const char *path) {
+    uint32_t magic = 0;
+    FILE    *fp    = fopen(path, "rb");
+    size_t   n;
+
+    if (fp == NULL) return 0;
+    n = fread(&magic, sizeof magic, 1, fp);
+    fclose(fp);
+
+    return n == 1 && magic == C8_PACK_MAGIC;
+}
+
+const C8_PackEntry *C8_PackFind(const C8_Pack *pack, const char *name) {
+    uint32_t lo = 0;
+    uint32_t hi = pack->count;
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        int      cmp = strcmp(pack->strings + pack->entries[mid].name, name);
+
+        if (cmp == 0) return &pack->entries[mid];
+        if (cmp < 0)  lo = mid + 1;
+        else          hi = mid;
+    }
+
+    return NULL;
+}
+
+const char *C8_PackString(const C8_Pack *pack, uint32_t offset) {
+    return (offset < pack->strings_size) ? pack->strings + offset : "";
+}
+
+const BYTE *C8_PackImage(const C8_Pack *pack, const C8_PackEntry *entry) {
+    return pack->base + entry->offset;
+}
+
+int C8_PackLoad(C8_Context *context, const C8_Pack *pack, const C8_PackEntry *entry) {
+    // memory layout depends on the variant, set it before loading
+    context->config.wrapy  = entry->wrapy;
+    context->config.xochip = entry->xochip;
+
+    return C8_LoadRom(context, C8_PackImage(pack, entry), entry->size);
+}
@@ -0,0 +1,344 @@
+#include "c8_pack.h"
+#include "c8_file.h"
+#include "config.h"
+#include "ini.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <inttypes.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static const char *help_msg = "Usage: c8pack <PACK_PATH> <GAMES_DIR>...\n"
+                              "       c8pack --list <PACK_PATH>\n";
+
+typedef struct {
+    char        name[GAME_NAME_MAX_LEN];
+    BYTE       *image;
+    size_t      size;
+    uint64_t    hash;
+    size_t      order;                                              // duplicates keep the first found
+    Config      config;
+} PackedRom;
+
+typedef struct {
+    PackedRom  *roms;
+    size_t      count;
+    size_t      capacity;
+} PackBuilder;
+
+// Sections of one config.cfg applied to the ROMs of its directory in a single parse
+typedef struct {
+    PackedRom **by_name;
+    PackedRom **by_hash;
+    size_t      count;
+    char        section[GAME_NAME_MAX_LEN + sizeof(CONFIG_HASH_PREFIX) + 16];
+    PackedRom  *name_match;                                         // ROMs the current section applies to
+    PackedRom **hash_match;
+    size_t      hash_count;
+    int         in_section;
+} ConfigApply;
+
+static int compare_names(const void *lhs, const void *rhs) {
+    return strcmp((*(PackedRom *const*)lhs)->name, (*(PackedRom *const*)rhs)->name);
+}
+
+static int compare_hashes(const void *lhs, const void *rhs) {
+    uint64_t a = (*(PackedRom *const*)lhs)->hash;
+    uint64_t b = (*(PackedRom *const*)rhs)->hash;
+
+    return (a > b) - (a < b);
+}
+
+// Same matching as config_matches: the ROM name, or hash:<16 hex digits> for all copies of an image
+static void match_section(ConfigApply *apply, const char *section) {
+    size_t    prefix = strlen(CONFIG_HASH_PREFIX);
+    PackedRom key, *pkey = &key;
+    PackedRom **found;
+
+    apply->name_match = NULL;
+    apply->hash_match = NULL;
+    apply->hash_count = 0;
+
+    if (strlen(section) < GAME_NAME_MAX_LEN) {
+        strcpy(key.name, section);
+        found = (PackedRom**)bsearch(&pkey, apply->by_name, apply->count, sizeof(PackedRom*), compare_names);
+        if (found != NULL) apply->name_match = *found;
+    }
+
+    if (strncasecmp(section, CONFIG_HASH_PREFIX, prefix) != 0 || strlen(section + prefix) != 16) return;
+    for (const char *c = section + prefix; *c; ++c) {
+        if (!isxdigit((unsigned char)*c)) return;
+    }
+
+    key.hash = strtoull(section + prefix, NULL, 16);
+    found    = (PackedRom**)bsearch(&pkey, apply->by_hash, apply->count, sizeof(PackedRom*), compare_hashes);
+    if (found == NULL) return;
+
+    while (found > apply->by_hash && found[-1]->hash == key.hash) --found;
+    apply->hash_match = found;
+    while (found < apply->by_hash + apply->count && (*found)->hash == key.hash) ++found;
+    apply->hash_count = found - apply->hash_match;
+}
+
+static int apply_handler(void *user, const char *section, const char *name, const char *value) {
+    ConfigApply *apply = (ConfigApply*)user;
+    int          ok    = 1;
+
+    if (!apply->in_section || strcmp(section, apply->section) != 0) {
+        snprintf(apply->section, sizeof apply->section, "%s", section);
+        apply->in_section = 1;
+        match_section(apply, section);
+    }
+
+    // a ROM named after its own hash section is only set once
+    if (apply->name_match != NULL && config_set(&apply->name_match->config, name, value) < 0) ok = 0;
+    for (size_t i = 0; i < apply->hash_count; ++i) {
+        if (apply->hash_match[i] != apply->name_match && config_set(&apply->hash_match[i]->config, name, value) < 0) ok = 0;
+    }
+
+    return ok;
+}
+
+static int apply_config(PackedRom *roms, size_t count, const char *path) {
+    ConfigApply apply;
+    int         rv;
+
+    memset(&apply, 0, sizeof apply);
+    apply.count   = count;
+    apply.by_name = (PackedRom**)malloc((count ? count : 1) * sizeof(PackedRom*));
+    apply.by_hash = (PackedRom**)malloc((count ? count : 1) * sizeof(PackedRom*));
+    if (apply.by_name == NULL || apply.by_hash == NULL) {
+        free(apply.by_name);
+        free(apply.by_hash);
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; ++i) apply.by_name[i] = apply.by_hash[i] = &roms[i];
+    qsort(apply.by_name, count, sizeof(PackedRom*), compare_names);
+    qsort(apply.by_hash, count, sizeof(PackedRom*), compare_hashes);
+
+    rv = ini_parse(path, apply_handler, &apply);
+    if (rv < 0) fprintf(stderr, "Failed to read config at %s\n", path);
+
+    free(apply.by_name);
+    free(apply.by_hash);
+    return rv;
+}
+
+static int add_dir(PackBuilder *builder, const char *dir) {
+    char            config_path[PATH_MAX_LEN];
+    struct dirent **names;
+    size_t          first = builder->count;
+    int             n;
+
+    n = scandir(dir, &names, NULL, alphasort);
+    if (n < 0) {
+        fprintf(stderr, "Cannot read %s\n", dir);
+        return -1;
+    }
+
+    for (int i = 0; i < n; ++i) {
+        char        path[PATH_MAX_LEN];
+        struct stat st;
+        PackedRom  *rom;
+
+        snprintf(path, sizeof path, "%s/%s", dir, names[i]->d_name);
+
+        if (!c8_is_rom_name(names[i]->d_name) || strlen(names[i]->d_name) >= GAME_NAME_MAX_LEN
+            || stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+            free(names[i]);
+            continue;
+        }
+
+        if (builder->count == builder->capacity) {
+            size_t     capacity = builder->capacity ? builder->capacity * 2 : 64;
+            PackedRom *roms     = (PackedRom*)realloc(builder->roms, capacity * sizeof(PackedRom));
+
+            if (roms == NULL) return -1;
+            builder->roms     = roms;
+            builder->capacity = capacity;
+        }
+
+        rom        = &builder->roms[builder->count];
+        rom->image = (BYTE*)c8_read_file(path, &rom->size);
+        if (rom->image == NULL) {
+            fprintf(stderr, "Cannot read %s, skipped\n", path);
+            free(names[i]);
+            continue;
+        }
+
+        strcpy(rom->name, names[i]->d_name);
+        rom->hash  = C8_Hash(rom->image, rom->size);
+        rom->order = builder->count;
+        config_defaults(&rom->config);
+        strcpy(rom->config.game_name, rom->name);
+
+        builder->count++;
+        free(names[i]);
+    }
+
+    free(names);
+
+    // parsed once for the whole directory
+    snprintf(config_path, sizeof config_path, "%s/config.cfg", dir);
+    if (access(config_path, R_OK) == 0) apply_config(builder->roms + first, builder->count - first, config_path);
+
+    return 0;
+}
+
+static int compare_roms(const void *lhs, const void *rhs) {
+    const PackedRom *a   = (const PackedRom*)lhs;
+    const PackedRom *b   = (const PackedRom*)rhs;
+    int              cmp = strcmp(a->name, b->name);
+
+    if (cmp != 0) return cmp;
+    return (a->order < b->order) ? -1 : (a->order > b->order);
+}
+
+#define ALIGN_UP(x) (((x) + C8_PACK_ALIGNMENT - 1) & ~(uint64_t)(C8_PACK_ALIGNMENT - 1))
+
+static int write_pack(const char *path, const PackedRom *roms, uint32_t count) {
+    static const BYTE   padding[C8_PACK_ALIGNMENT] = { 0 };
+    char                tmp[PATH_MAX_LEN];
+    C8_PackHeader       header;
+    C8_PackEntry       *entries;
+    char               *strings;
+    uint32_t            strings_size = 1;                           // offset 0 is the empty string
+    uint64_t            offset;
+    FILE               *fp;
+    int                 ok;
+
+    entries = (C8_PackEntry*)calloc(count ? count : 1, sizeof(C8_PackEntry));
+    strings = (char*)calloc(1 + (size_t)count * (GAME_NAME_MAX_LEN + KEYMAP_MAX_LEN), 1);
+    if (entries == NULL || strings == NULL) {
+        free(entries);
+        free(strings);
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        entries[i].name = c8_append_string(strings, &strings_size, roms[i].name);
+        entries[i].keys = roms[i].config.keys[0] ? c8_append_string(strings, &strings_size, roms[i].config.keys) : 0;
+    }
+
+    offset = ALIGN_UP(sizeof(C8_PackHeader) + (uint64_t)count * sizeof(C8_PackEntry) + strings_size);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        C8_PackEntry *e = &entries[i];
+
+        e->hash       = roms[i].hash;
+        e->offset     = offset;
+        e->size       = roms[i].size;
+        e->clockspeed = roms[i].config.clockspeed;
+        e->fps        = roms[i].config.fps;
+        e->speed      = roms[i].config.speed;
+        e->wrapy      = roms[i].config.wrapy;
+        e->xochip     = roms[i].config.xochip;
+
+        offset = ALIGN_UP(offset + roms[i].size);
+    }
+
+    if (offset > UINT32_MAX) {
+        fprintf(stderr, "Pack would exceed 4GiB\n");
+        free(entries);
+        free(strings);
+        return -1;
+    }
+
+    header.magic        = C8_PACK_MAGIC;
+    header.version      = C8_PACK_VERSION;
+    header.count        = count;
+    header.strings      = sizeof(C8_PackHeader) + count * sizeof(C8_PackEntry);
+    header.strings_size = strings_size;
+    header.size         = offset;
+
+    // running emulators keep their mapping of the previous pack
+    fp = c8_write_begin(path, tmp);
+    if (fp == NULL) {
+        free(entries);
+        free(strings);
+        return -1;
+    }
+
+    ok = fwrite(&header, sizeof header, 1, fp) == 1
+      && fwrite(entries, sizeof(C8_PackEntry), count, fp) == count
+      && fwrite(strings, 1, strings_size, fp) == strings_size;
+
+    for (uint32_t i = 0; ok && i < count; ++i) {
+        long pad = (long)entries[i].offset - ftell(fp);
+
+        ok = pad >= 0 && fwrite(padding, 1, pad, fp) == (size_t)pad
+          && fwrite(roms[i].image, 1, roms[i].size, fp) == roms[i].size;
+    }
+    if (ok) {
+        long pad = (long)header.size - ftell(fp);
+        ok = pad >= 0 && fwrite(padding, 1, pad, fp) == (size_t)pad;
+    }
+
+    free(entries);
+    free(strings);
+
+    return c8_write_end(fp, tmp, path, ok);
+}
+
+static int list(const char *path) {
+    C8_Pack pack;
+
+    if (C8_PackOpen(&pack, path) != 0) {
+        fprintf(stderr, "Not a ROM pack: %s\n", path);
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < pack.count; ++i) {
+        const C8_PackEntry *e = &pack.entries[i];
+
+        printf("%016" PRIx64 "  %-16s %6u bytes  wrapy=%d xochip=%d clockspeed=%g fps=%g speed=%g%s%s\n",
+               e->hash, C8_PackString(&pack, e->name), e->size, e->wrapy, e->xochip, e->clockspeed, e->fps, e->speed,
+               e->keys ? "  keys=" : "", C8_PackString(&pack, e->keys));
+    }
+
+    C8_PackClose(&pack);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    PackBuilder builder = { NULL, 0, 0 };
+    size_t      kept    = 0;
+    int         rv;
+
+    if (argc == 3 && strcmp(argv[1], "--list") == 0) return list(argv[2]);
+
+    if (argc < 3) {
+        fprintf(stderr, "%s", help_msg);
+        return 1;
+    }
+
+    for (int i = 2; i < argc; ++i) {
+        if (add_dir(&builder, argv[i]) != 0) return 1;
+    }
+
+    // games are found by name, the first directory wins
+    qsort(builder.roms, builder.count, sizeof(PackedRom), compare_roms);
+    for (size_t i = 0; i < builder.count; ++i) {
+        if (kept > 0 && strcmp(builder.roms[kept - 1].name, builder.roms[i].name) == 0) {
+            fprintf(stderr, "Duplicate %s, skipped\n", builder.roms[i].name);
+            free(builder.roms[i].image);
+            continue;
+        }
+        builder.roms[kept++] = builder.roms[i];
+    }
+
+    rv = write_pack(argv[1], builder.roms, kept);
+    if (rv != 0) {
+        fprintf(stderr, "Failed to write %s\n", argv[1]);
+        return 1;
+    }
+
+    printf("%zu games written to %s\n", kept, argv[1]);
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include "c8_pool.hh"
+
+C8_WorkPool::C8_WorkPool(unsigned threads)
+    :   m_job(nullptr),
+        m_batch(0),
+        m_remaining(0),
+        m_stop(false) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+
+    for (unsigned i = 0; i < threads; ++i) {
+        m_queues.emplace_back(new Queue());
+    }
+    for (unsigned i = 1; i < threads; ++i) {
+        m_threads.emplace_back(&C8_WorkPool::loop, this, i);
+    }
+}
+
+C8_WorkPool::~C8_WorkPool() {
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_stop = true;
+    }
+    m_start.notify_all();
+
+    for (auto &thread : m_threads) {
+        thread.join();
+    }
+}
+
+void C8_WorkPool::run(size_t count, const std::function<void(size_t)> &job) {
+    unsigned workers = threads();
+
+    if (count == 0) return;
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+
+        m_job = &job;
+        m_remaining.store(count, std::memory_order_relaxed);
+
+        for (unsigned w = 0; w < workers; ++w) {
+            std::lock_guard<std::mutex> queue(m_queues[w]->lock);
+
+            for (size_t i = w * count / workers; i < (w + 1) * count / workers; ++i) {
+                m_queues[w]->items.push_back(i);
+            }
+        }
+
+        ++m_batch;
+    }
+    m_start.notify_all();
+
+    work(0);
+
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_done.wait(lock, [this] { return m_remaining.load(std::memory_order_acquire) == 0; });
+    m_job = nullptr;
+}
+
+// Own queue from the back, the others from the front
+bool C8_WorkPool::take(unsigned worker, size_t &item) {
+    unsigned workers = threads();
+
+    for (unsigned k = 0; k < workers; ++k) {
+        Queue &queue = *m_queues[(worker + k) % workers];
+        std::lock_guard<std::mutex> guard(queue.lock);
+
+        if (queue.items.empty()) continue;
+
+        if (k == 0) {
+            item = queue.items.back();
+            queue.items.pop_back();
+        } else {
+            item = queue.items.front();
+            queue.items.pop_front();
+        }
+        return true;
+    }
+
+    return false;
+}
+
+void C8_WorkPool::work(unsigned worker) {
+    size_t item;
+
+    while (take(worker, item)) {
+        (*m_job)(item);
+
+        if (m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_done.notify_all();
+        }
+    }
+}
+
+void C8_WorkPool::loop(unsigned worker) {
+    uint64_t seen = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_start.wait(lock, [&] { return m_stop || m_batch != seen; });
+
+            if (m_stop) return;
+            seen = m_batch;
+        }
+
+        work(worker);
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef C8_POOL_HH
+#define C8_POOL_HH
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Work-stealing thread pool for batches of uneven jobs
+ *
+ * A batch is split in contiguous blocks, one per worker. Workers take from the back of
+ * their own queue and, once it's empty, steal from the front of the others, so a few
+ * expensive jobs don't hold up a whole block. The calling thread works as worker 0.
+*/
+class C8_WorkPool {
+public:
+    explicit C8_WorkPool(unsigned threads = 0);     // 0 uses every core
+    ~C8_WorkPool();
+
+    void run(size_t count, const std::function<void(size_t)> &job);    // job(i) for every i < count, returns when all are done
+    unsigned threads() const { return (unsigned)m_queues.size(); }
+
+private:
+    struct Queue {
+        std::mutex          lock;
+        std::deque<size_t>  items;
+    };
+
+    bool take(unsigned worker, size_t &item);
+    void work(unsigned worker);
+    void loop(unsigned worker);
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_lock;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+    const std::function<void(size_t)> *m_job;
+    uint64_t m_batch;                               // incremented by every run, wakes the workers
+    std::atomic<size_t> m_remaining;
+    bool m_stop;
+};
+
+#endif
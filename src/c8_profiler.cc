@@ -1,53 +1,441 @@
 #include "c8_profiler.hh"
 #include "c8_disassembler.h"
 #include "c8_def.h"
+#include "c8_trace.hh"
 #include "imgui.h"
 
+#include <algorithm>
+#include <cinttypes> // PRIu64
 #include <cstdio> // snprintf
+#include <cstdlib> // strtol
+#include <cstring> // strncmp
+#include <cfloat> // FLT_MAX
 
-#define MAX_OPCODE_SNAPSHOTS_COUNT 512
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-_C8_OpcodeSnapshot::_C8_OpcodeSnapshot(const C8_Context &context) 
-    :   registers(context.registers, &context.registers[15]),
-        pc(context.pc-2),
-        sp(context.sp),
-        addressI(context.addressI),
-        dt(context.delay_timer),
-        st(context.sound_timer) {}
+#define MAX_OPCODE_HISTORY_COUNT 512
 
-void C8_Profiler::render(const int *opcode) {
-    static int selected_index = -1;
-    _C8_OpcodeSnapshot context = (m_opSnapshots.size() != 0 && selected_index != -1 ? m_opSnapshots.at(selected_index) : _C8_OpcodeSnapshot(m_context));
+C8_Profiler::C8_Profiler(C8_Context &context)
+    :   m_context(&context),
+        m_pause(false),
+        m_step(false),
+        m_resume(false),
+        m_batched(false),
+        m_head(0),
+        m_cursor(0),
+        m_eventBase(0),
+        m_keyCycle(),
+        m_latency(),
+        m_latencyCount(0) {}
 
+void C8_Profiler::attach(C8_Context &context) {
+    m_context = &context;
+    m_pause   = false;
+    m_step    = false;
+    m_resume  = false;
+    m_batched = false;
+    m_labels.clear();
+    m_previous.clear();
+    m_pending.clear();
+    m_unseen.clear();
+    std::fill(m_keyCycle, m_keyCycle + 16, 0);
+    forget();
+}
+
+// Keyframes and inputs recorded so far would replay over other code, live keys are kept
+void C8_Profiler::forget() {
+    m_head    = m_context->cycles;
+    m_cursor  = m_eventBase = 0;
+    m_events.clear();
+    m_keyframes.clear();
+    m_history.clear();
+}
+
+void C8_Profiler::setLabels(const std::vector<_C8_Label> &labels) {
+    m_labels = labels;
+}
+
+const _C8_Label *C8_Profiler::label(WORD address) const {
+    auto next = std::upper_bound(m_labels.begin(), m_labels.end(), address,
+                                 [](WORD a, const _C8_Label &l) { return a < l.address; });
+
+    return (next == m_labels.begin()) ? NULL : &*(next - 1);
+}
+
+/* Live execution */
+
+int C8_Profiler::tick() {
+    if (rewound()) {
+        if (m_pause) {
+            // step through the recorded future
+            replay(m_context->cycles + 1);
+            return 1;
+        }
+
+        truncate();
+    }
+
+    applyPending();
+
+    if (m_keyframes.empty() || m_context->cycles - m_keyframes.back().cycle >= PROFILER_KEYFRAME_INTERVAL) {
+        keyframe();
+    }
+
+    _C8_HistoryEntry entry = { m_context->cycles, m_context->pc, 0 };
+    unsigned hits = (m_context->debugger != NULL) ? m_context->debugger->hits : 0;
+    int rv;
+
+    // C8_Run stops on PC breakpoints, C8_Tick executes the instruction regardless
+    if (m_pause || m_resume) {
+        rv = C8_Tick(m_context);
+    } else {
+        rv = C8_Run(m_context, 1);
+    }
+
+    m_resume = false;
+    m_head   = m_context->cycles;
+
+    if (rv < 0) return -1;
+
+    if (m_context->cycles != entry.cycle) {
+        entry.opcode = m_context->last_opcode;
+        m_history.push_back(entry);
+
+        if (m_history.size() > MAX_OPCODE_HISTORY_COUNT) {
+            m_history.pop_front();
+        }
+    }
+
+    if (m_context->debugger != NULL && m_context->debugger->hits != hits) {
+        m_pause = true;
+    }
+
+    return C8_GetError(m_context).err == C8_EXIT ? 0 : 1;
+}
+
+// Runs C8_Run in chunks ending at the next pending key or keyframe. Only single steps,
+// the recorded future and resuming from a breakpoint go through tick.
+int C8_Profiler::run(uint64_t cycles) {
+    uint64_t end = m_context->cycles + cycles;
+
+    while (m_context->cycles < end && !m_pause) {
+        if (m_resume || rewound()) {
+            int rv = tick();
+            if (rv <= 0) return rv;
+            continue;
+        }
+
+        applyPending();
+
+        if (m_keyframes.empty() || m_context->cycles - m_keyframes.back().cycle >= PROFILER_KEYFRAME_INTERVAL) {
+            keyframe();
+        }
+
+        uint64_t chunk = std::min(end, m_keyframes.back().cycle + PROFILER_KEYFRAME_INTERVAL);
+        if (!m_pending.empty()) chunk = std::min(chunk, m_pending.front().cycle);
+        chunk -= m_context->cycles;
+
+        unsigned hits = (m_context->debugger != NULL) ? m_context->debugger->hits : 0;
+        int      rv   = C8_Run(m_context, (int)chunk);
+
+        m_head    = m_context->cycles;
+        m_batched = true;
+
+        if (rv < 0) return -1;
+        if (C8_GetError(m_context).err == C8_EXIT) return 0;
+
+        if (m_context->debugger != NULL && m_context->debugger->hits != hits) {
+            m_pause = true;
+        }
+
+        // waiting for a key
+        if (rv == 0) break;
+    }
+
+    return 1;
+}
+
+// Batched runs don't record the executed instructions, replay the last ones once paused
+void C8_Profiler::fillHistory() {
+    uint64_t current = m_context->cycles;
+    uint64_t start   = (m_head > MAX_OPCODE_HISTORY_COUNT) ? m_head - MAX_OPCODE_HISTORY_COUNT : 0;
+
+    m_history.clear();
+    if (m_keyframes.empty()) return;
+
+    if (!seek(std::max(start, m_keyframes.front().cycle))) return;
+
+    while (m_context->cycles < m_head) {
+        _C8_HistoryEntry entry = { m_context->cycles, m_context->pc, 0 };
+
+        replay(entry.cycle + 1);
+        if (m_context->cycles == entry.cycle) break;
+
+        entry.opcode = m_context->last_opcode;
+        m_history.push_back(entry);
+    }
+
+    seek(current);
+}
+
+void C8_Profiler::updateTimers() {
+    // timers are part of the recorded future while stepping in the past
+    if (rewound() && m_pause) return;
+
+    applyPending();
+    record(_C8_InputEvent::TIMERS, 0);
+}
+
+void C8_Profiler::setKey(int key, bool pressed, uint64_t cycle, uint64_t time) {
+    // keep transitions in order, and a press visible for at least one instruction
+    cycle = std::max(cycle, m_context->cycles);
+    if (!m_pending.empty()) cycle = std::max(cycle, m_pending.back().cycle);
+    if (m_keyCycle[key] != 0) cycle = std::max(cycle, m_keyCycle[key] + 1);
+    m_keyCycle[key] = cycle;
+
+    _C8_PendingKey p = { cycle, key, pressed, time };
+    m_pending.push_back(p);
+
+    // the emulation may already be there, e.g. while paused
+    applyPending();
+}
+
+// FX0A stops the cycle count, a key scheduled ahead of it is applied while the program waits
+void C8_Profiler::applyPending() {
+    while (!m_pending.empty() && (m_pending.front().cycle <= m_context->cycles || m_context->m_on_set_key != NULL)) {
+        const _C8_PendingKey &p = m_pending.front();
+
+        record(p.pressed ? _C8_InputEvent::KEY_DOWN : _C8_InputEvent::KEY_UP, p.key);
+        m_unseen.push_back(p.time);
+        m_pending.pop_front();
+    }
+}
+
+void C8_Profiler::presented(uint64_t time) {
+    for (uint64_t t : m_unseen) {
+        m_latency[m_latencyCount++ % PROFILER_LATENCY_SAMPLES] = (time - t) / 1e6f;
+    }
+    m_unseen.clear();
+}
+
+void C8_Profiler::record(_C8_InputEvent::Type type, int key) {
+    // live input in the past rewrites history
+    if (rewound()) truncate();
+
+    _C8_InputEvent e = { m_context->cycles, type, key };
+    m_events.push_back(e);
+    m_cursor = m_eventBase + m_events.size();
+    apply(e);
+}
+
+void C8_Profiler::apply(const _C8_InputEvent &e) {
+    switch (e.type) {
+        case _C8_InputEvent::KEY_DOWN:  C8_SetKey(m_context, e.key);     break;
+        case _C8_InputEvent::KEY_UP:    C8_UnsetKey(m_context, e.key);   break;
+        case _C8_InputEvent::TIMERS:    C8_UpdateTimers(m_context);      break;
+    }
+}
+
+void C8_Profiler::keyframe() {
+    _C8_Keyframe keyframe;
+
+    keyframe.cycle = m_context->cycles;
+    keyframe.event = m_eventBase + m_events.size();
+    keyframe.state.resize(C8_StateSize(m_context));
+    C8_SaveState(m_context, keyframe.state.data());
+    m_keyframes.push_back(std::move(keyframe));
+
+    // keep the most recent history within budget
+    while (m_keyframes.size() > 1 && memoryUsage() > PROFILER_HISTORY_BUDGET_IN_BYTES) {
+        m_keyframes.pop_front();
+
+        const _C8_Keyframe &oldest = m_keyframes.front();
+        while (m_eventBase < oldest.event) {
+            m_events.pop_front();
+            ++m_eventBase;
+        }
+        while (!m_history.empty() && m_history.front().cycle < oldest.cycle) {
+            m_history.pop_front();
+        }
+    }
+}
+
+size_t C8_Profiler::memoryUsage() const {
+    size_t res = m_events.size() * sizeof(_C8_InputEvent);
+
+    for (const auto &keyframe : m_keyframes) {
+        res += sizeof keyframe + keyframe.state.size();
+    }
+
+    return res;
+}
+
+// Drop everything recorded after the current cycle
+void C8_Profiler::truncate() {
+    m_events.erase(m_events.begin() + (m_cursor - m_eventBase), m_events.end());
+
+    while (!m_keyframes.empty() && m_keyframes.back().cycle > m_context->cycles) {
+        m_keyframes.pop_back();
+    }
+    while (!m_history.empty() && m_history.back().cycle >= m_context->cycles) {
+        m_history.pop_back();
+    }
+
+    // key cycles refer to the dropped future
+    std::fill(m_keyCycle, m_keyCycle + 16, 0);
+    m_head = m_context->cycles;
+}
+
+/* Time travel */
+
+void C8_Profiler::restore(const _C8_Keyframe &keyframe) {
+    C8_LoadState(m_context, keyframe.state.data());
+    m_cursor = keyframe.event;
+}
+
+// Re-execute up to `cycle`, applying recorded inputs as they come due
+void C8_Profiler::replay(uint64_t cycle) {
+    C8_Beeper *beeper = m_context->beeper;
+
+    m_context->beeper = nullptr;     // don't beep again
+
+    for (;;) {
+        uint64_t before = m_context->cycles;
+
+        // a keyframe may be taken while FX0A waits, before the inputs of the same cycle
+        while (m_cursor < m_eventBase + m_events.size() && m_events[m_cursor - m_eventBase].cycle <= before) {
+            apply(m_events[m_cursor - m_eventBase]);
+            ++m_cursor;
+        }
+
+        if (before >= cycle || C8_Tick(m_context) < 0 || m_context->cycles == before) break;
+    }
+
+    m_context->beeper = beeper;
+}
+
+bool C8_Profiler::seek(uint64_t cycle) {
+    if (m_keyframes.empty() || cycle < m_keyframes.front().cycle || cycle > m_head) {
+        return false;
+    }
+
+    // closest keyframe at or before the target
+    auto keyframe = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), cycle,
+        [](uint64_t c, const _C8_Keyframe &k) { return c < k.cycle; }) - 1;
+
+    // replaying from the current state is cheaper when going forward past the keyframe
+    if (cycle < m_context->cycles || m_context->cycles < keyframe->cycle) {
+        restore(*keyframe);
+    }
+
+    replay(cycle);
+
+    // the frontend plays the pattern it was last handed
+    if (m_context->beeper != NULL && m_context->beeper->pattern != NULL) {
+        m_context->beeper->pattern(m_context->beeper->user_data, m_context->audio_pattern, m_context->pitch);
+    }
+
+    return m_context->cycles == cycle;
+}
+
+bool C8_Profiler::stepBack() {
+    if (m_context->cycles == 0) return false;
+
+    return seek(m_context->cycles - 1);
+}
+
+bool C8_Profiler::reverseContinue() {
+    uint64_t current = m_context->cycles;
+
+    if (m_keyframes.empty() || m_context->debugger == NULL || current <= m_keyframes.front().cycle) {
+        return false;
+    }
+
+    // scan segments between keyframes from the most recent one, keeping the last hit of each
+    size_t i = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), current - 1,
+        [](uint64_t c, const _C8_Keyframe &k) { return c < k.cycle; }) - m_keyframes.begin();
+
+    while (i-- > 0) {
+        uint64_t end = (i + 1 < m_keyframes.size()) ? std::min(current, m_keyframes[i + 1].cycle) : current;
+        uint64_t hit = 0;
+        bool     found = false;
+
+        restore(m_keyframes[i]);
+
+        while (m_context->cycles < end) {
+            uint64_t before = m_context->cycles;
+            unsigned hits   = m_context->debugger->hits;
+
+            if (C8_AtBreakpoint(m_context) >= 0) {
+                hit   = before;
+                found = true;
+            }
+
+            replay(before + 1);
+            if (m_context->cycles == before) break;
+
+            // watchpoints stop after the accessing instruction
+            if (m_context->debugger->hits != hits && m_context->cycles < current) {
+                hit   = m_context->cycles;
+                found = true;
+            }
+        }
+
+        if (found) {
+            return seek(hit);
+        }
+    }
+
+    seek(m_keyframes.front().cycle);
+    return false;
+}
+
+void C8_Profiler::render() {
     ImVec2 dummy(0, 10);
     ImGui::SetNextWindowPos(ImVec2(0, VIEWPORT_HEIGHT));
     ImGui::SetNextWindowSize(ImVec2(WINDOW_WIDTH, PROFILER_WINDOW_HEIGHT_EXTENT));
     ImGui::SetNextWindowCollapsed(false);
     ImGui::Begin("Profiler");
 
+    if (m_pause && m_batched) {
+        fillHistory();
+        m_batched = false;
+    }
+
+    // debugger
+    if (ImGui::Button(m_pause ? "Continue" : "Pause")) {
+        m_pause  = !m_pause;
+        m_resume = !m_pause;
+    }
 
-    if (!m_pause) {
-        if (m_opSnapshots.size() > MAX_OPCODE_SNAPSHOTS_COUNT){
-            m_opHistory.pop_front();
-            m_opSnapshots.pop_front();
+    if (m_pause) {
+        ImGui::SameLine();
+        if (ImGui::Button("Step")) {
+            m_step = true;
         }
 
-        if (opcode != nullptr) {
-            m_opHistory.push_back(*opcode);
-            m_opSnapshots.push_back(_C8_OpcodeSnapshot(m_context));
+        ImGui::SameLine();
+        if (ImGui::Button("Step back")) {
+            stepBack();
         }
-    }
 
-    // debugger
-    if (ImGui::Button(m_pause ? "Continue" : "Pause")) {
-        m_pause = !m_pause;
+        ImGui::SameLine();
+        if (ImGui::Button("Reverse continue")) {
+            reverseContinue();
+        }
     }
 
     ImGui::SameLine();
+    ImGui::Text("Cycle %" PRIu64 " / %" PRIu64, m_context->cycles, m_head);
 
-    if (m_pause && ImGui::Button("Step")) {
-        m_step = true;
-    }
+    ImGui::SameLine();
+    renderLatency();
+
+    renderBreakpoints();
+    renderFrameTiming();
+    renderMemory();
 
     ImGui::Dummy(dummy);
 
@@ -59,15 +447,15 @@ void C8_Profiler::render(const int *opcode) {
     for(int i = 0; i < REGISTER_COUNT; ++i) {
         ImGui::Text("V%X", i);
         ImGui::SameLine();
-        ImGui::Text("%04X", context.registers[i]);
+        ImGui::Text("%04X", m_context->registers[i]);
     }
 
-    ImGui::Text("Delay timer %04X", context.dt);
-    ImGui::Text("Sound timer %04X", context.st);
+    ImGui::Text("Delay timer %04X", m_context->delay_timer);
+    ImGui::Text("Sound timer %04X", m_context->sound_timer);
 
     ImGui::Unindent(16.f);
     ImGui::EndGroup();
-    
+
     ImGui::SameLine();
 
     // pointers
@@ -75,9 +463,9 @@ void C8_Profiler::render(const int *opcode) {
     ImGui::Text("Pointers");
 
     ImGui::Indent(16.f);
-    ImGui::Text("PC %04X", context.pc);
-    ImGui::Text("SP %04X", context.sp);
-    ImGui::Text("I  %04X", context.addressI);
+    ImGui::Text("PC %04X", m_context->pc);
+    ImGui::Text("SP %04X", m_context->sp);
+    ImGui::Text("I  %04X", m_context->addressI);
 
     ImGui::Unindent(16.f);
     ImGui::EndGroup();
@@ -88,24 +476,50 @@ void C8_Profiler::render(const int *opcode) {
     ImGui::Text("Execution");
     ImGui::Indent(16.f);
 
+    // selecting an instruction travels to the cycle right after it
+    uint64_t target = UINT64_MAX;
     size_t i = 0;
-    for(const auto e : m_opHistory) {
-        char text[64];
+    for(const auto &e : m_history) {
+        char text[160];
         char s[255];
-        
-        int rv = c8_disassemble(e, s);
+        char where[48] = "";
+        char target_name[48] = "";
+
+        int rv = c8_disassemble(e.opcode, s);
 
         if (rv == 0) {
-            snprintf(text, sizeof text / sizeof text[0], "$%04X %04X\t%s##%zu", m_opSnapshots.at(i).pc, e, s, i);
+            // labels of an assembled source, for the instruction and the address it names
+            const _C8_Label *at = label(e.pc);
+            if (at != NULL) {
+                if (at->address == e.pc) snprintf(where, sizeof where, "%s ", at->name.c_str());
+                else                     snprintf(where, sizeof where, "%s+%d ", at->name.c_str(), e.pc - at->address);
+            }
+
+            switch (e.opcode & 0xF000) {
+                case 0x1000: case 0x2000: case 0xA000: case 0xB000: {
+                    const _C8_Label *to = label(e.opcode & 0x0FFF);
+                    if (to != NULL && to->address == (e.opcode & 0x0FFF)) {
+                        snprintf(target_name, sizeof target_name, "\t; %s", to->name.c_str());
+                    }
+                    break;
+                }
+            }
+
+            snprintf(text, sizeof text / sizeof text[0], "$%04X %04X\t%s%s%s##%zu", e.pc, e.opcode, where, s, target_name, i);
 
-            if (ImGui::Selectable(text, selected_index == i)) {
-                selected_index = i;
+            if (ImGui::Selectable(text, e.cycle + 1 == m_context->cycles)) {
+                target = e.cycle + 1;
             }
         }
 
         ++i;
     }
 
+    if (target != UINT64_MAX) {
+        m_pause = true;
+        seek(target);
+    }
+
     if (!m_pause)
         ImGui::SetScrollY(ImGui::GetScrollMaxY());
 
@@ -115,6 +529,224 @@ void C8_Profiler::render(const int *opcode) {
     ImGui::End();
 }
 
+// Parse "V3==05", "I>0300", ... into a condition, an empty string always holds
+static bool parse_condition(const char *text, C8_Condition &condition) {
+    static const struct { const char *text; C8_ConditionOp op; } ops[] = {
+        { "==", C8_COND_EQ }, { "!=", C8_COND_NE }, { "<", C8_COND_LT }, { ">", C8_COND_GT }
+    };
+    const char *p = text;
+
+    condition.op = C8_COND_ALWAYS;
+    if (*p == '\0') return true;
+
+    if (*p == 'V' || *p == 'v') {
+        char *end;
+        condition.reg = (int)strtol(p + 1, &end, 16);
+        if (end != p + 2) return false;
+        p = end;
+    } else if (*p == 'I' || *p == 'i') {
+        condition.reg = C8_COND_REG_I;
+        ++p;
+    } else {
+        return false;
+    }
+
+    for (const auto &op : ops) {
+        size_t length = strlen(op.text);
+
+        if (strncmp(p, op.text, length) == 0) {
+            condition.op    = op.op;
+            condition.value = (WORD)strtol(p + length, NULL, 16);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void C8_Profiler::renderLatency() {
+    size_t count = std::min(m_latencyCount, (size_t)PROFILER_LATENCY_SAMPLES);
+    float  sum   = 0;
+    float  worst = 0;
+
+    if (count == 0) {
+        ImGui::Text("Input latency -");
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        sum  += m_latency[i];
+        worst = std::max(worst, m_latency[i]);
+    }
+
+    ImGui::Text("Input latency %.0f ms (avg %.1f, max %.0f)",
+                m_latency[(m_latencyCount - 1) % PROFILER_LATENCY_SAMPLES], sum / count, worst);
+}
+
+// Value below which a fraction p of the samples fall
+static float percentile(std::vector<float> &samples, double p) {
+    size_t n = (size_t)(p * (samples.size() - 1));
+
+    std::nth_element(samples.begin(), samples.begin() + n, samples.end());
+    return samples[n];
+}
+
+void C8_Profiler::renderFrameTiming() {
+    const C8_FrameStats &stats = C8_TraceStats();
+    size_t count  = std::min(stats.count, (size_t)TRACE_FRAME_HISTORY);
+    int    offset = (stats.count > TRACE_FRAME_HISTORY) ? (int)(stats.count % TRACE_FRAME_HISTORY) : 0;
+    float  buckets[TRACE_HISTOGRAM_BUCKETS] = {};
+    char   overlay[64];
+
+    if (!ImGui::CollapsingHeader("Frame timing") || count == 0) return;
+
+    std::vector<float> samples(stats.frame_ms, stats.frame_ms + count);
+    float worst = *std::max_element(samples.begin(), samples.end());
+
+    for (float ms : samples) {
+        buckets[std::min((int)ms, TRACE_HISTOGRAM_BUCKETS - 1)] += 1;
+    }
+
+    snprintf(overlay, sizeof overlay, "frame time, max %.1f ms", worst);
+    ImGui::PlotLines("##frames", stats.frame_ms, (int)count, offset, overlay, 0, std::max(worst, 1000.f / DEFAULT_FPS * 2), ImVec2(WINDOW_WIDTH - 40, 50));
+    ImGui::PlotHistogram("##distribution", buckets, TRACE_HISTOGRAM_BUCKETS, 0, "distribution, 1 ms buckets", 0, FLT_MAX, ImVec2(WINDOW_WIDTH - 40, 50));
+
+    ImGui::Text("%-14s p50 %6.2f  p90 %6.2f  p99 %6.2f  max %6.2f ms", "frame",
+                percentile(samples, 0.5), percentile(samples, 0.9), percentile(samples, 0.99), worst);
+
+    // where the frames go
+    for (size_t z = 0; z < stats.zone_count; ++z) {
+        samples.assign(stats.zones[z].ms, stats.zones[z].ms + count);
+
+        ImGui::Text("%-14s p50 %6.2f  p90 %6.2f  p99 %6.2f  max %6.2f ms", stats.zones[z].name,
+                    percentile(samples, 0.5), percentile(samples, 0.9), percentile(samples, 0.99),
+                    *std::max_element(samples.begin(), samples.end()));
+    }
+}
+
+// Written bytes get the full heat, the others cool down. Compared 16 bytes at a time
+// without branches, most blocks are unchanged from one frame to the next.
+static void scan_writes(const BYTE *memory, BYTE *previous, BYTE *heat, size_t size) {
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i decay = _mm_set1_epi8(PROFILER_HEAT_DECAY);
+
+    for (; i + 16 <= size; i += 16) {
+        __m128i now     = _mm_loadu_si128((const __m128i*)(memory + i));
+        __m128i before  = _mm_loadu_si128((const __m128i*)(previous + i));
+        __m128i hot     = _mm_loadu_si128((const __m128i*)(heat + i));
+        __m128i written = _mm_xor_si128(_mm_cmpeq_epi8(now, before), _mm_set1_epi8(-1));
+
+        _mm_storeu_si128((__m128i*)(heat + i), _mm_or_si128(_mm_subs_epu8(hot, decay), written));
+        _mm_storeu_si128((__m128i*)(previous + i), now);
+    }
+#endif
+
+    for (; i < size; ++i) {
+        heat[i]     = (memory[i] != previous[i]) ? 255 : (heat[i] > PROFILER_HEAT_DECAY ? heat[i] - PROFILER_HEAT_DECAY : 0);
+        previous[i] = memory[i];
+    }
+}
+
+// Address space up to the stack, 16 bytes per row. Hot bytes turn red, PC is blue.
+void C8_Profiler::renderMemory() {
+    size_t size = C8_STACK_END(m_context) + 1;
+
+    if (!ImGui::CollapsingHeader("Memory")) {
+        m_previous.clear();
+        return;
+    }
+
+    // the first frame has nothing to compare with
+    if (m_previous.size() != size) {
+        m_previous.assign(m_context->memory, m_context->memory + size);
+        m_heat.assign(size, 0);
+    }
+
+    {
+        C8_TRACE_SCOPE("memory_scan");
+        scan_writes(m_context->memory, m_previous.data(), m_heat.data(), size);
+    }
+
+    ImGui::BeginChild("Memory", ImVec2(0, PROFILER_MEMORY_HEIGHT));
+
+    ImGuiListClipper clipper;
+    clipper.Begin((int)(size / 16));
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            ImGui::Text("%04X", row * 16);
+
+            for (int column = 0; column < 16; ++column) {
+                size_t address = row * 16 + column;
+                float  heat    = m_heat[address] / 255.f;
+                bool   pc      = address == m_context->pc || address == m_context->pc + 1u;
+                ImVec4 color   = (pc && heat == 0) ? ImVec4(0.4f, 0.8f, 1.f, 1.f)
+                                                   : ImVec4(0.7f + 0.3f * heat, 0.7f - 0.5f * heat, 0.7f - 0.6f * heat, 1.f);
+
+                ImGui::SameLine();
+                ImGui::TextColored(color, "%02X", m_context->memory[address]);
+            }
+        }
+    }
+    clipper.End();
+
+    ImGui::EndChild();
+}
+
+void C8_Profiler::renderBreakpoints() {
+    static char address[5]    = "";
+    static char size[5]       = "1";
+    static char condition[16] = "";
+    static bool exec = true, read = false, write = false;
+
+    ImGui::InputText("Address##bp", address, sizeof address);
+    ImGui::SameLine();
+    ImGui::InputText("Size##bp", size, sizeof size);
+    ImGui::SameLine();
+    ImGui::InputText("Condition##bp", condition, sizeof condition);
+    ImGui::SameLine();
+    ImGui::Checkbox("X", &exec);
+    ImGui::SameLine();
+    ImGui::Checkbox("R", &read);
+    ImGui::SameLine();
+    ImGui::Checkbox("W", &write);
+    ImGui::SameLine();
+
+    if (ImGui::Button("Add") && address[0] != '\0') {
+        C8_Breakpoint bp = {};
+
+        bp.access  = (exec ? C8_BREAK_EXEC : 0) | (read ? C8_BREAK_READ : 0) | (write ? C8_BREAK_WRITE : 0);
+        bp.address = (WORD)strtol(address, NULL, 16);
+        bp.size    = (bp.access == C8_BREAK_EXEC) ? 1 : (WORD)strtol(size, NULL, 16);
+
+        if (parse_condition(condition, bp.condition) && C8_AddBreakpoint(m_context, &bp) >= 0) {
+            address[0]   = '\0';
+            condition[0] = '\0';
+        }
+    }
+
+    if (m_context->debugger == NULL) return;
+
+    // click to remove
+    for (int id = 0; id < MAX_BREAKPOINTS; ++id) {
+        const C8_Breakpoint &bp = m_context->debugger->breakpoints[id];
+        char text[64];
+
+        if (bp.access == 0) continue;
+
+        snprintf(text, sizeof text / sizeof text[0], "%s%s%s $%04X+%X##bp%d",
+                 (bp.access & C8_BREAK_EXEC) ? "X" : "", (bp.access & C8_BREAK_READ) ? "R" : "",
+                 (bp.access & C8_BREAK_WRITE) ? "W" : "", bp.address, bp.size, id);
+
+        ImGui::SameLine();
+        if (ImGui::Selectable(text)) {
+            C8_RemoveBreakpoint(m_context, id);
+            if (m_context->debugger == NULL) return;
+        }
+    }
+}
+
 bool C8_Profiler::shouldStep() {
     bool tmp = m_step;
     m_step = false;
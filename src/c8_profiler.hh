@@ -3,32 +3,119 @@
 
 #include "c8_helper.h"
 #include "chip8.h"
+#include "c8_def.h"
+#include <cstdint>
+#include <string>
 #include <vector>
 #include <deque>
 
-struct _C8_OpcodeSnapshot {
-    _C8_OpcodeSnapshot(const C8_Context &context);
+// Inputs are stamped with the cycle count they were applied at, i.e. after `cycle` instructions
+struct _C8_InputEvent {
+    enum Type { KEY_DOWN, KEY_UP, TIMERS };
 
-    std::vector<BYTE>       registers;
+    uint64_t                cycle;
+    Type                    type;
+    int                     key;
+};
+
+// Live key transition waiting for the emulation to reach its cycle
+struct _C8_PendingKey {
+    uint64_t                cycle;
+    int                     key;
+    bool                    pressed;
+    uint64_t                time;                   // host nanoseconds the key changed at
+};
+
+// Full machine state, taken before the instruction at `cycle` and after its inputs
+struct _C8_Keyframe {
+    uint64_t                cycle;
+    size_t                  event;                  // absolute index of the first event not yet applied
+    std::vector<BYTE>       state;
+};
+
+struct _C8_HistoryEntry {
+    uint64_t                cycle;                  // before execution
     WORD                    pc;
-    WORD                    sp;
-    WORD                    addressI;
-    BYTE                    dt;
-    BYTE                    st;
+    WORD                    opcode;
+};
+
+// Name shown for an address in the disassembly, e.g. a label of the assembled source
+struct _C8_Label {
+    WORD                    address;
+    std::string             name;
 };
 
+/**
+ * @brief Debugger with time travel
+ *
+ * Every input reaching the context goes through the profiler and is logged. Going back
+ * restores the closest keyframe and re-executes up to the requested cycle, which is
+ * deterministic as CXNN draws from the context PRNG.
+ */
 class C8_Profiler {
 public:
-    C8_Profiler(const C8_Context &context) : m_context(context), m_pause(false), m_step(false) {}
+    C8_Profiler(C8_Context &context);
+
+    void attach(C8_Context &context);               // follow another context, its history starts now
+    void forget();                                  // the history starts now, e.g. after the code was patched
+    void setLabels(const std::vector<_C8_Label> &labels);    // in address order, empty to show addresses only
+    C8_Context &context() const { return *m_context; }
+
+    // Live execution. tick returns 1 while running, 0 on exit, -1 on error
+    int  tick();
+    int  run(uint64_t cycles);                      // up to cycles instructions, stops early when paused
+    void updateTimers();
+    void setKey(int key, bool pressed, uint64_t cycle, uint64_t time);    // applied once cycle instructions have run
+    void presented(uint64_t time);                  // a frame reached the screen, closes input latency samples
+
+    // Time travel
+    bool seek(uint64_t cycle);                      // false if cycle is out of the recorded history
+    bool stepBack();
+    bool reverseContinue();                         // run backwards to the previous breakpoint or watchpoint
+    bool rewound() const { return m_context->cycles < m_head; }
 
-    void render(const int *opcode);
+    void render();
     bool shouldStep();
+    bool paused() const { return m_pause; }
 private:
-    const C8_Context &m_context;
+    void renderBreakpoints();
+    void renderLatency();
+    void renderFrameTiming();
+    void renderMemory();
+    void applyPending();
+    void record(_C8_InputEvent::Type type, int key);
+    void apply(const _C8_InputEvent &e);
+    void keyframe();
+    void truncate();
+    void replay(uint64_t cycle);
+    void fillHistory();
+    void restore(const _C8_Keyframe &keyframe);
+    size_t memoryUsage() const;
+    const _C8_Label *label(WORD address) const;     // closest at or before address, NULL if none
+
+    C8_Context *m_context;
     bool m_pause;
     bool m_step;
-    std::deque<WORD> m_opHistory;
-    std::deque<_C8_OpcodeSnapshot> m_opSnapshots;
+    bool m_resume;                                  // execute the instruction at a breakpoint just stopped at
+    bool m_batched;                                 // ran without recording the history since the last pause
+    uint64_t m_head;                                // cycle count at the live edge
+    size_t m_cursor;                                // absolute index of the next event to replay
+    size_t m_eventBase;                             // absolute index of m_events.front()
+    std::deque<_C8_InputEvent> m_events;
+    std::deque<_C8_Keyframe> m_keyframes;
+    std::deque<_C8_HistoryEntry> m_history;
+    std::vector<_C8_Label> m_labels;
+
+    // memory view, written bytes are found by comparing frames
+    std::vector<BYTE> m_previous;                   // memory at the last frame shown, empty until the view opens
+    std::vector<BYTE> m_heat;                       // 255 when written in the last frame, cools down by PROFILER_HEAT_DECAY
+
+    // input path
+    std::deque<_C8_PendingKey> m_pending;
+    uint64_t m_keyCycle[16];                        // last cycle each key changed at
+    std::vector<uint64_t> m_unseen;                 // times of the inputs applied since the last frame
+    float m_latency[PROFILER_LATENCY_SAMPLES];      // input to present, in milliseconds
+    size_t m_latencyCount;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,440 @@
+/**
+ * Ahead-of-time translation of a ROM into a C translation unit.
+ *
+ * Code reachable from USER_MEMORY_START is split in basic blocks, each one compiled
+ * into a function calling the core instruction handlers without fetch or decode.
+ * Blocks return their static successor, the generated driver only switches on PC
+ * after indirect jumps (BNNN), returns (00EE) or when a batch starts.
+ *
+ * The generated <name>_run(context, cycles) has the same contract as C8_Run and must be
+ * linked against chip8_core. When the ROM writes into its own code, or when the loaded
+ * program isn't the compiled one, it falls back to the interpreter.
+*/
+
+#include "chip8.h"
+#include "c8_decode.h"
+#include "c8_disassembler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+static const char *help_msg = "Usage: %s <ROM_PATH> <OUTPUT_C> [--xochip] [--name NAME]\n";
+
+// Core handler suffix of each opcode, e.g. "DXYN" for C8_OpcodeDXYN, XO-CHIP ones only with --xochip
+struct HandlerName {
+    const char *name;
+    bool        xochip;
+};
+
+#define HANDLER_NAME(id) inline void c8_handler##id(HandlerName *handler, WORD) { handler->name = #id; }
+
+HANDLER_NAME(00CN) HANDLER_NAME(00DN) HANDLER_NAME(00E0) HANDLER_NAME(00EE) HANDLER_NAME(00FB)
+HANDLER_NAME(00FC) HANDLER_NAME(00FD) HANDLER_NAME(00FE) HANDLER_NAME(00FF) HANDLER_NAME(1NNN)
+HANDLER_NAME(2NNN) HANDLER_NAME(3XNN) HANDLER_NAME(4XNN) HANDLER_NAME(5XY0) HANDLER_NAME(5XY2)
+HANDLER_NAME(5XY3) HANDLER_NAME(6XNN) HANDLER_NAME(7XNN) HANDLER_NAME(8XY0) HANDLER_NAME(8XY1)
+HANDLER_NAME(8XY2) HANDLER_NAME(8XY3) HANDLER_NAME(8XY4) HANDLER_NAME(8XY5) HANDLER_NAME(8XY6)
+HANDLER_NAME(8XY7) HANDLER_NAME(8XYE) HANDLER_NAME(9XY0) HANDLER_NAME(ANNN) HANDLER_NAME(BNNN)
+HANDLER_NAME(CXNN) HANDLER_NAME(DXYN) HANDLER_NAME(DXY0) HANDLER_NAME(EX9E) HANDLER_NAME(EXA1)
+HANDLER_NAME(F000) HANDLER_NAME(FN01) HANDLER_NAME(F002) HANDLER_NAME(FX07) HANDLER_NAME(FX0A)
+HANDLER_NAME(FX15) HANDLER_NAME(FX18) HANDLER_NAME(FX1E) HANDLER_NAME(FX29) HANDLER_NAME(FX30)
+HANDLER_NAME(FX33) HANDLER_NAME(FX3A) HANDLER_NAME(FX55) HANDLER_NAME(FX65) HANDLER_NAME(FX75)
+HANDLER_NAME(FX85)
+
+inline C8_DECODE_FUNC_GEN(c8_handler_dec, HandlerName *, c8_handler, context->xochip)
+
+enum Flow {
+    FLOW_NEXT,          // continue with the next instruction
+    FLOW_JUMP,          // 1NNN
+    FLOW_CALL,          // 2NNN
+    FLOW_SKIP,          // conditional skip of the next instruction
+    FLOW_DYNAMIC,       // 00EE, BNNN: target only known at runtime
+    FLOW_STOP           // 00FD, FX0A: leave the block and let the driver check is_running
+};
+
+struct Instruction {
+    WORD        address;
+    WORD        opcode;
+    int         size;
+    const char *handler;
+    Flow        flow;
+};
+
+class C8Recompiler {
+public:
+    C8Recompiler(bool xochip) : m_xochip(xochip), m_memory(MEMORY_SIZE_IN_BYTES + sizeof(WORD), 0), m_size(0) {}
+
+    int  load(const char *path);
+    void analyze();
+    int  emit(const char *path, const std::string &name, const char *rom_path);
+
+private:
+    bool m_decode(int address, Instruction &ins) const;
+    int  m_size_at(int address) const;
+    void m_emit_block(FILE *out, WORD leader) const;
+    bool m_writes_memory(const Instruction &ins) const;
+    bool m_is_macro(const Instruction &ins) const;
+
+    std::string m_successor(int address) const;
+
+    bool                          m_xochip;
+    std::vector<BYTE>             m_memory;
+    size_t                        m_size;
+    std::map<WORD, Instruction>   m_code;
+    std::set<WORD>                m_leaders;
+    std::map<WORD, int>           m_lengths;        // instructions count of each block
+};
+
+int C8Recompiler::load(const char *path) {
+    FILE   *fp = fopen(path, "rb");
+    size_t  max_size = (m_xochip ? XO_USER_MEMORY_END : USER_MEMORY_END) - USER_MEMORY_START;
+
+    if (fp == NULL) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return -1;
+    }
+
+    m_size = fread(&m_memory[USER_MEMORY_START], 1, max_size + 1, fp);
+    fclose(fp);
+
+    if (m_size > max_size) {
+        fprintf(stderr, "%s is too large\n", path);
+        return -1;
+    }
+
+    return 0;
+}
+
+int C8Recompiler::m_size_at(int address) const {
+    return (m_xochip && m_memory[address] == 0xF0 && m_memory[address + 1] == 0x00) ? 4 : 2;
+}
+
+bool C8Recompiler::m_decode(int address, Instruction &ins) const {
+    HandlerName handler = { NULL, m_xochip };
+
+    if (address < USER_MEMORY_START || address + 1 >= USER_MEMORY_START + (int)m_size) {
+        return false;
+    }
+
+    ins.address = address;
+    ins.opcode  = (m_memory[address] << 8) | m_memory[address + 1];
+    ins.size    = m_size_at(address);
+
+    if (c8_handler_dec(&handler, ins.opcode) != 0) {
+        return false;
+    }
+    ins.handler = handler.name;
+
+    switch (C8_OPCODE_SELECT_OP(ins.opcode)) {
+        case 0x1: ins.flow = FLOW_JUMP;    break;
+        case 0x2: ins.flow = FLOW_CALL;    break;
+        case 0xB: ins.flow = FLOW_DYNAMIC; break;
+        case 0x3: case 0x4: case 0x9: case 0xE:
+            ins.flow = FLOW_SKIP;
+            break;
+        case 0x5:
+            ins.flow = C8_OPCODE_SELECT_N(ins.opcode) == 0 ? FLOW_SKIP : FLOW_NEXT;
+            break;
+        default:
+            if      (ins.opcode == 0x00EE)                    ins.flow = FLOW_DYNAMIC;
+            else if (ins.opcode == 0x00FD)                    ins.flow = FLOW_STOP;
+            else if ((ins.opcode & 0xF0FF) == 0xF00A)         ins.flow = FLOW_STOP;
+            else                                              ins.flow = FLOW_NEXT;
+            break;
+    }
+
+    return true;
+}
+
+bool C8Recompiler::m_writes_memory(const Instruction &ins) const {
+    return !strcmp(ins.handler, "FX33") || !strcmp(ins.handler, "FX55") || !strcmp(ins.handler, "5XY2");
+}
+
+// Handlers implemented as macros never fail
+bool C8Recompiler::m_is_macro(const Instruction &ins) const {
+    static const char *macros[] = {
+        "3XNN", "4XNN", "5XY0", "6XNN", "7XNN", "8XY0", "8XY1", "8XY2", "8XY3", "8XY5", "8XY7",
+        "9XY0", "EX9E", "EXA1", "FX15", "FX1E", "FX29", "FX30"
+    };
+
+    for (const char *macro : macros) {
+        if (!strcmp(ins.handler, macro)) return true;
+    }
+
+    return false;
+}
+
+// Recursive traversal from the entry point. Data is never reached, computed jumps are left to the interpreter.
+void C8Recompiler::analyze() {
+    std::vector<int> worklist(1, USER_MEMORY_START);
+
+    m_leaders.insert(USER_MEMORY_START);
+
+    while (!worklist.empty()) {
+        int         address = worklist.back();
+        Instruction ins;
+
+        worklist.pop_back();
+
+        if (m_code.count(address) || !m_decode(address, ins)) continue;
+
+        m_code[address] = ins;
+
+        int next = address + ins.size;
+        int nnn  = C8_OPCODE_SELECT_NNN(ins.opcode);
+
+        switch (ins.flow) {
+            case FLOW_NEXT:
+                worklist.push_back(next);
+                break;
+            case FLOW_JUMP:
+                m_leaders.insert(nnn);
+                worklist.push_back(nnn);
+                break;
+            case FLOW_CALL:
+                m_leaders.insert(nnn);
+                m_leaders.insert(next);
+                worklist.push_back(nnn);
+                worklist.push_back(next);
+                break;
+            case FLOW_SKIP:
+                m_leaders.insert(next);
+                m_leaders.insert(next + m_size_at(next));
+                worklist.push_back(next);
+                worklist.push_back(next + m_size_at(next));
+                break;
+            case FLOW_STOP:
+                m_leaders.insert(next);
+                worklist.push_back(next);
+                break;
+            case FLOW_DYNAMIC:
+                break;
+        }
+    }
+
+    // only keep leaders of decoded code
+    for (auto it = m_leaders.begin(); it != m_leaders.end();) {
+        it = m_code.count(*it) ? std::next(it) : m_leaders.erase(it);
+    }
+
+    // the driver uses block lengths to never overrun a batch
+    for (WORD leader : m_leaders) {
+        int address = leader, length = 0;
+
+        while (true) {
+            const Instruction &ins = m_code.at(address);
+            ++length;
+            address += ins.size;
+            if (ins.flow != FLOW_NEXT || m_leaders.count(address) || !m_code.count(address)) break;
+        }
+
+        m_lengths[leader] = length;
+    }
+}
+
+std::string C8Recompiler::m_successor(int address) const {
+    char s[64];
+
+    if (m_code.count(address)) snprintf(s, sizeof s, "NEXT(b_%04X, %d)", address, m_lengths.at(address));
+    else                       snprintf(s, sizeof s, "DISPATCH");
+
+    return s;
+}
+
+void C8Recompiler::m_emit_block(FILE *out, WORD leader) const {
+    int count = 0;
+    int address = leader;
+
+    fprintf(out, "static C8_AotBlock b_%04X(C8_Context *context, int *executed) {\n", leader);
+    fprintf(out, "    WORD opcode;\n\n");
+
+    while (true) {
+        const Instruction &ins = m_code.at(address);
+        char               s[255] = "";
+        int                next = address + ins.size;
+
+        c8_disassemble(ins.opcode, s);
+        ++count;
+
+        fprintf(out, "    /* %04X: %s */\n", address, s);
+        fprintf(out, "    context->pc = 0x%04X; opcode = 0x%04X; C8_Opcode%s(context, opcode);\n",
+                address + 2, ins.opcode, ins.handler);
+
+        if (!m_is_macro(ins)) {
+            fprintf(out, "    if (!context->is_running) { LEAVE(%d); DISPATCH; }\n", count);
+        }
+
+        if (m_writes_memory(ins)) {
+            // the write may have hit compiled code: let the driver verify it
+            fprintf(out, "    if (context->code_state != C8_CODE_VERIFIED) { LEAVE(%d); DISPATCH; }\n", count);
+        }
+
+        fprintf(out, "\n");
+
+        switch (ins.flow) {
+            case FLOW_JUMP:
+            case FLOW_CALL: {
+                int nnn = C8_OPCODE_SELECT_NNN(ins.opcode);
+                fprintf(out, "    LEAVE(%d);\n", count);
+                fprintf(out, "    %s;\n}\n\n", m_successor(nnn).c_str());
+                return;
+            }
+            case FLOW_SKIP: {
+                int taken = next + m_size_at(next);
+                fprintf(out, "    LEAVE(%d);\n", count);
+                fprintf(out, "    if (context->pc == 0x%04X) %s;\n", taken, m_successor(taken).c_str());
+                fprintf(out, "    %s;\n}\n\n", m_successor(next).c_str());
+                return;
+            }
+            case FLOW_DYNAMIC:
+            case FLOW_STOP:
+                fprintf(out, "    LEAVE(%d);\n", count);
+                fprintf(out, "    DISPATCH;\n}\n\n");
+                return;
+            case FLOW_NEXT:
+                break;
+        }
+
+        if (m_leaders.count(next) || !m_code.count(next)) {
+            fprintf(out, "    LEAVE(%d);\n", count);
+            fprintf(out, "    %s;\n}\n\n", m_successor(next).c_str());
+            return;
+        }
+
+        address = next;
+    }
+}
+
+int C8Recompiler::emit(const char *path, const std::string &name, const char *rom_path) {
+    FILE *out = fopen(path, "w");
+
+    if (out == NULL) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return -1;
+    }
+
+    fprintf(out, "/* Generated by c8recompile from %s, do not edit.\n", rom_path);
+    fprintf(out, " * int %s_run(C8_Context *context, int cycles); has the same contract as C8_Run. */\n\n", name.c_str());
+    fprintf(out, "#include \"chip8.h\"\n\n#include <string.h>\n\n");
+    fprintf(out, "typedef struct C8_AotBlock {\n");
+    fprintf(out, "    struct C8_AotBlock (*fn)(C8_Context *context, int *executed);\n");
+    fprintf(out, "    int length;\n");
+    fprintf(out, "} C8_AotBlock;\n\n");
+    fprintf(out, "#define NEXT(block, len) do { C8_AotBlock next = { block, len }; return next; } while (0)\n");
+    fprintf(out, "#define DISPATCH NEXT(NULL, 0)\n");
+    fprintf(out, "// FX0A key wait reads X back from last_opcode\n");
+    fprintf(out, "#define LEAVE(count) (*executed += (count), context->cycles += (count), context->last_opcode = opcode)\n\n");
+
+    for (WORD leader : m_leaders) {
+        fprintf(out, "static C8_AotBlock b_%04X(C8_Context *context, int *executed);\n", leader);
+    }
+    fprintf(out, "\n");
+
+    for (WORD leader : m_leaders) {
+        m_emit_block(out, leader);
+    }
+
+    fprintf(out, "static C8_AotBlock lookup(WORD pc) {\n    switch (pc) {\n");
+    for (WORD leader : m_leaders) {
+        fprintf(out, "        case 0x%04X: %s;\n", leader, m_successor(leader).c_str());
+    }
+    fprintf(out, "    }\n\n    DISPATCH;\n}\n\n");
+
+    // contiguous ranges of compiled code and the image they were compiled from
+    fprintf(out, "static const WORD code_ranges[][2] = {\n");
+    for (auto it = m_code.begin(); it != m_code.end();) {
+        int start = it->first, end = it->first + it->second.size;
+
+        for (++it; it != m_code.end() && it->first <= end; ++it) {
+            end = std::max(end, it->first + it->second.size);
+        }
+
+        fprintf(out, "    { 0x%04X, 0x%04X },\n", start, end - start);
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "static const BYTE image[] = {");
+    for (size_t i = 0; i < m_size; ++i) {
+        fprintf(out, "%s0x%02X,", (i % 16 == 0) ? "\n    " : " ", m_memory[USER_MEMORY_START + i]);
+    }
+    fprintf(out, "\n};\n\n");
+
+    fprintf(out, "static C8_CodeState verify(C8_Context *context) {\n");
+    fprintf(out, "    if (context->config.xochip != %d) return C8_CODE_MODIFIED;\n\n", m_xochip ? 1 : 0);
+    fprintf(out, "    for (size_t i = 0; i < sizeof code_ranges / sizeof code_ranges[0]; ++i) {\n");
+    fprintf(out, "        if (memcmp(&context->memory[code_ranges[i][0]], &image[code_ranges[i][0] - USER_MEMORY_START], code_ranges[i][1]) != 0)\n");
+    fprintf(out, "            return C8_CODE_MODIFIED;\n");
+    fprintf(out, "    }\n\n");
+    fprintf(out, "    return C8_CODE_VERIFIED;\n}\n\n");
+
+    fprintf(out, "int %s_run(C8_Context *context, int cycles) {\n", name.c_str());
+    fprintf(out, "    int executed = 0;\n");
+    fprintf(out, "    C8_AotBlock block = { NULL, 0 };\n\n");
+    fprintf(out, "    while (executed < cycles && context->is_running) {\n");
+    fprintf(out, "        if (context->code_state == C8_CODE_WRITTEN) {\n");
+    fprintf(out, "            context->code_state = verify(context);\n");
+    fprintf(out, "            block.fn = NULL;\n");
+    fprintf(out, "        }\n\n");
+    fprintf(out, "        if (context->code_state == C8_CODE_MODIFIED) {\n");
+    fprintf(out, "            int rv = C8_Run(context, cycles - executed);\n");
+    fprintf(out, "            return rv < 0 ? rv : executed + rv;\n");
+    fprintf(out, "        }\n\n");
+    fprintf(out, "        if (block.fn == NULL) block = lookup(context->pc);\n\n");
+    fprintf(out, "        // not compiled (e.g. computed BNNN target) or too long for the batch: interpret one instruction\n");
+    fprintf(out, "        if (block.fn == NULL || block.length > cycles - executed) {\n");
+    fprintf(out, "            int rv = C8_Tick(context);\n");
+    fprintf(out, "            if (rv < 0) return -1;\n");
+    fprintf(out, "            ++executed;\n");
+    fprintf(out, "            block.fn = NULL;\n");
+    fprintf(out, "            if (rv == 0) break;     // exited\n");
+    fprintf(out, "            continue;\n");
+    fprintf(out, "        }\n\n");
+    fprintf(out, "        block = block.fn(context, &executed);\n");
+    fprintf(out, "    }\n\n");
+    fprintf(out, "    // faults stop the program like in C8_Run, breakpoints are never set here\n");
+    fprintf(out, "    if (!context->is_running && context->m_error.err != C8_GOOD && context->m_error.err != C8_EXIT) {\n");
+    fprintf(out, "        if (executed > 0) fprintf(stderr, \"c8_aot Error(%%d): %%s at %%04x(%%04x)\\n\", context->m_error.err,\n");
+    fprintf(out, "                                  C8_ErrorString(context->m_error.err), context->m_error.pc, context->m_error.opcode);\n");
+    fprintf(out, "        return -1;\n");
+    fprintf(out, "    }\n\n");
+    fprintf(out, "    return executed;\n}\n");
+
+    fclose(out);
+
+    printf("%s: %zu instructions in %zu blocks\n", path, m_code.size(), m_leaders.size());
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    bool        xochip = false;
+    std::string name = "c8_aot";
+
+    if (argc < 3) {
+        fprintf(stderr, help_msg, argv[0]);
+        return 1;
+    }
+
+    for (int i = 3; i < argc; ++i) {
+        if (!strcmp(argv[i], "--xochip")) {
+            xochip = true;
+        } else if (!strcmp(argv[i], "--name") && i + 1 < argc) {
+            name = argv[++i];
+        } else {
+            fprintf(stderr, help_msg, argv[0]);
+            return 1;
+        }
+    }
+
+    C8Recompiler recompiler(xochip);
+
+    if (recompiler.load(argv[1]) != 0) return 1;
+
+    recompiler.analyze();
+
+    return recompiler.emit(argv[2], name, argv[1]) == 0 ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+#include "chip8.h"
+#include "c8_def.h"
+#include "c8_recorder.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *help_msg = "\
+Usage: c8record <GAME_PATH> <OUTPUT> [--frames N] [--clockspeed HZ] [--fps FPS] [--scale S] [--xochip]\n\
+OUTPUT ending in .y4m or .rle selects the format, anything else is a prefix for PPM frames\n";
+
+// Run a ROM without a window, as fast as possible, and record every frame
+int main(int argc, char **argv) {
+    C8_Context          context;
+    C8_Recorder         recorder;
+    C8_RecordOptions    options;
+    long                frames      = 600;
+    float               clockspeed  = DEFAULT_CLOCKSPEED;
+    float               fps         = DEFAULT_FPS;
+    double              timers      = 0;
+    double              cycles      = 0;
+    int                 rv;
+
+    if (argc < 3) {
+        fprintf(stderr, "%s", help_msg);
+        return 1;
+    }
+
+    memset(&options, 0, sizeof options);
+    options.format = C8_RecordFormatFromPath(argv[2]);
+    options.block  = 1;     // offline, nothing to keep up with
+
+    C8_Reset(&context, NULL);
+
+    for (int i = 3; i < argc; ++i) {
+        if (strcmp(argv[i], "--xochip") == 0) {
+            context.config.xochip = 1;
+        } else if (i + 1 < argc && strcmp(argv[i], "--frames") == 0) {
+            frames = atol(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--clockspeed") == 0) {
+            clockspeed = atof(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--fps") == 0) {
+            fps = atof(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--scale") == 0) {
+            options.scale = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "%s", help_msg);
+            C8_Destroy(&context);
+            return 1;
+        }
+    }
+
+    options.fps = (int)fps;
+
+    if (C8_LoadProgram(&context, argv[1]) != 0) {
+        fprintf(stderr, "Cannot load %s\n", argv[1]);
+        C8_Destroy(&context);
+        return 1;
+    }
+
+    if (C8_RecorderOpen(&recorder, argv[2], &options) != 0) {
+        fprintf(stderr, "Cannot record to %s\n", argv[2]);
+        C8_Destroy(&context);
+        return 1;
+    }
+
+    for (long frame = 0; frame < frames; ++frame) {
+        // spread the instructions and 60hz timer updates over frames
+        cycles += clockspeed / fps;
+        timers += 60.0 / fps;
+
+        rv = C8_Run(&context, (int)cycles);
+        if (rv < 0) break;
+        cycles -= (int)cycles;
+
+        for (; timers >= 1; timers -= 1) C8_UpdateTimers(&context);
+
+        C8_RecorderPush(&recorder, &context);
+
+        if (!context.is_running && context.m_on_set_key == NULL) break;    // exited
+    }
+
+    printf("%llu frames, %llu duplicates\n", (unsigned long long)recorder.frames, (unsigned long long)recorder.duplicates);
+    rv = C8_RecorderClose(&recorder);
+    C8_Destroy(&context);
+
+    return rv == 0 ? 0 : 1;
+}
@@ -0,0 +1,308 @@
+#include "c8_recorder.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Colors indexed by plane bits, as drawn by the frontend
+static const BYTE gray[]       = { 0x00, 0xFF, 0xAA, 0x55 };
+static const BYTE palette[][3] = { { 0x00, 0x00, 0x00 }, { 0xFF, 0xFF, 0xFF }, { 0xAA, 0xAA, 0xAA }, { 0x55, 0x55, 0x55 } };
+
+C8_RecordFormat C8_RecordFormatFromPath(const char *path) {
+    const char *ext = strrchr(path, '.');
+
+    if (ext != NULL && strcmp(ext, ".y4m") == 0) return C8_RECORD_Y4M;
+    if (ext != NULL && strcmp(ext, ".rle") == 0) return C8_RECORD_RLE;
+
+    return C8_RECORD_PPM;
+}
+
+/* Encoders, on the recorder thread */
+
+static void write_or_fail(C8_Recorder *recorder, const void *data, size_t size, FILE *out) {
+    if (size != 0 && fwrite(data, size, 1, out) != 1) recorder->error = 1;
+}
+
+// Y4M frames are always 128x64 so the stream keeps one size across mode switches
+static void encode_y4m(C8_Recorder *recorder, const C8_RecordFrame *frame, uint64_t repeat, BYTE *buffer) {
+    int    scale  = recorder->options.scale;
+    int    shift  = frame->hires ? 0 : 1;
+    int    width  = SCREEN_HIRES_WIDTH * scale;
+    size_t size   = (size_t)width * SCREEN_HIRES_HEIGHT * scale;
+
+    for (int y = 0; y < SCREEN_HIRES_HEIGHT * scale; ++y) {
+        for (int x = 0; x < width; ++x) {
+            buffer[y * width + x] = gray[C8_GET_PIXEL(frame, (x / scale) >> shift, (y / scale) >> shift)];
+        }
+    }
+
+    while (repeat--) {
+        write_or_fail(recorder, "FRAME\n", 6, recorder->out);
+        write_or_fail(recorder, buffer, size, recorder->out);
+    }
+}
+
+static void encode_ppm(C8_Recorder *recorder, const C8_RecordFrame *frame, BYTE *buffer) {
+    int    scale  = recorder->options.scale;
+    int    width  = C8_DISPLAY_WIDTH(frame) * scale;
+    int    height = C8_DISPLAY_HEIGHT(frame) * scale;
+    size_t length = strlen(recorder->path) + 32;
+    char  *name   = (char*)malloc(length);
+    FILE  *out;
+    BYTE  *p      = buffer;
+
+    snprintf(name, length, "%s%06llu.ppm", recorder->path, (unsigned long long)frame->index);
+    out = fopen(name, "wb");
+    free(name);
+
+    if (out == NULL) {
+        recorder->error = 1;
+        return;
+    }
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x, p += 3) {
+            memcpy(p, palette[C8_GET_PIXEL(frame, x / scale, y / scale)], 3);
+        }
+    }
+
+    fprintf(out, "P6\n%d %d\n255\n", width, height);
+    write_or_fail(recorder, buffer, (size_t)width * height * 3, out);
+    fclose(out);
+}
+
+static size_t put_leb128(BYTE *dst, uint64_t value) {
+    size_t n = 0;
+
+    do {
+        BYTE b = value & 0x7F;
+        value >>= 7;
+        dst[n++] = b | (value ? 0x80 : 0);
+    } while (value);
+
+    return n;
+}
+
+static void put_record_header(BYTE *dst, uint64_t index, int width, int height, int planes) {
+    for (int i = 0; i < 8; ++i) dst[i] = (BYTE)(index >> (8 * i));
+    dst[8]  = (BYTE)width;
+    dst[9]  = (BYTE)height;
+    dst[10] = (BYTE)planes;
+}
+
+// Runs are counted a word at a time on the packed rows
+static void encode_rle(C8_Recorder *recorder, const C8_RecordFrame *frame, BYTE *buffer) {
+    int      width  = C8_DISPLAY_WIDTH(frame);
+    int      height = C8_DISPLAY_HEIGHT(frame);
+    size_t   n      = 11;
+
+    put_record_header(buffer, frame->index, width, height, SCREEN_PLANE_COUNT);
+
+    for (int plane = 0; plane < SCREEN_PLANE_COUNT; ++plane) {
+        uint64_t run = 0;
+        int      bit = 0;
+
+        for (int y = 0; y < height; ++y) {
+            const uint64_t *row = C8_PLANE_ROW(frame, plane, y);
+
+            for (int x = 0; x < width; x += 64) {
+                uint64_t word = row[x >> 6];
+                int      left = (width - x < 64) ? width - x : 64;
+
+                // keep only the visible pixels, MSB first
+                if (left < 64) word &= ~0ull << (64 - left);
+
+                while (left > 0) {
+                    // length of the leading run of `bit` in the remaining pixels
+                    uint64_t v     = bit ? ~word : word;
+                    int      count = v ? __builtin_clzll(v) : 64;
+
+                    if (count > left) count = left;
+
+                    run  += count;
+                    left -= count;
+                    word <<= count;
+
+                    if (left > 0) {
+                        n   += put_leb128(buffer + n, run);
+                        run  = 0;
+                        bit ^= 1;
+                    }
+                }
+            }
+        }
+
+        n += put_leb128(buffer + n, run);
+    }
+
+    write_or_fail(recorder, buffer, n, recorder->out);
+}
+
+static void *encoder_thread(void *user) {
+    C8_Recorder    *recorder = (C8_Recorder*)user;
+    C8_RecordFrame *previous = NULL;
+    C8_RecordFrame  held;
+    BYTE           *buffer;
+    int             scale    = recorder->options.scale;
+
+    // large enough for any format: RGB scaled frame or worst case RLE runs
+    buffer = (BYTE*)malloc((size_t)SCREEN_HIRES_WIDTH * SCREEN_HIRES_HEIGHT * scale * scale * 3 + SCREEN_PLANE_COUNT * SCREEN_BUFFER_SIZE_IN_BITS * 2 + 64);
+
+    for (;;) {
+        C8_RecordFrame *frame;
+
+        pthread_mutex_lock(&recorder->lock);
+        while (recorder->count == 0 && !recorder->closing) {
+            pthread_cond_wait(&recorder->not_empty, &recorder->lock);
+        }
+        if (recorder->count == 0) {
+            pthread_mutex_unlock(&recorder->lock);
+            break;
+        }
+        frame = &recorder->queue[recorder->head];
+        pthread_mutex_unlock(&recorder->lock);
+
+        switch (recorder->options.format) {
+            case C8_RECORD_Y4M:
+                // a frame is written once the next one tells how long it lasted
+                if (previous != NULL) encode_y4m(recorder, previous, frame->index - previous->index, buffer);
+                held     = *frame;
+                previous = &held;
+                break;
+            case C8_RECORD_PPM: encode_ppm(recorder, frame, buffer); break;
+            case C8_RECORD_RLE: encode_rle(recorder, frame, buffer); break;
+        }
+
+        pthread_mutex_lock(&recorder->lock);
+        recorder->head = (recorder->head + 1) % RECORDER_QUEUE_LENGTH;
+        --recorder->count;
+        pthread_cond_signal(&recorder->not_full);
+        pthread_mutex_unlock(&recorder->lock);
+    }
+
+    // the producer stopped, recorder->frames is final
+    if (previous != NULL) {
+        encode_y4m(recorder, previous, recorder->frames - previous->index, buffer);
+    }
+    if (recorder->options.format == C8_RECORD_RLE) {
+        put_record_header(buffer, recorder->frames, 0, 0, 0);
+        write_or_fail(recorder, buffer, 11, recorder->out);
+    }
+
+    free(buffer);
+    return NULL;
+}
+
+/* Producer */
+
+int C8_RecorderOpen(C8_Recorder *recorder, const char *path, const C8_RecordOptions *options) {
+    memset(recorder, 0, sizeof *recorder);
+
+    recorder->options = *options;
+    if (recorder->options.scale < 1) recorder->options.scale = 1;
+    if (recorder->options.fps   < 1) recorder->options.fps   = 60;
+
+    recorder->path  = strdup(path);
+    recorder->queue = (C8_RecordFrame*)malloc(RECORDER_QUEUE_LENGTH * sizeof(C8_RecordFrame));
+
+    if (recorder->options.format != C8_RECORD_PPM) {
+        recorder->out = fopen(path, "wb");
+    }
+
+    if (recorder->path == NULL || recorder->queue == NULL || (recorder->options.format != C8_RECORD_PPM && recorder->out == NULL)) {
+        goto fail;
+    }
+
+    if (recorder->options.format == C8_RECORD_Y4M) {
+        fprintf(recorder->out, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 Cmono\n",
+                SCREEN_HIRES_WIDTH * recorder->options.scale, SCREEN_HIRES_HEIGHT * recorder->options.scale, recorder->options.fps);
+    } else if (recorder->options.format == C8_RECORD_RLE) {
+        fwrite(C8_RLE_MAGIC, 4, 1, recorder->out);
+        fputc(C8_RLE_VERSION, recorder->out);
+    }
+
+    pthread_mutex_init(&recorder->lock, NULL);
+    pthread_cond_init(&recorder->not_empty, NULL);
+    pthread_cond_init(&recorder->not_full, NULL);
+
+    if (pthread_create(&recorder->thread, NULL, encoder_thread, recorder) != 0) {
+        pthread_mutex_destroy(&recorder->lock);
+        pthread_cond_destroy(&recorder->not_empty);
+        pthread_cond_destroy(&recorder->not_full);
+        goto fail;
+    }
+
+    return 0;
+
+fail:
+    if (recorder->out != NULL) fclose(recorder->out);
+    free(recorder->queue);
+    free(recorder->path);
+    memset(recorder, 0, sizeof *recorder);
+    return -1;
+}
+
+void C8_RecorderPush(C8_Recorder *recorder, const C8_Context *context) {
+    C8_RecordFrame *slot;
+
+    if (recorder->queue == NULL) return;
+
+    // identical frames only extend the previous one
+    if (recorder->frames != 0 && recorder->last.hires == context->hires &&
+        memcmp(recorder->last.display, context->display, sizeof recorder->last.display) == 0) {
+        ++recorder->frames;
+        ++recorder->duplicates;
+        return;
+    }
+
+    pthread_mutex_lock(&recorder->lock);
+    while (recorder->count == RECORDER_QUEUE_LENGTH && recorder->options.block) {
+        pthread_cond_wait(&recorder->not_full, &recorder->lock);
+    }
+    if (recorder->count == RECORDER_QUEUE_LENGTH) {
+        pthread_mutex_unlock(&recorder->lock);
+        // the previous frame lasts longer rather than stalling the emulation
+        ++recorder->frames;
+        ++recorder->dropped;
+        return;
+    }
+    slot = &recorder->queue[(recorder->head + recorder->count) % RECORDER_QUEUE_LENGTH];
+    pthread_mutex_unlock(&recorder->lock);
+
+    // the encoder doesn't see the slot before count is incremented
+    memcpy(recorder->last.display, context->display, sizeof recorder->last.display);
+    recorder->last.hires = context->hires;
+    recorder->last.index = recorder->frames++;
+    *slot = recorder->last;
+
+    pthread_mutex_lock(&recorder->lock);
+    ++recorder->count;
+    pthread_cond_signal(&recorder->not_empty);
+    pthread_mutex_unlock(&recorder->lock);
+}
+
+int C8_RecorderClose(C8_Recorder *recorder) {
+    int rv;
+
+    if (recorder->queue == NULL) return -1;
+
+    pthread_mutex_lock(&recorder->lock);
+    recorder->closing = 1;
+    pthread_cond_signal(&recorder->not_empty);
+    pthread_mutex_unlock(&recorder->lock);
+
+    pthread_join(recorder->thread, NULL);
+
+    if (recorder->out != NULL && fclose(recorder->out) != 0) recorder->error = 1;
+
+    rv = (recorder->error || recorder->dropped) ? -1 : 0;
+
+    pthread_mutex_destroy(&recorder->lock);
+    pthread_cond_destroy(&recorder->not_empty);
+    pthread_cond_destroy(&recorder->not_full);
+    free(recorder->queue);
+    free(recorder->path);
+    recorder->queue = NULL;
+    recorder->path  = NULL;
+
+    return rv;
+}
@@ -0,0 +1,656 @@
+#include "chip8.h"
+#include "c8_def.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TAS_MOVIE_MAGIC "C8TAS 1"
+#define TAS_MAX_ACTIONS 17                                            // no key, then one per key
+
+static const char *help_msg = "\
+Usage: c8tas <GAME_PATH> <OUTPUT_MOVIE> --score EXPR [options]\n\
+       c8tas <GAME_PATH> --replay <MOVIE> [--score EXPR]\n\
+Search the key presses maximizing EXPR, one of V0-VF, I, DT, ST or a memory address\n\
+such as 0x2F0 (0x2F0:2 reads a big-endian word)\n\
+  --minimize       minimize EXPR instead\n\
+  --target N       stop as soon as EXPR reaches N\n\
+  --keys LIST      keys to try as hex digits, e.g. 456 (default: all)\n\
+  --depth D        segments to search (default: 100)\n\
+  --hold F         frames a segment holds its key (default: 4)\n\
+  --beam W         states kept after each segment (default: 64)\n\
+  --rollouts R     random rollouts scoring each candidate (default: 0)\n\
+  --lookahead L    segments per rollout (default: 8)\n\
+  --threads T      (default: one per core)\n\
+  --cycles N       instructions per 60hz frame (default: 8)\n\
+  --seed S         CXNN seed\n\
+  --xochip\n";
+
+/* Objective */
+
+typedef enum {
+    SCORE_REGISTER,
+    SCORE_I,
+    SCORE_DT,
+    SCORE_ST,
+    SCORE_MEMORY
+} ScoreKind;
+
+typedef struct {
+    ScoreKind   kind;
+    int         index;                                                // register or address
+    int         bytes;
+    int         sign;                                                 // -1 to minimize
+} Score;
+
+static int parse_score(const char *expr, Score *score) {
+    char *end;
+
+    score->index = 0;
+    score->bytes = 1;
+    score->sign  = 1;
+
+    if ((expr[0] == 'V' || expr[0] == 'v') && expr[1] != '\0' && expr[2] == '\0') {
+        score->kind  = SCORE_REGISTER;
+        score->index = (int)strtol(expr + 1, &end, 16);
+        return *end == '\0' ? 0 : -1;
+    }
+    if (strcmp(expr, "I") == 0)  { score->kind = SCORE_I;  return 0; }
+    if (strcmp(expr, "DT") == 0) { score->kind = SCORE_DT; return 0; }
+    if (strcmp(expr, "ST") == 0) { score->kind = SCORE_ST; return 0; }
+
+    score->kind  = SCORE_MEMORY;
+    score->index = (int)strtol(expr, &end, 0);
+    if (*end == ':') score->bytes = (int)strtol(end + 1, &end, 0);
+
+    return (*end == '\0' && score->index >= 0 && score->index < MEMORY_SIZE_IN_BYTES &&
+            score->bytes >= 1 && score->bytes <= 4 && score->index + score->bytes <= MEMORY_SIZE_IN_BYTES) ? 0 : -1;
+}
+
+static int64_t read_score(const Score *score, const C8_Context *context) {
+    int64_t value = 0;
+
+    switch (score->kind) {
+        case SCORE_REGISTER: value = context->registers[score->index]; break;
+        case SCORE_I:        value = context->addressI;                break;
+        case SCORE_DT:       value = context->delay_timer;             break;
+        case SCORE_ST:       value = context->sound_timer;             break;
+        case SCORE_MEMORY:
+            for (int i = 0; i < score->bytes; ++i) value = (value << 8) | context->memory[score->index + i];
+            break;
+    }
+
+    return score->sign * value;
+}
+
+/* Emulation */
+
+typedef struct {
+    Score       score;
+    int64_t     target;
+    int         has_target;
+    uint16_t    actions[TAS_MAX_ACTIONS];                             // key mask of each action
+    int         action_count;
+    int         depth;
+    int         hold;
+    int         beam;
+    int         rollouts;
+    int         lookahead;
+    int         threads;
+    int         cycles_per_frame;
+    uint32_t    seed;
+    int         xochip;
+} Options;
+
+static int exited(const C8_Context *context) {
+    return !context->is_running && context->m_on_set_key == NULL;
+}
+
+// Return -1 on error, 1 if the program exited, 0 otherwise
+static int run_frames(C8_Context *context, uint16_t keys, int frames, int cycles_per_frame) {
+    C8_SetKeys(context, keys);
+
+    for (int frame = 0; frame < frames; ++frame) {
+        if (C8_Run(context, cycles_per_frame) < 0) return -1;
+        C8_UpdateTimers(context);
+        if (exited(context)) return 1;
+    }
+
+    return 0;
+}
+
+static uint64_t mix(uint64_t h, uint64_t v) {
+    h ^= v;
+    h *= 0x9E3779B97F4A7C15ull;
+    return h ^ (h >> 29);
+}
+
+// Everything the future depends on, except the cycle count so that the same state
+// reached along a shorter path is a transposition
+static uint64_t hash_state(const C8_Context *context) {
+    size_t   size = C8_STACK_END(context) + 1;
+    uint64_t h    = 0xCBF29CE484222325ull;
+    uint64_t word;
+
+    h = mix(h, context->pc | (uint64_t)context->addressI << 16 | (uint64_t)context->sp << 32);
+    h = mix(h, context->delay_timer | context->sound_timer << 8 | (uint64_t)context->hires << 16 |
+               (uint64_t)context->planes << 24 | (uint64_t)context->pitch << 32 | (uint64_t)context->is_running << 40 |
+               (uint64_t)(context->m_on_set_key != NULL) << 41 | (uint64_t)context->m_keys << 48);
+    h = mix(h, context->rng);
+
+    for (int i = 0; i < REGISTER_COUNT; i += 8) {
+        memcpy(&word, context->registers + i, 8);
+        h = mix(h, word);
+    }
+    for (int i = 0; i < SCREEN_PLANE_COUNT * SCREEN_BUFFER_SIZE_IN_WORDS; ++i) {
+        h = mix(h, context->display[i]);
+    }
+    for (size_t i = 0; i + 8 <= size; i += 8) {
+        memcpy(&word, context->memory + i, 8);
+        h = mix(h, word);
+    }
+
+    return h | 1;                                                     // 0 marks empty table slots
+}
+
+/* Search */
+
+typedef struct {
+    BYTE       *state;
+    BYTE       *history;                                              // action of each segment
+} Node;
+
+typedef struct {
+    int         parent;                                               // index in the beam
+    int         action;
+    int         status;                                               // run_frames result
+    int64_t     score;                                                // after the segment
+    int64_t     value;                                                // best of score and rollouts, ranks the candidates
+    uint64_t    hash;
+} Candidate;
+
+typedef enum {
+    JOB_EVALUATE,
+    JOB_MATERIALIZE
+} Job;
+
+typedef struct {
+    const Options  *options;
+    size_t          state_size;
+    Node           *beam;
+    Node           *next;
+    int             beam_size;
+    Candidate      *candidates;
+    int             candidate_count;
+    const int      *selected;                                         // candidates becoming the next beam
+    int             selected_count;
+    int             depth;
+
+    Job             job;
+    int             job_size;
+    int             next_item;
+    uint64_t        instructions;
+} Search;
+
+typedef struct {
+    Search     *search;
+    C8_Context  context;
+    BYTE       *scratch;
+    uint64_t    instructions;
+} Worker;
+
+static uint32_t xorshift32(uint32_t *s) {
+    *s ^= *s << 13;
+    *s ^= *s >> 17;
+    *s ^= *s << 5;
+    return *s;
+}
+
+// Random continuations from the candidate, saved in scratch
+static int64_t rollouts(Worker *worker, Candidate *candidate, int index) {
+    const Options *options = worker->search->options;
+    C8_Context    *context = &worker->context;
+    int64_t        best    = candidate->score;
+
+    for (int r = 0; r < options->rollouts; ++r) {
+        // seeded from the candidate only, the result doesn't depend on the thread count
+        uint32_t s = (uint32_t)mix(mix(options->seed, worker->search->depth), (uint64_t)index << 16 | r) | 1;
+
+        C8_LoadState(context, worker->scratch);
+        for (int step = 0; step < options->lookahead; ++step) {
+            uint64_t before = context->cycles;
+            int      status = run_frames(context, options->actions[xorshift32(&s) % options->action_count],
+                                         options->hold, options->cycles_per_frame);
+
+            worker->instructions += context->cycles - before;
+            if (status < 0) break;
+            if (read_score(&options->score, context) > best) best = read_score(&options->score, context);
+            if (status > 0) break;
+        }
+    }
+
+    return best;
+}
+
+static void evaluate(Worker *worker, int index) {
+    Search        *search    = worker->search;
+    const Options *options   = search->options;
+    C8_Context    *context   = &worker->context;
+    Candidate     *candidate = &search->candidates[index];
+    uint64_t       before;
+
+    candidate->parent = index / options->action_count;
+    candidate->action = index % options->action_count;
+
+    C8_LoadState(context, search->beam[candidate->parent].state);
+    before = context->cycles;
+    candidate->status = run_frames(context, options->actions[candidate->action], options->hold, options->cycles_per_frame);
+    worker->instructions += context->cycles - before;
+
+    if (candidate->status < 0) return;
+
+    candidate->score = read_score(&options->score, context);
+    candidate->value = candidate->score;
+    candidate->hash  = hash_state(context);
+
+    if (options->rollouts > 0 && candidate->status == 0) {
+        C8_SaveState(context, worker->scratch);
+        candidate->value = rollouts(worker, candidate, index);
+    }
+}
+
+// Replay the segment of a selected candidate into the next beam
+static void materialize(Worker *worker, int slot) {
+    Search          *search    = worker->search;
+    const Options   *options   = search->options;
+    const Candidate *candidate = &search->candidates[search->selected[slot]];
+    C8_Context      *context   = &worker->context;
+    uint64_t         before;
+
+    C8_LoadState(context, search->beam[candidate->parent].state);
+    before = context->cycles;
+    run_frames(context, options->actions[candidate->action], options->hold, options->cycles_per_frame);
+    worker->instructions += context->cycles - before;
+
+    C8_SaveState(context, search->next[slot].state);
+    memcpy(search->next[slot].history, search->beam[candidate->parent].history, search->depth);
+    search->next[slot].history[search->depth] = (BYTE)candidate->action;
+}
+
+static void *worker_thread(void *user) {
+    Worker *worker = (Worker*)user;
+    Search *search = worker->search;
+    int     item;
+
+    // items are handed out one at a time, rollouts make their cost uneven
+    while ((item = __atomic_fetch_add(&search->next_item, 1, __ATOMIC_RELAXED)) < search->job_size) {
+        if (search->job == JOB_EVALUATE) evaluate(worker, item);
+        else                             materialize(worker, item);
+    }
+
+    return NULL;
+}
+
+static void run_job(Search *search, Worker *workers, Job job, int size) {
+    pthread_t threads[search->options->threads];
+    int       started = 0;
+
+    search->job       = job;
+    search->job_size  = size;
+    search->next_item = 0;
+
+    for (int t = 1; t < search->options->threads; ++t) {
+        if (pthread_create(&threads[started], NULL, worker_thread, &workers[t]) == 0) ++started;
+    }
+    worker_thread(&workers[0]);
+
+    for (int t = 0; t < started; ++t) {
+        pthread_join(threads[t], NULL);
+    }
+}
+
+static const Candidate *sorted_candidates;                            // sorting happens on the main thread only
+
+// Best first, ties broken by index so the search is reproducible
+static int compare_candidates(const void *a, const void *b) {
+    const Candidate *x = &sorted_candidates[*(const int*)a];
+    const Candidate *y = &sorted_candidates[*(const int*)b];
+
+    if (x->value != y->value) return x->value > y->value ? -1 : 1;
+    return *(const int*)a - *(const int*)b;
+}
+
+/* Transposition table, open addressing on the state hash */
+
+typedef struct {
+    uint64_t   *slots;
+    size_t      mask;
+    size_t      count;
+} Table;
+
+// Return 1 if the hash was new
+static int table_insert(Table *table, uint64_t hash) {
+    size_t i = hash & table->mask;
+
+    if (table->count * 4 >= (table->mask + 1) * 3) return 1;          // full, stop pruning rather than probing forever
+
+    for (; table->slots[i] != 0; i = (i + 1) & table->mask) {
+        if (table->slots[i] == hash) return 0;
+    }
+    table->slots[i] = hash;
+    ++table->count;
+
+    return 1;
+}
+
+/* Movies: a header then the held keys mask of every frame, one per line */
+
+static int write_movie(const char *path, const Options *options, const BYTE *history, int segments) {
+    FILE *out = fopen(path, "w");
+
+    if (out == NULL) return -1;
+
+    fprintf(out, "%s\ncycles_per_frame %d\nxochip %d\nseed %08X\nframes %d\n", TAS_MOVIE_MAGIC,
+            options->cycles_per_frame, options->xochip, options->seed, segments * options->hold);
+    for (int i = 0; i < segments; ++i) {
+        for (int f = 0; f < options->hold; ++f) {
+            fprintf(out, "%04X\n", options->actions[history[i]]);
+        }
+    }
+
+    return fclose(out) == 0 ? 0 : -1;
+}
+
+static int replay_movie(const char *rom, const char *path, const Options *options) {
+    FILE       *in = fopen(path, "r");
+    C8_Context  context;
+    char        magic[16];
+    int         cycles_per_frame, xochip, frames, played = 0, status = 0;
+    unsigned    seed, keys;
+
+    if (in == NULL) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return 1;
+    }
+    if (fscanf(in, "%15[^\n] cycles_per_frame %d xochip %d seed %x frames %d", magic, &cycles_per_frame, &xochip, &seed, &frames) != 5 ||
+        strcmp(magic, TAS_MOVIE_MAGIC) != 0) {
+        fprintf(stderr, "%s is not a movie\n", path);
+        fclose(in);
+        return 1;
+    }
+
+    C8_Reset(&context, NULL);
+    context.config.xochip = xochip;
+    if (C8_LoadProgram(&context, rom) != 0) {
+        fprintf(stderr, "Cannot load %s\n", rom);
+        C8_Destroy(&context);
+        fclose(in);
+        return 1;
+    }
+    C8_Seed(&context, seed);
+
+    for (; played < frames && status == 0 && fscanf(in, "%x", &keys) == 1; ++played) {
+        status = run_frames(&context, (uint16_t)keys, 1, cycles_per_frame);
+    }
+    fclose(in);
+
+    printf("%d/%d frames, %llu instructions%s\n", played, frames, (unsigned long long)context.cycles,
+           status < 0 ? ", error" : status > 0 ? ", exited" : "");
+    if (options->score.sign != 0) {
+        printf("score %lld\n", (long long)(options->score.sign * read_score(&options->score, &context)));
+    }
+
+    C8_Destroy(&context);
+    return status < 0 ? 1 : 0;
+}
+
+static int search(const char *rom, const char *path, const Options *options) {
+    Search       search;
+    Worker      *workers;
+    Table        table;
+    C8_Context   root;
+    Candidate    best;
+    BYTE        *best_history;
+    int         *order, *selected;
+    int          best_depth = 0, found = 0, rv = 0;
+    size_t       capacity;
+    uint64_t     pruned = 0;
+    struct timespec start, now;
+
+    C8_Reset(&root, NULL);
+    root.config.xochip = options->xochip;
+    if (C8_LoadProgram(&root, rom) != 0) {
+        fprintf(stderr, "Cannot load %s\n", rom);
+        C8_Destroy(&root);
+        return 1;
+    }
+    C8_Seed(&root, options->seed);
+
+    memset(&search, 0, sizeof search);
+    search.options         = options;
+    search.state_size      = C8_StateSize(&root);
+    search.beam            = (Node*)calloc(options->beam, sizeof(Node));
+    search.next            = (Node*)calloc(options->beam, sizeof(Node));
+    search.candidates      = (Candidate*)calloc((size_t)options->beam * options->action_count, sizeof(Candidate));
+    order                  = (int*)malloc((size_t)options->beam * options->action_count * sizeof(int));
+    selected               = (int*)malloc(options->beam * sizeof(int));
+    best_history           = (BYTE*)calloc(options->depth, 1);
+    workers                = (Worker*)calloc(options->threads, sizeof(Worker));
+
+    // every state kept is inserted once, plus the root
+    for (capacity = 1024; capacity < (size_t)options->beam * options->depth * 2; capacity *= 2);
+    table.slots = (uint64_t*)calloc(capacity, sizeof(uint64_t));
+    table.mask  = capacity - 1;
+    table.count = 0;
+
+    for (int i = 0; i < options->beam; ++i) {
+        search.beam[i].state   = (BYTE*)malloc(search.state_size);
+        search.beam[i].history = (BYTE*)malloc(options->depth);
+        search.next[i].state   = (BYTE*)malloc(search.state_size);
+        search.next[i].history = (BYTE*)malloc(options->depth);
+    }
+    for (int t = 0; t < options->threads; ++t) {
+        workers[t].search  = &search;
+        workers[t].scratch = (BYTE*)malloc(search.state_size);
+        C8_Reset(&workers[t].context, NULL);
+    }
+
+    C8_SaveState(&root, search.beam[0].state);
+    search.beam_size = 1;
+    table_insert(&table, hash_state(&root));
+
+    best.score = read_score(&options->score, &root);
+    found      = options->has_target && best.score >= options->target;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (search.depth = 0; search.depth < options->depth && search.beam_size > 0 && !found; ++search.depth) {
+        int count = search.beam_size * options->action_count;
+        int kept  = 0;
+        Node *swap;
+
+        search.candidate_count = count;
+        run_job(&search, workers, JOB_EVALUATE, count);
+
+        for (int i = 0; i < count; ++i) order[i] = i;
+        sorted_candidates = search.candidates;
+        qsort(order, count, sizeof(int), compare_candidates);
+
+        for (int i = 0; i < count; ++i) {
+            Candidate *candidate = &search.candidates[order[i]];
+
+            if (candidate->status < 0) continue;
+
+            // best actual score, the earliest one wins ties
+            if (candidate->score > best.score) {
+                best       = *candidate;
+                best_depth = search.depth + 1;
+                memcpy(best_history, search.beam[candidate->parent].history, search.depth);
+                best_history[search.depth] = (BYTE)candidate->action;
+                found = options->has_target && best.score >= options->target;
+            }
+
+            if (candidate->status > 0 || kept == options->beam) continue;
+            if (!table_insert(&table, candidate->hash)) {
+                ++pruned;
+                continue;
+            }
+            selected[kept++] = order[i];
+        }
+
+        search.selected       = selected;
+        search.selected_count = kept;
+        run_job(&search, workers, JOB_MATERIALIZE, kept);
+
+        swap             = search.beam;
+        search.beam      = search.next;
+        search.next      = swap;
+        search.beam_size = kept;
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        fprintf(stderr, "\rdepth %d  beam %d  best %lld  pruned %llu", search.depth + 1, kept,
+                (long long)(options->score.sign * best.score), (unsigned long long)pruned);
+    }
+    fprintf(stderr, "\n");
+
+    for (int t = 0; t < options->threads; ++t) search.instructions += workers[t].instructions;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    {
+        double seconds = (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) * 1e-9;
+
+        printf("%llu instructions in %.2f s, %.0f ips on %d threads\n", (unsigned long long)search.instructions,
+               seconds, seconds > 0 ? search.instructions / seconds : 0.0, options->threads);
+    }
+
+    if (options->has_target && !found) {
+        printf("target %lld not reached\n", (long long)(options->score.sign * options->target));
+    }
+    printf("best %lld after %d frames\n", (long long)(options->score.sign * best.score), best_depth * options->hold);
+
+    if (write_movie(path, options, best_history, best_depth) != 0) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        rv = 1;
+    }
+
+    for (int t = 0; t < options->threads; ++t) {
+        C8_Destroy(&workers[t].context);
+        free(workers[t].scratch);
+    }
+    for (int i = 0; i < options->beam; ++i) {
+        free(search.beam[i].state);
+        free(search.beam[i].history);
+        free(search.next[i].state);
+        free(search.next[i].history);
+    }
+    free(search.beam);
+    free(search.next);
+    free(search.candidates);
+    free(order);
+    free(selected);
+    free(best_history);
+    free(workers);
+    free(table.slots);
+    C8_Destroy(&root);
+
+    return rv;
+}
+
+int main(int argc, char **argv) {
+    Options      options;
+    const char  *score  = NULL;
+    const char  *replay = NULL;
+    const char  *keys   = "0123456789ABCDEF";
+    int          first;
+
+    if (argc < 3) {
+        fprintf(stderr, "%s", help_msg);
+        return 1;
+    }
+
+    memset(&options, 0, sizeof options);
+    options.depth            = 100;
+    options.hold             = 4;
+    options.beam             = 64;
+    options.lookahead        = 8;
+    options.threads          = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    options.cycles_per_frame = DEFAULT_CLOCKSPEED / DEFAULT_FPS;
+    options.seed             = DEFAULT_SEED;
+
+    first = (strcmp(argv[2], "--replay") == 0) ? 2 : 3;
+
+    for (int i = first; i < argc; ++i) {
+        if (strcmp(argv[i], "--xochip") == 0) {
+            options.xochip = 1;
+        } else if (strcmp(argv[i], "--minimize") == 0) {
+            options.score.sign = -1;
+        } else if (i + 1 < argc && strcmp(argv[i], "--replay") == 0) {
+            replay = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--score") == 0) {
+            score = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--target") == 0) {
+            options.target     = strtoll(argv[++i], NULL, 0);
+            options.has_target = 1;
+        } else if (i + 1 < argc && strcmp(argv[i], "--keys") == 0) {
+            keys = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--depth") == 0) {
+            options.depth = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--hold") == 0) {
+            options.hold = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--beam") == 0) {
+            options.beam = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--rollouts") == 0) {
+            options.rollouts = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--lookahead") == 0) {
+            options.lookahead = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--threads") == 0) {
+            options.threads = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--cycles") == 0) {
+            options.cycles_per_frame = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--seed") == 0) {
+            options.seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else {
+            fprintf(stderr, "%s", help_msg);
+            return 1;
+        }
+    }
+
+    if (score != NULL) {
+        int sign = options.score.sign ? options.score.sign : 1;
+
+        if (parse_score(score, &options.score) != 0) {
+            fprintf(stderr, "Invalid score %s\n", score);
+            return 1;
+        }
+        options.score.sign = sign;
+        options.target    *= sign;
+    }
+
+    if (replay != NULL) {
+        if (score == NULL) options.score.sign = 0;
+        return replay_movie(argv[1], replay, &options);
+    }
+
+    if (score == NULL || options.depth < 1 || options.hold < 1 || options.beam < 1 || options.cycles_per_frame < 1) {
+        fprintf(stderr, "%s", help_msg);
+        return 1;
+    }
+    if (options.threads < 1) options.threads = 1;
+
+    // no key first, then each listed key alone
+    options.actions[options.action_count++] = 0;
+    for (const char *k = keys; *k != '\0' && options.action_count < TAS_MAX_ACTIONS; ++k) {
+        char  digit[2] = { *k, '\0' };
+        char *end;
+        long  key = strtol(digit, &end, 16);
+
+        if (*end != '\0') {
+            fprintf(stderr, "Invalid key %c\n", *k);
+            return 1;
+        }
+        options.actions[options.action_count++] = (uint16_t)(1 << key);
+    }
+
+    return search(argv[1], argv[2], &options);
+}
@@ -0,0 +1,146 @@
+#include "c8_telemetry.h"
+
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+// A reader gives up after this many torn copies, e.g. if the writer died mid-update
+#define MAX_READ_ATTEMPTS 1000
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/* Writer */
+
+int C8_TelemetryOpen(C8_Telemetry *telemetry, const char *path) {
+    int   fd;
+    void *addr;
+
+    memset(telemetry, 0, sizeof *telemetry);
+
+    fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return -1;
+
+    if (ftruncate(fd, sizeof(C8_TelemetryPage)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    addr = mmap(NULL, sizeof(C8_TelemetryPage), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);      // the mapping keeps the file
+    if (addr == MAP_FAILED) return -1;
+
+    telemetry->page                    = (C8_TelemetryPage*)addr;
+    telemetry->page->version           = C8_TELEMETRY_VERSION;
+    telemetry->page->size              = sizeof(C8_TelemetryPage);
+    telemetry->last_timestamp_ns       = monotonic_ns();
+
+    // readers check the magic last
+    __atomic_store_n(&telemetry->page->magic, C8_TELEMETRY_MAGIC, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+void C8_TelemetryPublish(C8_Telemetry *telemetry, const C8_Context *context, double frame_time_ms) {
+    C8_TelemetryPage     *page = telemetry->page;
+    C8_TelemetrySnapshot *s;
+    uint64_t              now;
+    uint32_t              seq;
+
+    if (page == NULL) return;
+
+    s   = &page->snapshot;
+    now = monotonic_ns();
+    seq = __atomic_load_n(&page->seq, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&page->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    if (now > telemetry->last_timestamp_ns) {
+        s->instructions_per_second = (double)(context->cycles - telemetry->last_cycles) * 1e9 / (now - telemetry->last_timestamp_ns);
+    }
+
+    s->cycles           = context->cycles;
+    s->timestamp_ns     = now;
+    s->frame_time_ms    = frame_time_ms;
+    s->frames          += 1;
+    s->error            = context->m_error.err;
+    s->pc               = context->pc;
+    s->sp               = context->sp;
+    s->addressI         = context->addressI;
+    s->delay_timer      = context->delay_timer;
+    s->sound_timer      = context->sound_timer;
+    s->hires            = context->hires;
+    s->planes           = context->planes;
+    s->is_running       = context->is_running;
+    memcpy(s->registers, context->registers, REGISTER_COUNT);
+    memcpy(s->display, context->display, sizeof s->display);
+
+    __atomic_store_n(&page->seq, seq + 2, __ATOMIC_RELEASE);
+
+    telemetry->last_cycles       = context->cycles;
+    telemetry->last_timestamp_ns = now;
+}
+
+void C8_TelemetryClose(C8_Telemetry *telemetry) {
+    if (telemetry->page != NULL) {
+        munmap(telemetry->page, sizeof(C8_TelemetryPage));
+        telemetry->page = NULL;
+    }
+}
+
+/* Reader */
+
+const C8_TelemetryPage *C8_TelemetryMap(const char *path) {
+    int                     fd;
+    void                   *addr;
+    const C8_TelemetryPage *page;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    if (lseek(fd, 0, SEEK_END) < (off_t)sizeof(C8_TelemetryPage)) {
+        close(fd);
+        return NULL;
+    }
+
+    addr = mmap(NULL, sizeof(C8_TelemetryPage), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) return NULL;
+
+    page = (const C8_TelemetryPage*)addr;
+    if (__atomic_load_n(&page->magic, __ATOMIC_ACQUIRE) != C8_TELEMETRY_MAGIC ||
+        page->version != C8_TELEMETRY_VERSION || page->size != sizeof(C8_TelemetryPage)) {
+        munmap(addr, sizeof(C8_TelemetryPage));
+        return NULL;
+    }
+
+    return page;
+}
+
+int C8_TelemetryRead(const C8_TelemetryPage *page, C8_TelemetrySnapshot *snapshot) {
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; ++attempt) {
+        uint32_t begin = __atomic_load_n(&page->seq, __ATOMIC_ACQUIRE);
+
+        if (begin & 1) continue;        // update in progress
+
+        memcpy(snapshot, &page->snapshot, sizeof *snapshot);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        if (__atomic_load_n(&page->seq, __ATOMIC_RELAXED) == begin) {
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+void C8_TelemetryUnmap(const C8_TelemetryPage *page) {
+    munmap((void*)page, sizeof(C8_TelemetryPage));
+}
@@ -0,0 +1,50 @@
+#include "c8_telemetry.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+static const char *help_msg = "Usage: c8telemetry <TELEMETRY_PATH> [--once]\n";
+
+static void print_snapshot(const C8_TelemetrySnapshot *s) {
+    printf("cycles %llu  %.0f ips  frame %.2f ms  frames %u  error %u%s\n",
+           (unsigned long long)s->cycles, s->instructions_per_second, s->frame_time_ms,
+           s->frames, s->error, s->is_running ? "" : "  (stopped)");
+    printf("PC %04X  SP %04X  I %04X  DT %02X  ST %02X  %s  planes %X\n",
+           s->pc, s->sp, s->addressI, s->delay_timer, s->sound_timer, s->hires ? "hires" : "lores", s->planes);
+
+    for (int i = 0; i < REGISTER_COUNT; ++i) {
+        printf("V%X %02X%s", i, s->registers[i], (i % 8 == 7) ? "\n" : "  ");
+    }
+}
+
+int main(int argc, char **argv) {
+    const C8_TelemetryPage *page;
+    C8_TelemetrySnapshot    snapshot;
+    int                     once;
+
+    if (argc < 2) {
+        fprintf(stderr, "%s", help_msg);
+        return 1;
+    }
+
+    once = (argc >= 3 && strcmp(argv[2], "--once") == 0);
+
+    page = C8_TelemetryMap(argv[1]);
+    if (page == NULL) {
+        fprintf(stderr, "Cannot map telemetry at %s\n", argv[1]);
+        return 1;
+    }
+
+    do {
+        if (C8_TelemetryRead(page, &snapshot) == 0) {
+            print_snapshot(&snapshot);
+            printf("\n");
+        }
+
+        if (!once) sleep(1);
+    } while (!once);
+
+    C8_TelemetryUnmap(page);
+    return 0;
+}
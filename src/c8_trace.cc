@@ -0,0 +1,131 @@
+#include "c8_trace.hh"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+/*
+ * Every thread appends to its own ring, so recording takes no lock. Rings are pushed
+ * once on a lock-free list and never freed, the exporter walks them while threads
+ * keep recording.
+ */
+struct _C8_TraceBuffer {
+    _C8_TraceEvent          events[TRACE_BUFFER_EVENTS];
+    std::atomic<uint64_t>   head;                   // events ever recorded, the writer's release publishes them
+    int                     tid;
+    _C8_TraceBuffer        *next;
+
+    // frame in progress, only touched by the owner
+    float                   zone_ms[TRACE_MAX_ZONES];
+    uint64_t                frame_start;
+};
+
+static std::atomic<_C8_TraceBuffer*> buffers(nullptr);
+static std::atomic<int>              thread_count(0);
+static C8_FrameStats                 stats;
+
+static thread_local _C8_TraceBuffer *local = nullptr;
+
+static _C8_TraceBuffer *thread_buffer() {
+    if (local != nullptr) return local;
+
+    local = new _C8_TraceBuffer();
+    local->head.store(0, std::memory_order_relaxed);
+    local->tid  = thread_count.fetch_add(1, std::memory_order_relaxed) + 1;
+    local->next = buffers.load(std::memory_order_relaxed);
+
+    while (!buffers.compare_exchange_weak(local->next, local, std::memory_order_release, std::memory_order_relaxed));
+
+    return local;
+}
+
+uint64_t C8_TraceNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Zones are keyed by the name pointer, names are literals
+static size_t zone_index(const char *name) {
+    for (size_t i = 0; i < stats.zone_count; ++i) {
+        if (stats.zones[i].name == name) return i;
+    }
+    if (stats.zone_count == TRACE_MAX_ZONES) return TRACE_MAX_ZONES;
+
+    stats.zones[stats.zone_count].name = name;
+    return stats.zone_count++;
+}
+
+void C8_TraceRecord(const char *name, uint64_t start, uint64_t end) {
+    _C8_TraceBuffer *buffer = thread_buffer();
+    uint64_t         head   = buffer->head.load(std::memory_order_relaxed);
+    _C8_TraceEvent  &e      = buffer->events[head % TRACE_BUFFER_EVENTS];
+
+    e.name     = name;
+    e.start    = start;
+    e.duration = end - start;
+    buffer->head.store(head + 1, std::memory_order_release);
+
+    // only the thread closing frames feeds the stats
+    if (buffer->frame_start != 0) {
+        size_t zone = zone_index(name);
+        if (zone < TRACE_MAX_ZONES) buffer->zone_ms[zone] += (end - start) / 1e6f;
+    }
+}
+
+void C8_TraceFrame() {
+    _C8_TraceBuffer *buffer = thread_buffer();
+    uint64_t         now    = C8_TraceNow();
+    size_t           slot   = stats.count % TRACE_FRAME_HISTORY;
+
+    if (buffer->frame_start != 0) {
+        stats.frame_ms[slot] = (now - buffer->frame_start) / 1e6f;
+        for (size_t i = 0; i < TRACE_MAX_ZONES; ++i) {
+            stats.zones[i].ms[slot] = buffer->zone_ms[i];
+        }
+        ++stats.count;
+    }
+
+    memset(buffer->zone_ms, 0, sizeof buffer->zone_ms);
+    buffer->frame_start = now;
+}
+
+const C8_FrameStats &C8_TraceStats() {
+    return stats;
+}
+
+static void escape(FILE *out, const char *s) {
+    for (; *s != '\0'; ++s) {
+        if (*s == '"' || *s == '\\') fputc('\\', out);
+        fputc(*s, out);
+    }
+}
+
+bool C8_TraceExport(const char *path) {
+    FILE *out = fopen(path, "w");
+    bool  first = true;
+
+    if (out == NULL) return false;
+
+    fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    for (_C8_TraceBuffer *b = buffers.load(std::memory_order_acquire); b != nullptr; b = b->next) {
+        uint64_t head  = b->head.load(std::memory_order_acquire);
+        uint64_t begin = (head > TRACE_BUFFER_EVENTS) ? head - TRACE_BUFFER_EVENTS : 0;
+
+        // a live writer may lap the oldest entries while they are written, skip a margin
+        if (b != local && head > TRACE_BUFFER_EVENTS) begin += TRACE_BUFFER_EVENTS / 16;
+
+        for (uint64_t i = begin; i < head; ++i) {
+            const _C8_TraceEvent &e = b->events[i % TRACE_BUFFER_EVENTS];
+
+            fprintf(out, "%s{\"name\":\"", first ? "" : ",\n");
+            escape(out, e.name);
+            fprintf(out, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    b->tid, e.start / 1e3, e.duration / 1e3);
+            first = false;
+        }
+    }
+
+    fprintf(out, "\n]}\n");
+    return fclose(out) == 0;
+}
@@ -0,0 +1,52 @@
+#ifndef C8_TRACE_HH
+#define C8_TRACE_HH
+
+#include "c8_def.h"
+#include <cstddef>
+#include <cstdint>
+
+#define C8_TRACE_CONCAT_(a, b) a##b
+#define C8_TRACE_CONCAT(a, b)  C8_TRACE_CONCAT_(a, b)
+
+// Time the rest of the enclosing block under a static name
+#define C8_TRACE_SCOPE(name) C8_TraceScope C8_TRACE_CONCAT(_c8_trace_scope_, __LINE__)(name)
+
+// Completed span, `name` must outlive the trace (string literals)
+struct _C8_TraceEvent {
+    const char             *name;
+    uint64_t                start;                  // nanoseconds, steady clock
+    uint64_t                duration;
+};
+
+// Per-frame history of the thread calling C8_TraceFrame, oldest overwritten first
+struct C8_FrameStats {
+    struct Zone {
+        const char         *name;
+        float               ms[TRACE_FRAME_HISTORY];
+    };
+
+    float                   frame_ms[TRACE_FRAME_HISTORY];    // present to present
+    Zone                    zones[TRACE_MAX_ZONES];
+    size_t                  zone_count;
+    size_t                  count;                  // frames recorded so far, index count % TRACE_FRAME_HISTORY is next
+};
+
+uint64_t C8_TraceNow();
+void     C8_TraceRecord(const char *name, uint64_t start, uint64_t end);     // Never blocks, overwrites the oldest events
+void     C8_TraceFrame();                                                   // Close the frame of the calling thread
+bool     C8_TraceExport(const char *path);                                  // Chrome trace_event JSON, open in chrome://tracing or Perfetto
+const C8_FrameStats &C8_TraceStats();
+
+class C8_TraceScope {
+public:
+    explicit C8_TraceScope(const char *name) : m_name(name), m_start(C8_TraceNow()) {}
+    ~C8_TraceScope() { C8_TraceRecord(m_name, m_start, C8_TraceNow()); }
+
+    C8_TraceScope(const C8_TraceScope &) = delete;
+    C8_TraceScope &operator=(const C8_TraceScope &) = delete;
+private:
+    const char *m_name;
+    uint64_t    m_start;
+};
+
+#endif
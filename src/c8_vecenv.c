@@ -0,0 +1,238 @@
+#include "c8_vecenv.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum {
+    VECENV_JOB_RESET,
+    VECENV_JOB_STEP
+} VecEnvJob;
+
+/* Instances */
+
+static void write_observation(const C8_Context *context, BYTE *dst) {
+    for (int y = 0; y < VECENV_OBS_HEIGHT; ++y, dst += VECENV_OBS_WIDTH) {
+        if (!context->hires) {
+            uint64_t p0 = C8_PLANE_ROW(context, 0, y)[0];
+            uint64_t p1 = C8_PLANE_ROW(context, 1, y)[0];
+
+            for (int x = 0; x < VECENV_OBS_WIDTH; ++x) {
+                dst[x] = ((p0 >> (63 - x)) & 1) | (((p1 >> (63 - x)) & 1) << 1);
+            }
+        } else {
+            for (int plane = 0; plane < SCREEN_PLANE_COUNT; ++plane) {
+                const uint64_t *a = C8_PLANE_ROW(context, plane, 2 * y);
+                const uint64_t *b = C8_PLANE_ROW(context, plane, 2 * y + 1);
+
+                for (int x = 0; x < VECENV_OBS_WIDTH; ++x) {
+                    uint64_t word = a[x >> 5] | b[x >> 5];
+                    int      lit  = ((word >> (62 - 2 * (x & 31))) & 3) != 0;
+
+                    if (plane == 0) dst[x]  = lit;
+                    else            dst[x] |= lit << 1;
+                }
+            }
+        }
+    }
+}
+
+// No allocation: the state is copied over the existing buffers
+static void reset_instance(C8_VecEnv *env, int i) {
+    C8_Context *context = &env->contexts[i];
+
+    C8_LoadState(context, env->initial_state);
+    C8_Seed(context, env->options.seed ^ ((uint32_t)i * 0x9E3779B9u) ^ (env->episodes[i]++ * 0x85EBCA6Bu));
+}
+
+static void step_instance(C8_VecEnv *env, int i) {
+    C8_Context *context = &env->contexts[i];
+    float       reward  = 0;
+    int         done    = 0;
+
+    C8_SetKeys(context, env->actions[i]);
+
+    for (int frame = 0; frame < env->options.frameskip && !done; ++frame) {
+        if (C8_Run(context, env->options.cycles_per_frame) < 0) {
+            done = 1;
+            break;
+        }
+        C8_UpdateTimers(context);
+
+        // exited, not waiting for a key
+        if (!context->is_running && context->m_on_set_key == NULL) done = 1;
+    }
+
+    if (env->options.reward != NULL) {
+        reward = env->options.reward(context, &done, env->options.user_data);
+    }
+
+    if (env->rewards != NULL) env->rewards[i] = reward;
+    if (env->dones   != NULL) env->dones[i]   = (BYTE)(done != 0);
+
+    if (done) {
+        reset_instance(env, i);
+    }
+}
+
+static void run_shard(C8_VecEnv *env, int job, int shard, int shards) {
+    int begin = (int)((long)shard * env->count / shards);
+    int end   = (int)((long)(shard + 1) * env->count / shards);
+
+    for (int i = begin; i < end; ++i) {
+        if (job == VECENV_JOB_RESET) reset_instance(env, i);
+        else                         step_instance(env, i);
+
+        if (env->observations != NULL) {
+            write_observation(&env->contexts[i], env->observations + (size_t)i * VECENV_OBS_SIZE);
+        }
+    }
+}
+
+/* Thread pool */
+
+static void *worker_thread(void *user) {
+    C8_VecEnv *env   = (C8_VecEnv*)user;
+    int        shard = __atomic_fetch_add(&env->next_worker, 1, __ATOMIC_RELAXED);
+    unsigned   seen  = 0;
+
+    for (;;) {
+        int job;
+
+        pthread_mutex_lock(&env->lock);
+        while (env->generation == seen && !env->stopping) {
+            pthread_cond_wait(&env->start, &env->lock);
+        }
+        if (env->stopping) {
+            pthread_mutex_unlock(&env->lock);
+            break;
+        }
+        seen = env->generation;
+        job  = env->job;
+        pthread_mutex_unlock(&env->lock);
+
+        run_shard(env, job, shard, env->options.threads);
+
+        pthread_mutex_lock(&env->lock);
+        if (--env->pending == 0) pthread_cond_signal(&env->finished);
+        pthread_mutex_unlock(&env->lock);
+    }
+
+    return NULL;
+}
+
+static void dispatch(C8_VecEnv *env, int job) {
+    if (env->threads == NULL) {
+        run_shard(env, job, 0, 1);
+        return;
+    }
+
+    pthread_mutex_lock(&env->lock);
+    env->job     = job;
+    env->pending = env->options.threads;
+    ++env->generation;
+    pthread_cond_broadcast(&env->start);
+
+    while (env->pending > 0) {
+        pthread_cond_wait(&env->finished, &env->lock);
+    }
+    pthread_mutex_unlock(&env->lock);
+}
+
+/* API */
+
+int C8_VecEnvCreate(C8_VecEnv *env, const char *path, int count, const C8_VecEnvOptions *options) {
+    C8_Context loader;
+
+    memset(env, 0, sizeof *env);
+    if (count <= 0) return -1;
+
+    env->options = *options;
+    env->count   = count;
+    if (env->options.frameskip        < 1) env->options.frameskip        = 1;
+    if (env->options.cycles_per_frame < 1) env->options.cycles_per_frame = 1;
+    if (env->options.threads > count)      env->options.threads          = count;
+
+    // every instance starts from the state right after loading
+    C8_Reset(&loader, NULL);
+    loader.config = options->config;
+    if (C8_LoadProgram(&loader, path) != 0) {
+        C8_Destroy(&loader);
+        return -1;
+    }
+
+    env->initial_state = (BYTE*)malloc(C8_StateSize(&loader));
+    env->contexts      = (C8_Context*)calloc(count, sizeof(C8_Context));
+    env->episodes      = (uint32_t*)calloc(count, sizeof(uint32_t));
+
+    if (env->initial_state == NULL || env->contexts == NULL || env->episodes == NULL) {
+        C8_Destroy(&loader);
+        C8_VecEnvDestroy(env);
+        return -1;
+    }
+
+    C8_SaveState(&loader, env->initial_state);
+    C8_Destroy(&loader);
+
+    for (int i = 0; i < count; ++i) {
+        C8_Reset(&env->contexts[i], NULL);
+        env->contexts[i].config = options->config;
+        reset_instance(env, i);
+    }
+
+    if (env->options.threads > 1) {
+        pthread_mutex_init(&env->lock, NULL);
+        pthread_cond_init(&env->start, NULL);
+        pthread_cond_init(&env->finished, NULL);
+
+        env->threads = (pthread_t*)calloc(env->options.threads, sizeof(pthread_t));
+        for (int t = 0; t < env->options.threads; ++t) {
+            pthread_create(&env->threads[t], NULL, worker_thread, env);
+        }
+    }
+
+    return 0;
+}
+
+void C8_VecEnvSetBuffers(C8_VecEnv *env, BYTE *observations, float *rewards, BYTE *dones) {
+    env->observations = observations;
+    env->rewards      = rewards;
+    env->dones        = dones;
+}
+
+void C8_VecEnvReset(C8_VecEnv *env) {
+    dispatch(env, VECENV_JOB_RESET);
+}
+
+void C8_VecEnvStep(C8_VecEnv *env, const uint16_t *actions) {
+    env->actions = actions;
+    dispatch(env, VECENV_JOB_STEP);
+}
+
+void C8_VecEnvDestroy(C8_VecEnv *env) {
+    if (env->threads != NULL) {
+        pthread_mutex_lock(&env->lock);
+        env->stopping = 1;
+        pthread_cond_broadcast(&env->start);
+        pthread_mutex_unlock(&env->lock);
+
+        for (int t = 0; t < env->options.threads; ++t) {
+            pthread_join(env->threads[t], NULL);
+        }
+
+        pthread_mutex_destroy(&env->lock);
+        pthread_cond_destroy(&env->start);
+        pthread_cond_destroy(&env->finished);
+        free(env->threads);
+    }
+
+    if (env->contexts != NULL) {
+        for (int i = 0; i < env->count; ++i) {
+            C8_Destroy(&env->contexts[i]);
+        }
+    }
+
+    free(env->contexts);
+    free(env->episodes);
+    free(env->initial_state);
+    memset(env, 0, sizeof *env);
+}
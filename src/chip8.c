@@ -6,72 +6,142 @@
 #include <stdlib.h>
 #include <assert.h>
 
-#define SET_ERROR_1(err)      C8_SetError(context, (C8_Error){err, ""})
-#define SET_ERROR_2(err, msg) C8_SetError(context, (C8_Error){err, msg})
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-#define SET_ERROR_X(err, msg, FUNC, ...) FUNC
-#define SET_ERROR_MACRO_CHOOSER(...)                                                 \
-    SET_ERROR_X(__VA_ARGS__, SET_ERROR_2, SET_ERROR_1, )
-#define SET_ERROR(...) SET_ERROR_MACRO_CHOOSER(__VA_ARGS__)(__VA_ARGS__)
+#define SET_ERROR(err)        C8_SetError(context, (C8_Error){ err, 0, 0, 0 })
 
-#define GET_ERROR             C8_GetError(context)
-#define RETURN_ON_ERROR       if (GET_ERROR.err != C8_GOOD) return
+// Keep rarely taken paths out of the fetch-decode loop
+#if defined(__GNUC__)
+#define C8_COLD __attribute__((noinline, cold))
+#else
+#define C8_COLD
+#endif
+
+C8_COLD static void raise_fault(C8_Context *context, C8_ErrorEnum err, WORD address);
 
 /* Memory access */
-#define CHECK_AUTHORIZED_MEM_ACCESS(address, msg, res) \
-    if (address > USER_MEMORY_END) { SET_ERROR(C8_REFUSED_MEM_ACCESS, msg); return res; }
+#define CHECK_AUTHORIZED_MEM_ACCESS(address, res) \
+    if (address > C8_MEMORY_END(context)) { raise_fault(context, C8_REFUSED_MEM_ACCESS, address); return res; }
 
-void write_memory(C8_Context *context, WORD address, BYTE data) {
-    CHECK_AUTHORIZED_MEM_ACCESS(address, "Error accessing memory", );
+// Check the whole [address, address+size) range once, callers then access it directly
+#define CHECK_AUTHORIZED_MEM_RANGE(address, size, res) \
+    if ((size_t)(address) + (size) > (size_t)C8_MEMORY_END(context) + 1) { raise_fault(context, C8_REFUSED_MEM_ACCESS, address); return res; }
 
-    context->memory[address] = data;
-}
+// Watchpoints are only looked up while armed. Call after the access.
+#define CHECK_WATCH(address, size, access) \
+    if (context->debugger != NULL && (context->debugger->armed & (access))) check_watch(context, address, size, access)
 
-int read_memory(C8_Context *context, WORD address) {
-    CHECK_AUTHORIZED_MEM_ACCESS(address, "Error reading memory", 0)
-    
-    return context->memory[address];
-}
+C8_COLD static void check_watch(C8_Context *context, WORD address, size_t size, int access);
 
 /* Error handling */
 C8_Error C8_GetError(C8_Context *context) { return context->m_error; }
 void     C8_SetError(C8_Context *context, C8_Error error) { context->m_error = error; }
-void     C8_ClearError(C8_Context *context) { C8_SetError(context, (C8_Error){ C8_GOOD, "" }); }
+void     C8_ClearError(C8_Context *context) { SET_ERROR(C8_GOOD); }
+
+int C8_Resume(C8_Context *context) {
+    if (context->m_error.err == C8_EXIT) return -1;
+
+    // a fault never happens during a FX0A wait, don't end one
+    if (context->m_error.err != C8_GOOD && context->m_on_set_key == NULL) context->is_running = 1;
+    C8_ClearError(context);
+
+    return 0;
+}
+
+const char *C8_ErrorString(C8_ErrorEnum err) {
+    static const char *const names[] = {
+        "no error", "stack overflow", "stack underflow", "refused memory access", "cannot open file",
+        "cannot read file", "cannot open config", "program too large", "invalid opcode", "clear screen",
+        "exit", "watchpoint"
+    };
+
+    return ((unsigned)err < sizeof names / sizeof names[0]) ? names[err] : "unknown error";
+}
 
 /* Setup */
 
-void C8_Reset(C8_Context *context, C8_Beeper *beeper) {
-    context->memory         = (BYTE*)calloc(MEMORY_SIZE_IN_BYTES, sizeof(BYTE));
-    context->registers      = (BYTE*)calloc(REGISTER_COUNT, sizeof(BYTE));
-    context->display        = (BYTE*)calloc(SCREEN_BUFFER_SIZE_IN_BITS, sizeof(BYTE));
-    context->sp             = USER_MEMORY_END + 1;
+// Power-on state over allocated buffers
+static void reset_state(C8_Context *context, C8_Beeper *beeper) {
+    context->hires          = 0;
+    context->planes         = 0x1;
+    context->pitch          = DEFAULT_PITCH;
+    context->code_state     = C8_CODE_WRITTEN;
+    context->debugger       = NULL;
+    context->cycles         = 0;
+    context->last_opcode    = 0;
+    context->rng            = DEFAULT_SEED;
     context->pc             = USER_MEMORY_START;
     context->addressI       = 0;
     context->delay_timer    = 0;
     context->sound_timer    = 0;
-    context->m_error        = (C8_Error){ C8_GOOD, "" };
-    context->config         = (C8_Config){ DEFAULT_WRAPY };
+    context->m_error        = (C8_Error){ C8_GOOD, 0, 0, 0 };
+    context->config         = (C8_Config){ DEFAULT_WRAPY, 0 };
+    context->sp             = C8_STACK_START(context);
     context->m_on_set_key   = NULL;
     context->is_running     = 1;
     context->beeper         = beeper;
 
-    // preset keys to 0
-    memset(context->m_keys, 0, sizeof context->m_keys);
+    // preset keys and flags to 0
+    context->m_keys = 0;
+    memset(context->rpl, 0, sizeof context->rpl);
+    memset(context->audio_pattern, 0, sizeof context->audio_pattern);
 
-    // preload font
+    // preload fonts
     memcpy((void*)context->memory, (void*)font, sizeof font / sizeof font[0]);
+    memcpy((void*)&context->memory[BIG_FONT_START], (void*)big_font, sizeof big_font / sizeof big_font[0]);
+}
+
+void C8_Reset(C8_Context *context, C8_Beeper *beeper) {
+    context->memory         = (BYTE*)calloc(MEMORY_SIZE_IN_BYTES + sizeof(WORD), sizeof(BYTE));   // slack for a fetch at 0xFFFF
+    context->registers      = (BYTE*)calloc(REGISTER_COUNT, sizeof(BYTE));
+    context->display        = (uint64_t*)calloc(SCREEN_PLANE_COUNT * SCREEN_BUFFER_SIZE_IN_WORDS, sizeof(uint64_t));
+    context->fusion         = (BYTE*)calloc(MEMORY_SIZE_IN_BYTES, sizeof(BYTE));
+
+    reset_state(context, beeper);
+}
+
+void C8_Restart(C8_Context *context) {
+    memset(context->memory, 0, MEMORY_SIZE_IN_BYTES + sizeof(WORD));
+    memset(context->registers, 0, REGISTER_COUNT);
+    memset(context->display, 0, SCREEN_PLANE_COUNT * SCREEN_BUFFER_SIZE_IN_WORDS * sizeof(uint64_t));
+    memset(context->fusion, 0, MEMORY_SIZE_IN_BYTES);
+
+    // breakpoints belong to the previous program
+    free(context->debugger);
+
+    reset_state(context, context->beeper);
 }
 
 void C8_Destroy(C8_Context *context) {
     free(context->memory);
     free(context->registers);
     free(context->display);
+    free(context->fusion);
+    free(context->debugger);
+}
+
+// The image is in place at USER_MEMORY_START, clear what it leaves of the user area
+static void finish_load(C8_Context *context, size_t size) {
+    size_t user_memory_size = C8_MEMORY_END(context) - USER_MEMORY_START;
+
+    // the stack location depends on the memory layout of the configured variant
+    context->sp = C8_STACK_START(context);
+
+    memset((void*)(context->memory + USER_MEMORY_START + size), 0, user_memory_size - size);
+
+    context->code_state = (context->debugger != NULL) ? C8_CODE_MODIFIED : C8_CODE_WRITTEN;
+
+    // zeros match no superinstruction, only the image is scanned unless breakpoints tag the rest
+    memset((void*)(context->fusion + USER_MEMORY_START + size), 0, user_memory_size - size);
+    C8_InvalidateCode(context, USER_MEMORY_START, (context->debugger != NULL) ? user_memory_size : size);
 }
 
 int C8_LoadProgram(C8_Context *context, const char *path) {
     FILE *fp;
-    size_t sz;
-    int filenameStart;
+    long sz;
+    size_t user_memory_size = C8_MEMORY_END(context) - USER_MEMORY_START;
 
     fp = fopen(path, "rb");
     if (fp == NULL) {
@@ -79,46 +149,619 @@ int C8_LoadProgram(C8_Context *context, const char *path) {
         return -1;
     }
     
-    fseek(fp, 0L, SEEK_END);
-    sz = ftell(fp);
-    fseek(fp, 0L, SEEK_SET);
+    if (fseek(fp, 0L, SEEK_END) != 0 || (sz = ftell(fp)) < 0 || fseek(fp, 0L, SEEK_SET) != 0) {
+        SET_ERROR(C8_LOAD_CANNOT_READ_FILE);
+        fclose(fp);
+        return -1;
+    }
 
-    if (sz > USER_MEMORY_SIZE_IN_BYTES) {
+    if ((size_t)sz > user_memory_size) {
         SET_ERROR(C8_LOAD_MEMORY_BUFFER_TOO_LARGE);
         fclose(fp);
         return -1;
     }
 
-    memset((void*)(context->memory + USER_MEMORY_START), 0, USER_MEMORY_SIZE_IN_BYTES);
-    fread((void*)(context->memory + USER_MEMORY_START), sz, 1, fp);
+    if (fread((void*)(context->memory + USER_MEMORY_START), 1, sz, fp) != (size_t)sz) {
+        SET_ERROR(C8_LOAD_CANNOT_READ_FILE);
+        fclose(fp);
+        return -1;
+    }
     
     fclose(fp);
+    finish_load(context, sz);
+
+    return 0;
+}
+
+int C8_LoadRom(C8_Context *context, const BYTE *rom, size_t size) {
+    size_t user_memory_size = C8_MEMORY_END(context) - USER_MEMORY_START;
+
+    if (size > user_memory_size) {
+        SET_ERROR(C8_LOAD_MEMORY_BUFFER_TOO_LARGE);
+        return -1;
+    }
+
+    memcpy((void*)(context->memory + USER_MEMORY_START), rom, size);
+    finish_load(context, size);
 
     return 0;
 }
 
+void C8_Seed(C8_Context *context, uint32_t seed) {
+    context->rng = seed ? seed : DEFAULT_SEED;     // xorshift state must not be 0
+}
+
+/* XXH64 with a zero seed, input read as little endian so hashes match across hosts */
+
+#define XXH_PRIME64_1 0x9E3779B185EBCA87ull
+#define XXH_PRIME64_2 0xC2B2AE3D27D4EB4Full
+#define XXH_PRIME64_3 0x165667B19E3779F9ull
+#define XXH_PRIME64_4 0x85EBCA77C2B2AE63ull
+#define XXH_PRIME64_5 0x27D4EB2F165667C5ull
+
+#define XXH_ROTL64(x, r) (((x) << (r)) | ((x) >> (64 - (r))))
+
+static inline uint64_t xxh_read64(const BYTE *p) {
+    return (uint64_t)p[0]       | (uint64_t)p[1] << 8  | (uint64_t)p[2] << 16 | (uint64_t)p[3] << 24 |
+           (uint64_t)p[4] << 32 | (uint64_t)p[5] << 40 | (uint64_t)p[6] << 48 | (uint64_t)p[7] << 56;
+}
+
+static inline uint64_t xxh_read32(const BYTE *p) {
+    return (uint64_t)p[0] | (uint64_t)p[1] << 8 | (uint64_t)p[2] << 16 | (uint64_t)p[3] << 24;
+}
+
+static inline uint64_t xxh_round(uint64_t acc, uint64_t input) {
+    acc += input * XXH_PRIME64_2;
+    acc  = XXH_ROTL64(acc, 31);
+    return acc * XXH_PRIME64_1;
+}
+
+static inline uint64_t xxh_merge(uint64_t acc, uint64_t lane) {
+    acc ^= xxh_round(0, lane);
+    return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+uint64_t C8_Hash(const void *data, size_t size) {
+    const BYTE *p   = (const BYTE*)data;
+    const BYTE *end = p + size;
+    uint64_t    h;
+
+    if (size >= 32) {
+        uint64_t v1 = XXH_PRIME64_1 + XXH_PRIME64_2;
+        uint64_t v2 = XXH_PRIME64_2;
+        uint64_t v3 = 0;
+        uint64_t v4 = -XXH_PRIME64_1;
+
+        // four independent lanes of 8 bytes
+        for (; p + 32 <= end; p += 32) {
+            v1 = xxh_round(v1, xxh_read64(p));
+            v2 = xxh_round(v2, xxh_read64(p + 8));
+            v3 = xxh_round(v3, xxh_read64(p + 16));
+            v4 = xxh_round(v4, xxh_read64(p + 24));
+        }
+
+        h = XXH_ROTL64(v1, 1) + XXH_ROTL64(v2, 7) + XXH_ROTL64(v3, 12) + XXH_ROTL64(v4, 18);
+        h = xxh_merge(h, v1);
+        h = xxh_merge(h, v2);
+        h = xxh_merge(h, v3);
+        h = xxh_merge(h, v4);
+    } else {
+        h = XXH_PRIME64_5;
+    }
+
+    h += (uint64_t)size;
+
+    for (; p + 8 <= end; p += 8) {
+        h ^= xxh_round(0, xxh_read64(p));
+        h  = XXH_ROTL64(h, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+    }
+
+    if (p + 4 <= end) {
+        h ^= xxh_read32(p) * XXH_PRIME64_1;
+        h  = XXH_ROTL64(h, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        p += 4;
+    }
+
+    for (; p < end; ++p) {
+        h ^= *p * XXH_PRIME64_5;
+        h  = XXH_ROTL64(h, 11) * XXH_PRIME64_1;
+    }
+
+    // avalanche
+    h ^= h >> 33;
+    h *= XXH_PRIME64_2;
+    h ^= h >> 29;
+    h *= XXH_PRIME64_3;
+    h ^= h >> 32;
+
+    return h;
+}
+
+/* Save states */
+
+// Everything but the buffers, which are saved after it
+typedef struct {
+    WORD                  sp;
+    WORD                  addressI;
+    WORD                  pc;
+    BYTE                  delay_timer;
+    BYTE                  sound_timer;
+    C8_Error              m_error;
+    C8_Config             config;
+    WORD                  m_keys;
+    C8_KeyChangeNotifier  m_on_set_key;
+    int                   is_running;
+    WORD                  last_opcode;
+    int                   hires;
+    int                   planes;
+    BYTE                  rpl[RPL_FLAG_COUNT];
+    BYTE                  audio_pattern[AUDIO_PATTERN_SIZE_IN_BYTES];
+    BYTE                  pitch;
+    uint64_t              cycles;
+    uint32_t              rng;
+} C8_StateHeader;
+
+#define STATE_DISPLAY_SIZE_IN_BYTES (SCREEN_PLANE_COUNT * SCREEN_BUFFER_SIZE_IN_WORDS * sizeof(uint64_t))
+#define STATE_MEMORY_BLOCK          64                                // granularity of the loaded memory diff
+
+// Memory is saved up to the end of the stack of the configured variant
+static size_t state_memory_size(const C8_Context *context) {
+    return C8_STACK_END(context) + 1;
+}
+
+size_t C8_StateSize(const C8_Context *context) {
+    return sizeof(C8_StateHeader) + REGISTER_COUNT + STATE_DISPLAY_SIZE_IN_BYTES + state_memory_size(context);
+}
+
+void C8_SaveState(const C8_Context *context, void *buffer) {
+    C8_StateHeader *header = (C8_StateHeader*)buffer;
+    BYTE           *data   = (BYTE*)buffer + sizeof(C8_StateHeader);
+
+    header->sp             = context->sp;
+    header->addressI       = context->addressI;
+    header->pc             = context->pc;
+    header->delay_timer    = context->delay_timer;
+    header->sound_timer    = context->sound_timer;
+    header->m_error        = context->m_error;
+    header->config         = context->config;
+    header->m_on_set_key   = context->m_on_set_key;
+    header->is_running     = context->is_running;
+    header->last_opcode    = context->last_opcode;
+    header->hires          = context->hires;
+    header->planes         = context->planes;
+    header->pitch          = context->pitch;
+    header->cycles         = context->cycles;
+    header->rng            = context->rng;
+    header->m_keys         = context->m_keys;
+    memcpy(header->rpl, context->rpl, sizeof context->rpl);
+    memcpy(header->audio_pattern, context->audio_pattern, sizeof context->audio_pattern);
+
+    memcpy(data, context->registers, REGISTER_COUNT);                         data += REGISTER_COUNT;
+    memcpy(data, context->display, STATE_DISPLAY_SIZE_IN_BYTES);              data += STATE_DISPLAY_SIZE_IN_BYTES;
+    memcpy(data, context->memory, state_memory_size(context));
+}
+
+// Range of the memory that differs from the state, compared STATE_MEMORY_BLOCK bytes at a time
+static void changed_memory(const C8_Context *context, const BYTE *data, size_t size, size_t *first, size_t *last) {
+    size_t begin = 0;
+    size_t end   = size;
+
+    while (begin < end) {
+        size_t n = (end - begin < STATE_MEMORY_BLOCK) ? end - begin : STATE_MEMORY_BLOCK;
+
+        if (memcmp(context->memory + begin, data + begin, n) != 0) break;
+        begin += n;
+    }
+    while (end > begin) {
+        size_t n = (end % STATE_MEMORY_BLOCK) ? end % STATE_MEMORY_BLOCK : STATE_MEMORY_BLOCK;
+
+        if (memcmp(context->memory + end - n, data + end - n, n) != 0) break;
+        end -= n;
+    }
+
+    *first = begin;
+    *last  = end;
+}
+
+void C8_LoadState(C8_Context *context, const void *buffer) {
+    const C8_StateHeader *header = (const C8_StateHeader*)buffer;
+    const BYTE           *data   = (const BYTE*)buffer + sizeof(C8_StateHeader);
+    int                   layout = (context->config.xochip == header->config.xochip);
+    size_t                first, last;
+
+    context->sp             = header->sp;
+    context->addressI       = header->addressI;
+    context->pc             = header->pc;
+    context->delay_timer    = header->delay_timer;
+    context->sound_timer    = header->sound_timer;
+    context->m_error        = header->m_error;
+    context->config         = header->config;
+    context->m_on_set_key   = header->m_on_set_key;
+    context->is_running     = header->is_running;
+    context->last_opcode    = header->last_opcode;
+    context->hires          = header->hires;
+    context->planes         = header->planes;
+    context->pitch          = header->pitch;
+    context->cycles         = header->cycles;
+    context->rng            = header->rng;
+    context->m_keys         = header->m_keys;
+    memcpy(context->rpl, header->rpl, sizeof context->rpl);
+    memcpy(context->audio_pattern, header->audio_pattern, sizeof context->audio_pattern);
+
+    memcpy(context->registers, data, REGISTER_COUNT);                         data += REGISTER_COUNT;
+    memcpy(context->display, data, STATE_DISPLAY_SIZE_IN_BYTES);              data += STATE_DISPLAY_SIZE_IN_BYTES;
+
+    // branching searches load sibling states over and over, only what changed is re-tagged
+    if (!layout) {
+        first = 0;
+        last  = state_memory_size(context);
+    } else {
+        changed_memory(context, data, state_memory_size(context), &first, &last);
+    }
+    if (first == last) return;
+
+    memcpy(context->memory + first, data + first, last - first);
+
+    // pre-decoded state follows the restored memory
+    context->code_state = (context->debugger != NULL) ? C8_CODE_MODIFIED : C8_CODE_WRITTEN;
+    if (first < USER_MEMORY_START) first = USER_MEMORY_START;
+    if (last > C8_MEMORY_END(context)) last = C8_MEMORY_END(context);
+    if (first < last) C8_InvalidateCode(context, (WORD)first, last - first);
+}
+
+/* Superinstructions */
+
+typedef enum {
+    C8_FUSE_NONE,
+    C8_FUSE_ANNN_DXYN,      // sprite draw
+    C8_FUSE_6XNN_6YNN,      // register setup pair
+    C8_FUSE_TIMER_POLL,     // FX07 + 3X00 + 1NNN
+    C8_FUSE_BREAK,          // armed PC breakpoint, see break_at_pc
+    C8_FUSE_COUNT
+} C8_Fusion;
+
+// Number of instructions covered by each superinstruction
+static const int fusion_length[C8_FUSE_COUNT] = { 1, 2, 2, 3, 0 };
+
+#define OPCODE_AT(address) ((WORD)((context->memory[address] << 8) | context->memory[(address) + 1]))
+
+static BYTE match_fusion(C8_Context *context, int address) {
+    WORD a = OPCODE_AT(address);
+    WORD b = OPCODE_AT(address + 2);
+    WORD c = OPCODE_AT(address + 4);
+
+    if (context->debugger != NULL) {
+        const BYTE *map = context->debugger->map;
+
+        if (map[address] & C8_BREAK_EXEC)
+            return C8_FUSE_BREAK;
+        // a sequence must not run over a breakpoint or read a watched sprite
+        if ((map[address + 2] | map[address + 4]) & C8_BREAK_EXEC)
+            return C8_FUSE_NONE;
+        if ((a & 0xF000) == 0xA000 && (context->debugger->armed & C8_BREAK_READ))
+            return C8_FUSE_NONE;
+    }
+
+    if ((a & 0xF000) == 0xA000 && (b & 0xF000) == 0xD000)
+        return C8_FUSE_ANNN_DXYN;
+    if ((a & 0xF000) == 0x6000 && (b & 0xF000) == 0x6000)
+        return C8_FUSE_6XNN_6YNN;
+    if ((a & 0xF0FF) == 0xF007 && (b & 0xFFFF) == (0x3000 | (a & 0x0F00)) && (c & 0xF000) == 0x1000)
+        return C8_FUSE_TIMER_POLL;
+
+    return C8_FUSE_NONE;
+}
+
+// Superinstructions are keyed by their first address only. Jumping or skipping into
+// the middle of a sequence runs the following instructions one by one.
+void C8_InvalidateCode(C8_Context *context, WORD address, size_t size) {
+    // a sequence starting up to 5 bytes before may cover the written range
+    int start = (address > USER_MEMORY_START + 5) ? address - 5 : USER_MEMORY_START;
+    int end   = address + (int)size;
+
+    if (end > C8_MEMORY_END(context) - 5) end = C8_MEMORY_END(context) - 5;
+
+    if (context->code_state == C8_CODE_VERIFIED) context->code_state = C8_CODE_WRITTEN;
+
+    for (int i = start; i < end; ++i) {
+        context->fusion[i] = match_fusion(context, i);
+    }
+}
+
+// Record the fault of the instruction before pc and stop the program
+C8_COLD static void raise_fault(C8_Context *context, C8_ErrorEnum err, WORD address) {
+    WORD pc = context->pc - 2;
+
+    context->m_error    = (C8_Error){ err, pc, OPCODE_AT(pc), address };
+    context->is_running = 0;
+}
+
+static void report_fault(C8_Context *context) {
+    const C8_Error *fault = &context->m_error;
+
+    fprintf(stderr, "c8_decode Error(%d): %s at %04x(%04x), address %04x\n",
+            fault->err, C8_ErrorString(fault->err), fault->pc, fault->opcode, fault->address);
+}
+
+// Run the superinstruction at pc. Return started instructions count, a fault stops at its instruction.
+static int run_fused(C8_Context *context, BYTE fusion, int budget) {
+    WORD opcode;
+    int  executed;
+
+    switch (fusion) {
+        case C8_FUSE_ANNN_DXYN:
+            opcode = OPCODE_AT(context->pc);
+            INCREMENENT_PC;
+            C8_OpcodeANNN(context, opcode);
+            if (!context->is_running) { context->last_opcode = opcode; return 1; }
+
+            opcode = OPCODE_AT(context->pc);
+            INCREMENENT_PC;
+            if (C8_OPCODE_SELECT_N(opcode)) C8_OpcodeDXYN(context, opcode);
+            else                            C8_OpcodeDXY0(context, opcode);
+
+            context->last_opcode = opcode;
+            return 2;
+
+        case C8_FUSE_6XNN_6YNN:
+            opcode = OPCODE_AT(context->pc + 2);
+            context->registers[C8_OPCODE_SELECT_X(OPCODE_AT(context->pc))] = C8_OPCODE_SELECT_NN(OPCODE_AT(context->pc));
+            context->registers[C8_OPCODE_SELECT_X(opcode)]                 = C8_OPCODE_SELECT_NN(opcode);
+            context->pc += 4;
+
+            context->last_opcode = opcode;
+            return 2;
+
+        case C8_FUSE_TIMER_POLL: {
+            WORD start = context->pc;
+            WORD nnn   = C8_OPCODE_SELECT_NNN(OPCODE_AT(start + 4));
+            int  X     = C8_OPCODE_SELECT_X(OPCODE_AT(start));
+
+            VX = context->delay_timer;
+
+            if (VX == 0) {
+                // 3X00 skips the jump
+                context->pc = start + 6;
+                context->last_opcode = OPCODE_AT(start + 2);
+                return 2;
+            }
+
+            if (nnn > C8_MEMORY_END(context)) {
+                context->pc = start + 6;
+                raise_fault(context, C8_REFUSED_MEM_ACCESS, nnn);
+                context->last_opcode = OPCODE_AT(start + 4);
+                return 3;
+            }
+
+            // Busy wait on the delay timer: it only changes between batches, so every
+            // remaining iteration of the loop is identical
+            executed = 3;
+            if (nnn == start) executed = (budget / 3) * 3;
+
+            context->pc = nnn;
+            context->last_opcode = OPCODE_AT(start + 4);
+            return executed;
+        }
+
+        default:
+            assert(0);
+            return -1;
+    }
+}
+
+/* Breakpoints */
+
+// Rebuild the address map and the tags after a change, free everything once the last one is removed
+static void arm_breakpoints(C8_Context *context) {
+    C8_Debugger *debugger = context->debugger;
+    int          count    = 0;
+
+    memset(debugger->map, 0, sizeof debugger->map);
+    debugger->armed = 0;
+
+    for (int id = 0; id < MAX_BREAKPOINTS; ++id) {
+        const C8_Breakpoint *bp = &debugger->breakpoints[id];
+        if (bp->access == 0) continue;
+
+        for (size_t i = bp->address; i < (size_t)bp->address + bp->size && i < MEMORY_SIZE_IN_BYTES; ++i) {
+            debugger->map[i] |= bp->access;
+        }
+        debugger->armed |= bp->access;
+        ++count;
+    }
+
+    if (count == 0) {
+        free(debugger);
+        context->debugger = NULL;
+    }
+
+    // code compiled ahead of time doesn't check breakpoints, interpret while any is set
+    context->code_state = (context->debugger != NULL) ? C8_CODE_MODIFIED : C8_CODE_WRITTEN;
+    C8_InvalidateCode(context, USER_MEMORY_START, C8_MEMORY_END(context) - USER_MEMORY_START);
+}
+
+int C8_AddBreakpoint(C8_Context *context, const C8_Breakpoint *breakpoint) {
+    if (breakpoint->access == 0 || breakpoint->size == 0) return -1;
+
+    if (context->debugger == NULL) {
+        context->debugger = (C8_Debugger*)calloc(1, sizeof(C8_Debugger));
+        if (context->debugger == NULL) return -1;
+    }
+
+    for (int id = 0; id < MAX_BREAKPOINTS; ++id) {
+        if (context->debugger->breakpoints[id].access == 0) {
+            context->debugger->breakpoints[id] = *breakpoint;
+            arm_breakpoints(context);
+            return id;
+        }
+    }
+
+    return -1;
+}
+
+void C8_RemoveBreakpoint(C8_Context *context, int id) {
+    if (context->debugger == NULL || id < 0 || id >= MAX_BREAKPOINTS) return;
+
+    context->debugger->breakpoints[id].access = 0;
+    arm_breakpoints(context);
+}
+
+void C8_ClearBreakpoints(C8_Context *context) {
+    if (context->debugger == NULL) return;
+
+    memset(context->debugger->breakpoints, 0, sizeof context->debugger->breakpoints);
+    arm_breakpoints(context);
+}
+
+const C8_BreakHit *C8_GetBreakHit(const C8_Context *context) {
+    return (context->debugger != NULL && context->debugger->hits != 0) ? &context->debugger->hit : NULL;
+}
+
+static int condition_holds(const C8_Context *context, const C8_Condition *condition) {
+    WORD value;
+
+    if (condition->op == C8_COND_ALWAYS) return 1;
+
+    value = (condition->reg == C8_COND_REG_I) ? context->addressI : context->registers[condition->reg & 0xF];
+
+    switch (condition->op) {
+        case C8_COND_EQ:    return value == condition->value;
+        case C8_COND_NE:    return value != condition->value;
+        case C8_COND_LT:    return value <  condition->value;
+        case C8_COND_GT:    return value >  condition->value;
+        default:            return 1;
+    }
+}
+
+// First breakpoint with `access` on [address, address+size) whose condition holds, -1 if none
+static int find_breakpoint(C8_Context *context, WORD address, size_t size, int access) {
+    for (int id = 0; id < MAX_BREAKPOINTS; ++id) {
+        const C8_Breakpoint *bp = &context->debugger->breakpoints[id];
+
+        if ((bp->access & access) &&
+            address < bp->address + bp->size && bp->address < address + size &&
+            condition_holds(context, &bp->condition)) {
+            return id;
+        }
+    }
+
+    return -1;
+}
+
+static void record_hit(C8_Context *context, int id, int access, WORD pc, WORD address) {
+    C8_BreakHit hit = { id, access, pc, address, context->cycles };
+
+    context->debugger->hit = hit;
+    ++context->debugger->hits;
+}
+
+int C8_AtBreakpoint(C8_Context *context) {
+    if (context->debugger == NULL || !(context->debugger->map[context->pc] & C8_BREAK_EXEC)) return -1;
+
+    return find_breakpoint(context, context->pc, 1, C8_BREAK_EXEC);
+}
+
+// Reached through a C8_FUSE_BREAK tag. Return non-zero to stop before the instruction at pc.
+C8_COLD static int break_at_pc(C8_Context *context) {
+    const C8_BreakHit *hit = &context->debugger->hit;
+    int                id;
+
+    // resuming from the stop just reported
+    if (context->debugger->hits != 0 && hit->access == C8_BREAK_EXEC && hit->pc == context->pc && hit->cycle == context->cycles) {
+        return 0;
+    }
+
+    if ((id = C8_AtBreakpoint(context)) < 0) return 0;
+
+    record_hit(context, id, C8_BREAK_EXEC, context->pc, context->pc);
+    return 1;
+}
+
+// The instruction completes, then the program stops on C8_BREAK
+C8_COLD static void check_watch(C8_Context *context, WORD address, size_t size, int access) {
+    int id;
+
+    for (size_t i = 0; i < size; ++i) {
+        if (!(context->debugger->map[address + i] & access)) continue;
+
+        if ((id = find_breakpoint(context, address + i, 1, access)) >= 0) {
+            record_hit(context, id, access, context->pc - 2, address + i);
+            ++context->debugger->hit.cycle;         // counted once the instruction completes
+            raise_fault(context, C8_BREAK, address + i);
+            return;
+        }
+    }
+}
+
 /* Fetch-decode */
 
+// Cold path of C8_Tick and C8_Run once the program stopped on m_error. A watchpoint resumes
+// at once, its hit is kept for the debugger. Return 0 on exit or watchpoint, -1 on error.
+C8_COLD static int stop_on_fault(C8_Context *context, int raised) {
+    switch (context->m_error.err) {
+        case C8_EXIT:
+            return 0;
+
+        case C8_BREAK:
+            C8_Resume(context);
+            return 0;
+
+        default:
+            if (raised) report_fault(context);      // reported once
+            return -1;
+    }
+}
+
 int C8_Tick(C8_Context *context) {
     WORD opcode;
-    C8_Error err;
 
     if (!context->is_running) {
-        return context->last_opcode;
+        return (context->m_error.err == C8_GOOD) ? context->last_opcode : stop_on_fault(context, 0);
     }
 
     opcode = C8_Fetch(context);
     C8_Decode(context, opcode);
 
-    if ((err = C8_GetError(context)).err != C8_GOOD) {
-        fprintf(stderr, "c8_decode Error(%d): %s at %04x(%04x)\n", err.err, err.msg, context->pc, opcode);
-        return -1;
-    }
-
     context->last_opcode = opcode;
+    ++context->cycles;
+
+    if (!context->is_running && context->m_error.err != C8_GOOD) return stop_on_fault(context, 1);
     return opcode;
 }
 
+// Faults stop the program, so the loop only tests is_running and m_error is looked at once
+int C8_Run(C8_Context *context, int cycles) {
+    int executed = 0;
+
+    while (executed < cycles && context->is_running) {
+        BYTE fusion = context->fusion[context->pc];
+        WORD opcode;
+
+        // a superinstruction needs room for all its instructions, single steps never fuse
+        if (fusion != C8_FUSE_NONE && fusion_length[fusion] <= cycles - executed) {
+            // armed PC breakpoints are tagged like superinstructions, so unarmed runs pay nothing
+            if (fusion == C8_FUSE_BREAK) {
+                if (break_at_pc(context)) break;
+            } else {
+                int rv = run_fused(context, fusion, cycles - executed);
+                executed += rv;
+                context->cycles += rv;
+                continue;
+            }
+        }
+
+        opcode = C8_Fetch(context);
+        C8_Decode(context, opcode);
+
+        context->last_opcode = opcode;
+        ++context->cycles;
+        ++executed;
+    }
+
+    if (!context->is_running && context->m_error.err != C8_GOOD && stop_on_fault(context, executed > 0) < 0) return -1;
+    return executed;
+}
+
 void C8_UpdateTimers(C8_Context *context) {
     if (context->delay_timer) --context->delay_timer;
     if (context->sound_timer) {
@@ -136,42 +779,208 @@ WORD C8_Fetch(C8_Context *context) {
     return res;
 }
 
-C8_DECODE_FUNC_GEN(C8_Decode_Internal, C8_Context*, C8_Opcode)
+C8_DECODE_FUNC_GEN(C8_Decode_Internal, C8_Context*, C8_Opcode, context->config.xochip)
 
 void C8_Decode(C8_Context *context, WORD opcode) {
-    #define SET_INVALID_OPCODE_ERROR(s) SET_ERROR(C8_DECODE_INVALID_OPCODE, s)
-
-    int rv = C8_Decode_Internal(context, opcode);
-
-    if(rv != 0) {
-        char s[5];
-        snprintf(s, 5, "%04x", rv);
-        SET_INVALID_OPCODE_ERROR(s);
+    if (C8_Decode_Internal(context, opcode) != 0) {
+        raise_fault(context, C8_DECODE_INVALID_OPCODE, context->pc - 2);
     }
 }
 
 /* Key handling */
 void C8_SetKey(C8_Context *context, int key)   { 
-    context->m_keys[key] = 1; 
+    context->m_keys |= 1 << key;
 
     if (context->m_on_set_key != NULL) {
         context->m_on_set_key(context, key);
     }
 }
 
-void C8_UnsetKey(C8_Context *context, int key) { context->m_keys[key] = 0; }
+void C8_UnsetKey(C8_Context *context, int key) { context->m_keys &= ~(1 << key); }
+
+void C8_SetKeys(C8_Context *context, WORD keys) {
+    WORD pressed = keys & ~context->m_keys;
+
+    context->m_keys = keys;
+
+    // a FX0A wait ends on the lowest newly pressed key
+    for (int key = 0; pressed != 0 && context->m_on_set_key != NULL; ++key, pressed >>= 1) {
+        if (pressed & 1) context->m_on_set_key(context, key);
+    }
+}
+
+/* Display */
+
+// XOR a sprite row, left-aligned in `bits`, at column x of row py. Return non-zero on collision.
+static uint64_t draw_sprite_row(C8_Context *context, uint64_t *row, uint64_t bits, int x) {
+    uint64_t  lo, hi, hit;
+
+    if (!context->hires) {
+        // lores rows live in the first word: rotate within the 64 pixels ring
+        lo = x ? (bits >> x) | (bits << (64 - x)) : bits;
+        hit = row[0] & lo;
+        row[0] ^= lo;
+        return hit;
+    }
+
+    // hires rows span two words: shift the sprite across the 128 pixels ring
+    if (x < 64) {
+        lo = bits >> x;
+        hi = x ? bits << (64 - x) : 0;
+    } else {
+        hi = bits >> (x - 64);
+        lo = x > 64 ? bits << (128 - x) : 0;
+    }
+
+    hit = (row[0] & lo) | (row[1] & hi);
+    row[0] ^= lo;
+    row[1] ^= hi;
+    return hit;
+}
+
+// Draw `height` rows of a `width` pixels wide sprite (8 or 16) read from I at (VX, VY).
+// With several planes selected, the data of each plane follows the previous one.
+static void draw_sprite(C8_Context *context, int x, int y, int width, int height) {
+    int         py;
+    int         bytes_per_row   = width / 8;
+    int         selected_planes = (context->planes & 1) + ((context->planes >> 1) & 1);
+    uint64_t    collision       = 0;
+    const BYTE *data;
+
+    CHECK_AUTHORIZED_MEM_RANGE(context->addressI, selected_planes * height * bytes_per_row,);
+    data = &context->memory[context->addressI];
+
+    x %= C8_DISPLAY_WIDTH(context);
+
+    for (int plane = 0; plane < SCREEN_PLANE_COUNT; ++plane) {
+        if (!(context->planes & (1 << plane))) continue;
+
+        const BYTE *plane_data = data;
+        data += height * bytes_per_row;
+
+        for (int row = 0; row < height; ++row, plane_data += bytes_per_row) {
+            uint64_t bits = (bytes_per_row == 1) ? plane_data[0] : (plane_data[0] << 8) | plane_data[1];
+
+            py = (y + row);
+
+            if (context->config.wrapy) {
+                py %= C8_DISPLAY_HEIGHT(context);
+            } else if (py >= C8_DISPLAY_HEIGHT(context)) {
+                break;
+            }
+
+            collision |= draw_sprite_row(context, C8_PLANE_ROW(context, plane, py), bits << (64 - width), x);
+        }
+    }
+
+    VF = (collision != 0);
+    CHECK_WATCH(context->addressI, selected_planes * height * bytes_per_row, C8_BREAK_READ);
+}
+
+static void clear_planes(C8_Context *context, int planes) {
+    for (int plane = 0; plane < SCREEN_PLANE_COUNT; ++plane) {
+        if (planes & (1 << plane))
+            memset((void*)C8_PLANE(context, plane), 0, SCREEN_BUFFER_SIZE_IN_WORDS * sizeof(uint64_t));
+    }
+}
+
+// Move whole rows of the selected planes: n > 0 scrolls down, n < 0 scrolls up
+static void scroll_vertical(C8_Context *context, int n) {
+    int height = C8_DISPLAY_HEIGHT(context);
+    int count  = n < 0 ? -n : n;
+
+    if (count > height) count = height;
+
+    for (int plane = 0; plane < SCREEN_PLANE_COUNT; ++plane) {
+        if (!(context->planes & (1 << plane))) continue;
+
+        uint64_t *top    = C8_PLANE_ROW(context, plane, 0);
+        size_t    kept   = (height - count) * SCREEN_ROW_WORDS * sizeof(uint64_t);
+        size_t    erased = count * SCREEN_ROW_WORDS * sizeof(uint64_t);
+
+        if (n > 0) {
+            memmove(C8_PLANE_ROW(context, plane, count), top, kept);
+            memset(top, 0, erased);
+        } else {
+            memmove(top, C8_PLANE_ROW(context, plane, count), kept);
+            memset(C8_PLANE_ROW(context, plane, height - count), 0, erased);
+        }
+    }
+}
+
+// Shift every row of the selected planes by 4 pixels, right if `right` else left.
+// A row is exactly 128 bits, i.e. one SSE2 register. Lores rows must keep their second word clear.
+static void scroll_horizontal(C8_Context *context, int right) {
+    int height = C8_DISPLAY_HEIGHT(context);
+
+    for (int plane = 0; plane < SCREEN_PLANE_COUNT; ++plane) {
+        if (!(context->planes & (1 << plane))) continue;
+
+        uint64_t *row = C8_PLANE(context, plane);
+
+#if defined(__SSE2__)
+        __m128i mask = context->hires ? _mm_set1_epi32(-1) : _mm_set_epi64x(0, -1);
+
+        for (int y = 0; y < height; ++y, row += SCREEN_ROW_WORDS) {
+            __m128i v = _mm_loadu_si128((const __m128i*)row);
+
+            if (right) v = _mm_or_si128(_mm_srli_epi64(v, 4), _mm_slli_epi64(_mm_slli_si128(v, 8), 60));
+            else       v = _mm_or_si128(_mm_slli_epi64(v, 4), _mm_srli_epi64(_mm_srli_si128(v, 8), 60));
+
+            _mm_storeu_si128((__m128i*)row, _mm_and_si128(v, mask));
+        }
+#else
+        for (int y = 0; y < height; ++y, row += SCREEN_ROW_WORDS) {
+            if (right) {
+                if (context->hires) row[1] = (row[1] >> 4) | (row[0] << 60);
+                row[0] >>= 4;
+            } else {
+                row[0] = (row[0] << 4) | (row[1] >> 60);
+                row[1] <<= 4;
+            }
+        }
+#endif
+    }
+}
 
 /* Instructions */
 
+void C8_Opcode00CN(C8_Context *context, WORD opcode) {
+    scroll_vertical(context, C8_OPCODE_SELECT_N(opcode));
+}
+
+void C8_Opcode00DN(C8_Context *context, WORD opcode) {
+    scroll_vertical(context, -C8_OPCODE_SELECT_N(opcode));
+}
+
 void C8_Opcode00E0(C8_Context *context, WORD opcode) {
-    void* rv = memset((void*)context->display, 0, SCREEN_BUFFER_SIZE_IN_BITS);
+    clear_planes(context, context->planes);
     VF = 0;
-    if (rv == NULL) SET_ERROR(C8_CLEAR_SCREEN);
+}
+
+void C8_Opcode00FB(C8_Context *context, WORD opcode) { scroll_horizontal(context, 1); }
+void C8_Opcode00FC(C8_Context *context, WORD opcode) { scroll_horizontal(context, 0); }
+
+void C8_Opcode00FD(C8_Context *context, WORD opcode) {
+    raise_fault(context, C8_EXIT, context->pc - 2);
+}
+
+void C8_Opcode00FE(C8_Context *context, WORD opcode) {
+    context->hires = 0;
+    clear_planes(context, ~0);
+}
+
+void C8_Opcode00FF(C8_Context *context, WORD opcode) {
+    context->hires = 1;
+    clear_planes(context, ~0);
 }
 
 void C8_Opcode00EE(C8_Context *context, WORD opcode) {
     // Error: Stackunderflow
-    if (context->sp == 0xEA0) SET_ERROR(C8_STACKUNDERFLOW);
+    if (context->sp <= C8_STACK_START(context)) {
+        raise_fault(context, C8_STACKUNDERFLOW, context->sp);
+        return;
+    }
 
     context->pc  =  context->memory[--context->sp];         // get lower nibble
     context->pc |= (context->memory[--context->sp] << 8);   // get upper nibble
@@ -180,14 +989,14 @@ void C8_Opcode00EE(C8_Context *context, WORD opcode) {
 void C8_Opcode1NNN(C8_Context *context, WORD opcode) {
     int nnn = C8_OPCODE_SELECT_NNN(opcode);
 
-    CHECK_AUTHORIZED_MEM_ACCESS(nnn, "Error in 1NNN",)
+    CHECK_AUTHORIZED_MEM_ACCESS(nnn,)
     context->pc = nnn;
 }
 
 void C8_Opcode2NNN(C8_Context *context, WORD opcode) {
     // Error: Stackoverflow
-    if (context->sp >= 0xEFF) {
-        SET_ERROR(C8_STACKOVERFLOW);
+    if (context->sp >= C8_STACK_END(context)) {
+        raise_fault(context, C8_STACKOVERFLOW, context->sp);
         return;
     }
 
@@ -196,6 +1005,43 @@ void C8_Opcode2NNN(C8_Context *context, WORD opcode) {
     context->pc = C8_OPCODE_SELECT_NNN(opcode);
 }
 
+void C8_Opcode5XY2(C8_Context *context, WORD opcode) {
+    BYTE *dst;
+    int   step;
+
+    C8_OPCODE_SELECT_XYN(opcode);
+
+    step = (X <= Y) ? 1 : -1;
+
+    CHECK_AUTHORIZED_MEM_RANGE(context->addressI, (Y - X) * step + 1,);
+    dst = &context->memory[context->addressI];
+
+    for (int i = X; i != Y + step; i += step) {
+        *dst++ = context->registers[i];
+    }
+
+    C8_InvalidateCode(context, context->addressI, (Y - X) * step + 1);
+    CHECK_WATCH(context->addressI, (Y - X) * step + 1, C8_BREAK_WRITE);
+}
+
+void C8_Opcode5XY3(C8_Context *context, WORD opcode) {
+    const BYTE *src;
+    int         step;
+
+    C8_OPCODE_SELECT_XYN(opcode);
+
+    step = (X <= Y) ? 1 : -1;
+
+    CHECK_AUTHORIZED_MEM_RANGE(context->addressI, (Y - X) * step + 1,);
+    src = &context->memory[context->addressI];
+
+    for (int i = X; i != Y + step; i += step) {
+        context->registers[i] = *src++;
+    }
+
+    CHECK_WATCH(context->addressI, (Y - X) * step + 1, C8_BREAK_READ);
+}
+
 void C8_Opcode8XY4(C8_Context *context, WORD opcode) {
     int res;
     
@@ -224,7 +1070,7 @@ void C8_Opcode8XYE(C8_Context *context, WORD opcode) {
 void C8_OpcodeANNN(C8_Context *context, WORD opcode) {
     WORD nnn = C8_OPCODE_SELECT_NNN(opcode);
 
-    CHECK_AUTHORIZED_MEM_ACCESS(nnn, "Error in ANNN",);
+    CHECK_AUTHORIZED_MEM_ACCESS(nnn,);
 
     context->addressI = nnn;
 }
@@ -235,7 +1081,7 @@ void C8_OpcodeBNNN(C8_Context *context, WORD opcode) {
     nnn  = C8_OPCODE_SELECT_NNN(opcode);
     nnn += context->registers[0];
 
-    CHECK_AUTHORIZED_MEM_ACCESS(nnn, "Error in BNNN",)
+    CHECK_AUTHORIZED_MEM_ACCESS(nnn,)
 
     context->pc = nnn;
 }
@@ -243,50 +1089,51 @@ void C8_OpcodeBNNN(C8_Context *context, WORD opcode) {
 void C8_OpcodeCXNN(C8_Context *context, WORD opcode) {
     C8_OPCODE_SELECT_XNN(opcode);
 
-    VX = (rand() & NN);
+    // xorshift32
+    context->rng ^= context->rng << 13;
+    context->rng ^= context->rng >> 17;
+    context->rng ^= context->rng << 5;
+
+    VX = (context->rng & NN);
 }
 
 void C8_OpcodeDXYN(C8_Context *context, WORD opcode) {
-    int x, y;
-    int px, py;
-    int addressI;
-    BYTE spritePixelRow;
+    C8_OPCODE_SELECT_XYN(opcode);
 
+    // loop through 8*N sprite
+    draw_sprite(context, VX, VY, 8, N);
+}
+
+void C8_OpcodeDXY0(C8_Context *context, WORD opcode) {
     C8_OPCODE_SELECT_XYN(opcode);
 
-    x = VX;
-    y = VY;
-    addressI = context->addressI;
+    // loop through 16*16 sprite
+    draw_sprite(context, VX, VY, 16, 16);
+}
 
-    VF = 0; // reset VF
+void C8_OpcodeF000(C8_Context *context, WORD opcode) {
+    WORD nnnn;
 
-    // loop through 8*N sprite
-    for (int row = 0; row < N; ++row) {
-        spritePixelRow = read_memory(context, context->addressI + row);   RETURN_ON_ERROR;
-         
-        py = (y + row);
-        
-        if (context->config.wrapy) {
-            py %= SCREEN_HEIGHT;
-        } else if (py >= SCREEN_HEIGHT) {
-            break;
-        }
+    CHECK_AUTHORIZED_MEM_ACCESS(context->pc + 1,);
 
-        for (int col = 0, curPixel = 0x80; col < 8; ++col, curPixel >>= 1) {
-            px = (x + col) % SCREEN_WIDTH;
-            
-            if (spritePixelRow & curPixel) {
-                int index = (py * SCREEN_WIDTH) + px;
-                assert(index < SCREEN_BUFFER_SIZE_IN_BITS);
+    nnnn  = (context->memory[context->pc] << 8);
+    nnnn |=  context->memory[context->pc + 1];
+    INCREMENENT_PC;
 
-                // check collision
-                if (context->display[index] == 1) {
-                    VF = 1;
-                }
+    context->addressI = nnnn;
+}
 
-                context->display[index] ^= 1;
-            }
-        }
+void C8_OpcodeFN01(C8_Context *context, WORD opcode) {
+    context->planes = C8_OPCODE_SELECT_X(opcode) & ((1 << SCREEN_PLANE_COUNT) - 1);
+}
+
+void C8_OpcodeF002(C8_Context *context, WORD opcode) {
+    CHECK_AUTHORIZED_MEM_RANGE(context->addressI, AUDIO_PATTERN_SIZE_IN_BYTES,);
+    memcpy((void*)context->audio_pattern, (void*)&context->memory[context->addressI], AUDIO_PATTERN_SIZE_IN_BYTES);
+    CHECK_WATCH(context->addressI, AUDIO_PATTERN_SIZE_IN_BYTES, C8_BREAK_READ);
+
+    if (context->beeper != NULL && context->beeper->pattern != NULL) {
+        context->beeper->pattern(context->beeper->user_data, context->audio_pattern, context->pitch);
     }
 }
 
@@ -317,6 +1164,16 @@ void C8_OpcodeFX18(C8_Context *context, WORD opcode) {
     }
 }
 
+void C8_OpcodeFX3A(C8_Context *context, WORD opcode) {
+    C8_OPCODE_SELECT_XNN(opcode);
+
+    context->pitch = VX;
+
+    if (context->beeper != NULL && context->beeper->pattern != NULL) {
+        context->beeper->pattern(context->beeper->user_data, context->audio_pattern, context->pitch);
+    }
+}
+
 void C8_OpcodeFX33(C8_Context *context, WORD opcode) {
     int res;
 
@@ -325,32 +1182,47 @@ void C8_OpcodeFX33(C8_Context *context, WORD opcode) {
     res = VX;
 
     BYTE bcd[] = { res/100, (res/10) % 10, res % 10 };
-    memcpy((void*)&context->memory[context->addressI], (void*)bcd, 3);
+
+    CHECK_AUTHORIZED_MEM_RANGE(context->addressI, sizeof bcd,);
+    memcpy((void*)&context->memory[context->addressI], (void*)bcd, sizeof bcd);
+    C8_InvalidateCode(context, context->addressI, sizeof bcd);
+    CHECK_WATCH(context->addressI, sizeof bcd, C8_BREAK_WRITE);
 }
 
 void C8_OpcodeFX55(C8_Context *context, WORD opcode) {
-    WORD addressI = context->addressI;
-
     C8_OPCODE_SELECT_XNN(opcode);
 
     assert(X < REGISTER_COUNT);
 
-    for (int i = 0; i <= X; ++i) {
-        write_memory(context, addressI++, context->registers[i]);
-        RETURN_ON_ERROR;
-    }
+    CHECK_AUTHORIZED_MEM_RANGE(context->addressI, X + 1,);
+    memcpy((void*)&context->memory[context->addressI], (void*)context->registers, X + 1);
+    C8_InvalidateCode(context, context->addressI, X + 1);
+    CHECK_WATCH(context->addressI, X + 1, C8_BREAK_WRITE);
 }
 
 void C8_OpcodeFX65(C8_Context *context, WORD opcode) {
-    WORD addressI = context->addressI;
-
     C8_OPCODE_SELECT_XNN(opcode);
 
     assert(X < REGISTER_COUNT);
 
-    for (int i = 0; i <= X; ++i) {
-        int tmp = read_memory(context, addressI++); RETURN_ON_ERROR;
-        context->registers[i] = tmp;
-    }
+    CHECK_AUTHORIZED_MEM_RANGE(context->addressI, X + 1,);
+    memcpy((void*)context->registers, (void*)&context->memory[context->addressI], X + 1);
+    CHECK_WATCH(context->addressI, X + 1, C8_BREAK_READ);
 }
 
+
+void C8_OpcodeFX75(C8_Context *context, WORD opcode) {
+    C8_OPCODE_SELECT_XNN(opcode);
+
+    assert(X < RPL_FLAG_COUNT);
+
+    memcpy((void*)context->rpl, (void*)context->registers, X + 1);
+}
+
+void C8_OpcodeFX85(C8_Context *context, WORD opcode) {
+    C8_OPCODE_SELECT_XNN(opcode);
+
+    assert(X < RPL_FLAG_COUNT);
+
+    memcpy((void*)context->registers, (void*)context->rpl, X + 1);
+}
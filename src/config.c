@@ -1,37 +1,113 @@
 #include "config.h"
+#include "chip8.h"
+#include "c8_def.h"
+#include "c8_file.h"
 #include "ini.h"
 
+#include <stdio.h>
+#include <strings.h>
+#include <inttypes.h>
+
 #define MATCH(lhs, rhs) (strcmp(lhs, rhs) == 0)
 #define MATCHV(s)       (MATCH(value, s)) 
 #define BOOLEAN(value)  (MATCHV("true")|MATCHV("yes")|MATCHV("on")|MATCHV("1"))
 
+typedef struct {
+    Config  *config;
+    char     hash_section[sizeof(CONFIG_HASH_PREFIX) + 16];
+} ConfigMatch;
+
+void config_defaults(Config *config) {
+    memset(config, 0, sizeof *config);
+    config->fps        = DEFAULT_FPS;
+    config->wrapy      = DEFAULT_WRAPY;
+    config->xochip     = DEFAULT_XOCHIP;
+    config->clockspeed = DEFAULT_CLOCKSPEED;
+    config->speed      = DEFAULT_SPEED;
+}
+
+int config_matches(const char *section, const char *game_name, uint64_t hash) {
+    char hash_section[sizeof(CONFIG_HASH_PREFIX) + 16];
+
+    snprintf(hash_section, sizeof hash_section, CONFIG_HASH_PREFIX "%016" PRIx64, hash);
+
+    return strcmp(section, game_name) == 0 || strcasecmp(section, hash_section) == 0;
+}
+
+int config_set(Config *config, const char *name, const char *value) {
+    if (MATCH(name, "wrapy")) {
+        config->wrapy = BOOLEAN(value);
+        return CONFIG_WRAPY;
+    } else if (MATCH(name, "xochip")) {
+        config->xochip = BOOLEAN(value);
+        return CONFIG_XOCHIP;
+    } else if (MATCH(name, "clockspeed")) {
+        config->clockspeed = atof(value);
+        return CONFIG_CLOCKSPEED;
+    } else if (MATCH(name, "fps")) {
+        config->fps = atof(value);
+        return CONFIG_FPS;
+    } else if (MATCH(name, "speed")) {
+        config->speed = atof(value);
+        return CONFIG_SPEED;
+    } else if (MATCH(name, "keys")) {
+        memset(config->keys, 0, KEYMAP_MAX_LEN);
+        strncpy(config->keys, value, KEYMAP_MAX_LEN - 1);
+        return CONFIG_KEYS;
+    }
+
+    return -1;
+}
+
 static int config_handler(void *user, const char *section, const char *name, const char *value) {
-    Config *config = (Config*)user;
-
-    printf("found section: %s\n", section);
-    if (strcmp(section, config->game_name) == 0) {
-        if (MATCH(name, "wrapy")) {
-            config->wrapy = BOOLEAN(value);
-        } else if (MATCH(name, "clockspeed")) {
-            config->clockspeed = atof(value);
-        } else if (MATCH(name, "fps")) {
-            config->fps = atof(value);
-        } else {
-            return -1;
+    ConfigMatch *match = (ConfigMatch*)user;
+
+    if (strcmp(section, match->config->game_name) == 0 || strcasecmp(section, match->hash_section) == 0) {
+        if (config_set(match->config, name, value) < 0) {
+            return 0;
         }
     }
 
-    return 0;
+    return 1;
 }
 
-int load_config(Config *config, const char *game_name, const char *path) {
+static void match_game(ConfigMatch *match, Config *config, const char *game_name, uint64_t hash) {
     memset(config->game_name, 0, GAME_NAME_MAX_LEN);
     strncpy(config->game_name, game_name, GAME_NAME_MAX_LEN - 1); // leave last char as \0
 
-    int rv = ini_parse(path, config_handler, (void*)config);
+    match->config = config;
+    snprintf(match->hash_section, sizeof match->hash_section, CONFIG_HASH_PREFIX "%016" PRIx64, hash);
+}
+
+int load_config(Config *config, const char *game_name, uint64_t hash, const char *path) {
+    ConfigMatch match;
+
+    match_game(&match, config, game_name, hash);
+
+    int rv = ini_parse(path, config_handler, (void*)&match);
     if (rv < 0) {
         fprintf(stderr, "Failed to read config at %s\n", path);
     }
 
     return rv;
 }
+
+int load_config_string(Config *config, const char *game_name, uint64_t hash, const char *text) {
+    ConfigMatch match;
+
+    match_game(&match, config, game_name, hash);
+
+    return ini_parse_string(text, config_handler, (void*)&match);
+}
+
+int config_hash_rom(const char *path, uint64_t *hash) {
+    size_t sz;
+    char  *buffer = c8_read_file(path, &sz);
+
+    if (buffer == NULL) return -1;
+
+    *hash = C8_Hash((BYTE*)buffer, sz);
+    free(buffer);
+
+    return 0;
+}
@@ -5,19 +5,41 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
 
 #define GAME_NAME_MAX_LEN 63
+#define KEYMAP_MAX_LEN    255
 
 typedef struct {
     char     game_name[GAME_NAME_MAX_LEN];
     int      wrapy;
+    int      xochip;
     float    clockspeed;
     float    fps;
+    float    speed;                                 // emulation speed multiplier, 0 runs unthrottled
+    char     keys[KEYMAP_MAX_LEN];                  // comma separated key names bound to keys 0 to F, empty for the default
 } Config;
 
-int load_config(Config *config, const char *game_name, const char *path);
+// Fields given by a config entry
+#define CONFIG_WRAPY        (1 << 0)
+#define CONFIG_XOCHIP       (1 << 1)
+#define CONFIG_CLOCKSPEED   (1 << 2)
+#define CONFIG_FPS          (1 << 3)
+#define CONFIG_SPEED        (1 << 4)
+#define CONFIG_KEYS         (1 << 5)
+
+#define CONFIG_HASH_PREFIX  "hash:"                 // sections named hash:<16 hex digits> match a ROM by content
+
+void config_defaults(Config *config);                                   // Settings of a game without an entry
+int  config_matches(const char *section, const char *game_name, uint64_t hash);     // Section applies to the game
+
+// Match the game by content hash or by name. Return ini_parse result
+int load_config(Config *config, const char *game_name, uint64_t hash, const char *path);
+int load_config_string(Config *config, const char *game_name, uint64_t hash, const char *text);     // INI text already read
+int config_set(Config *config, const char *name, const char *value);    // Return the CONFIG_* bit set, -1 if unknown
+int config_hash_rom(const char *path, uint64_t *hash);                   // C8_Hash of the file content
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,288 @@
+#include "config_db.h"
+#include "c8_file.h"
+#include "chip8.h"
+#include "ini.h"
+
+#include <stdio.h>
+#include <strings.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Reader */
+
+int config_db_open(ConfigDB *db, const char *path) {
+    const ConfigDBHeader *header;
+    struct stat st;
+    void *addr;
+    size_t expected;
+    int fd;
+
+    memset(db, 0, sizeof *db);
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ConfigDBHeader)) {
+        close(fd);
+        return -1;
+    }
+
+    addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);      // the mapping keeps the file
+    if (addr == MAP_FAILED) return -1;
+
+    header   = (const ConfigDBHeader*)addr;
+    expected = sizeof(ConfigDBHeader) + (size_t)header->count * sizeof(ConfigRecord) + header->strings;
+
+    if (header->magic != CONFIG_DB_MAGIC || header->version != CONFIG_DB_VERSION || expected != (size_t)st.st_size
+        || header->strings == 0 || ((const char*)addr)[st.st_size - 1] != '\0') {
+        munmap(addr, st.st_size);
+        return -1;
+    }
+
+    db->addr         = addr;
+    db->size         = st.st_size;
+    db->records      = (const ConfigRecord*)(header + 1);
+    db->count        = header->count;
+    db->strings      = (const char*)(db->records + db->count);
+    db->strings_size = header->strings;
+
+    return 0;
+}
+
+void config_db_close(ConfigDB *db) {
+    if (db->addr != NULL) munmap(db->addr, db->size);
+    memset(db, 0, sizeof *db);
+}
+
+const ConfigRecord *config_db_find(const ConfigDB *db, uint64_t hash) {
+    uint32_t lo = 0;
+    uint32_t hi = db->count;
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+
+        if (db->records[mid].hash < hash) lo = mid + 1;
+        else                              hi = mid;
+    }
+
+    return (lo < db->count && db->records[lo].hash == hash) ? &db->records[lo] : NULL;
+}
+
+const char *config_db_string(const ConfigDB *db, uint32_t offset) {
+    return (offset < db->strings_size) ? db->strings + offset : "";
+}
+
+void config_db_apply(const ConfigDB *db, const ConfigRecord *record, Config *config) {
+    if (record->fields & CONFIG_WRAPY)      config->wrapy      = record->wrapy;
+    if (record->fields & CONFIG_XOCHIP)     config->xochip     = record->xochip;
+    if (record->fields & CONFIG_CLOCKSPEED) config->clockspeed = record->clockspeed;
+    if (record->fields & CONFIG_FPS)        config->fps        = record->fps;
+    if (record->fields & CONFIG_SPEED)      config->speed      = record->speed;
+    if (record->fields & CONFIG_KEYS) {
+        memset(config->keys, 0, KEYMAP_MAX_LEN);
+        strncpy(config->keys, config_db_string(db, record->keys), KEYMAP_MAX_LEN - 1);
+    }
+}
+
+/* Compiler */
+
+typedef struct {
+    uint64_t    hash;
+    size_t      order;                                          // later entries override earlier ones
+    int         fields;
+    Config      config;
+} CompileEntry;
+
+typedef struct {
+    CompileEntry   *entries;
+    size_t          count;
+    size_t          capacity;
+    const char     *path;                                       // config file being parsed
+    char            dir[PATH_MAX_LEN];                          // ROMs of its sections live there
+    char            section[GAME_NAME_MAX_LEN];                 // section of entries[count - 1]
+    int             in_section;                                 // section is set for the current file
+    int             skip;                                       // the current section has no readable ROM
+} CompileState;
+
+static int section_hash(CompileState *state, const char *section, uint64_t *hash) {
+    size_t prefix = strlen(CONFIG_HASH_PREFIX);
+    char rom[PATH_MAX_LEN];
+    char *end;
+
+    if (strncasecmp(section, CONFIG_HASH_PREFIX, prefix) == 0) {
+        *hash = strtoull(section + prefix, &end, 16);
+        return (end != section + prefix && *end == '\0') ? 0 : -1;
+    }
+
+    snprintf(rom, sizeof rom, "%s%s", state->dir, section);
+    return config_hash_rom(rom, hash);
+}
+
+static int compile_handler(void *user, const char *section, const char *name, const char *value) {
+    CompileState *state = (CompileState*)user;
+    CompileEntry *entry;
+    int field;
+
+    if (!state->in_section || strcmp(section, state->section) != 0) {
+        uint64_t hash;
+
+        memset(state->section, 0, GAME_NAME_MAX_LEN);
+        strncpy(state->section, section, GAME_NAME_MAX_LEN - 1);
+        state->in_section = 1;
+
+        state->skip = section[0] == '\0' || section_hash(state, section, &hash) != 0;
+        if (state->skip) {
+            fprintf(stderr, "%s: no ROM for [%s], skipped\n", state->path, section);
+            return 1;
+        }
+
+        if (state->count == state->capacity) {
+            size_t capacity = state->capacity ? state->capacity * 2 : 64;
+            CompileEntry *entries = (CompileEntry*)realloc(state->entries, capacity * sizeof(CompileEntry));
+
+            if (entries == NULL) return 0;
+            state->entries  = entries;
+            state->capacity = capacity;
+        }
+
+        entry = &state->entries[state->count];
+        memset(entry, 0, sizeof *entry);
+        entry->hash  = hash;
+        entry->order = state->count++;
+        strncpy(entry->config.game_name, section, GAME_NAME_MAX_LEN - 1);
+    }
+
+    if (state->skip) return 1;
+
+    entry = &state->entries[state->count - 1];
+    field = config_set(&entry->config, name, value);
+    if (field < 0) {
+        fprintf(stderr, "%s: unknown option %s in [%s]\n", state->path, name, section);
+        return 0;
+    }
+    entry->fields |= field;
+
+    return 1;
+}
+
+static int compare_entries(const void *lhs, const void *rhs) {
+    const CompileEntry *a = (const CompileEntry*)lhs;
+    const CompileEntry *b = (const CompileEntry*)rhs;
+
+    if (a->hash != b->hash) return (a->hash < b->hash) ? -1 : 1;
+    return (a->order < b->order) ? -1 : (a->order > b->order);
+}
+
+static void merge_entry(CompileEntry *dst, const CompileEntry *src) {
+    if (src->fields & CONFIG_WRAPY)      dst->config.wrapy      = src->config.wrapy;
+    if (src->fields & CONFIG_XOCHIP)     dst->config.xochip     = src->config.xochip;
+    if (src->fields & CONFIG_CLOCKSPEED) dst->config.clockspeed = src->config.clockspeed;
+    if (src->fields & CONFIG_FPS)        dst->config.fps        = src->config.fps;
+    if (src->fields & CONFIG_SPEED)      dst->config.speed      = src->config.speed;
+    if (src->fields & CONFIG_KEYS)       memcpy(dst->config.keys, src->config.keys, KEYMAP_MAX_LEN);
+
+    memcpy(dst->config.game_name, src->config.game_name, GAME_NAME_MAX_LEN);
+    dst->fields |= src->fields;
+}
+
+static int write_db(const char *path, const CompileEntry *entries, size_t count) {
+    char tmp[PATH_MAX_LEN];
+    ConfigDBHeader header;
+    ConfigRecord *records;
+    char *strings;
+    uint32_t strings_size = 1;                                  // offset 0 is the empty string
+    size_t i;
+    FILE *fp;
+    int ok;
+
+    records = (ConfigRecord*)calloc(count ? count : 1, sizeof(ConfigRecord));
+    strings = (char*)calloc(1 + count * (GAME_NAME_MAX_LEN + KEYMAP_MAX_LEN), 1);
+    if (records == NULL || strings == NULL) {
+        free(records);
+        free(strings);
+        return -1;
+    }
+
+    for (i = 0; i < count; ++i) {
+        const CompileEntry *e = &entries[i];
+        ConfigRecord       *r = &records[i];
+
+        r->hash       = e->hash;
+        r->fields     = e->fields;
+        r->wrapy      = e->config.wrapy;
+        r->xochip     = e->config.xochip;
+        r->clockspeed = e->config.clockspeed;
+        r->fps        = e->config.fps;
+        r->speed      = e->config.speed;
+        r->name       = c8_append_string(strings, &strings_size, e->config.game_name);
+        r->keys       = (e->fields & CONFIG_KEYS) ? c8_append_string(strings, &strings_size, e->config.keys) : 0;
+    }
+
+    header.magic   = CONFIG_DB_MAGIC;
+    header.version = CONFIG_DB_VERSION;
+    header.count   = count;
+    header.strings = strings_size;
+
+    // a running emulator keeps its mapping of the previous file
+    fp = c8_write_begin(path, tmp);
+    if (fp == NULL) {
+        free(records);
+        free(strings);
+        return -1;
+    }
+
+    ok = fwrite(&header, sizeof header, 1, fp) == 1
+      && fwrite(records, sizeof(ConfigRecord), count, fp) == count
+      && fwrite(strings, 1, strings_size, fp) == strings_size;
+
+    free(records);
+    free(strings);
+
+    return c8_write_end(fp, tmp, path, ok);
+}
+
+int config_db_compile(const char *path, const char *const *configs, int count) {
+    CompileState state;
+    size_t kept = 0;
+    size_t i;
+    int rv;
+
+    memset(&state, 0, sizeof state);
+
+    for (int c = 0; c < count; ++c) {
+        const char *slash = strrchr(configs[c], '/');
+        size_t      len   = slash ? (size_t)(slash - configs[c]) + 1 : 0;
+
+        if (len >= PATH_MAX_LEN) len = 0;
+        memcpy(state.dir, configs[c], len);
+        state.dir[len]   = '\0';
+        state.path       = configs[c];
+        state.in_section = 0;           // a section continued in another file is a new entry
+
+        rv = ini_parse(configs[c], compile_handler, &state);
+        if (rv < 0) {
+            fprintf(stderr, "Failed to read config at %s\n", configs[c]);
+            free(state.entries);
+            return -1;
+        }
+    }
+
+    qsort(state.entries, state.count, sizeof(CompileEntry), compare_entries);
+
+    for (i = 0; i < state.count; ++i) {
+        if (kept > 0 && state.entries[kept - 1].hash == state.entries[i].hash) {
+            merge_entry(&state.entries[kept - 1], &state.entries[i]);
+        } else {
+            state.entries[kept++] = state.entries[i];
+        }
+    }
+
+    rv = write_db(path, state.entries, kept);
+    free(state.entries);
+
+    return (rv == 0) ? (int)kept : -1;
+}
@@ -0,0 +1,71 @@
+#ifndef CONFIG_DB_H
+#define CONFIG_DB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+#define CONFIG_DB_MAGIC     0x42443843                          // "C8DB"
+#define CONFIG_DB_VERSION   1
+#define CONFIG_DB_NAME      "config.db"                         // looked up next to config.cfg
+
+/**
+ * @brief Per-game settings compiled from config files, keyed by ROM content hash
+ *
+ * Layout: header, records sorted by hash, then a string table of NUL terminated names
+ * and keymaps referenced by offset. Offset 0 is the empty string. The file is mapped
+ * read-only and searched in place, nothing is parsed at startup.
+*/
+typedef struct {
+    uint32_t    magic;
+    uint32_t    version;
+    uint32_t    count;                                          // records
+    uint32_t    strings;                                        // string table size in bytes
+} ConfigDBHeader;
+
+typedef struct {
+    uint64_t    hash;                                           // C8_Hash of the ROM
+    float       clockspeed;
+    float       fps;
+    float       speed;
+    uint32_t    keys;                                           // string table offsets
+    uint32_t    name;                                           // section the entry was compiled from
+    uint8_t     wrapy;
+    uint8_t     xochip;
+    uint16_t    fields;                                         // CONFIG_* bits given by the entry, the rest keeps its default
+} ConfigRecord;
+
+typedef struct {
+    void                *addr;
+    size_t               size;
+    const ConfigRecord  *records;
+    uint32_t             count;
+    const char          *strings;
+    uint32_t             strings_size;
+} ConfigDB;
+
+int  config_db_open(ConfigDB *db, const char *path);            // 0 on success, -1 if missing or not a valid database
+void config_db_close(ConfigDB *db);
+const ConfigRecord *config_db_find(const ConfigDB *db, uint64_t hash);
+const char *config_db_string(const ConfigDB *db, uint32_t offset);
+void config_db_apply(const ConfigDB *db, const ConfigRecord *record, Config *config);
+
+/**
+ * @brief Compile config files into a database at `path`
+ *
+ * Sections name a ROM next to their config file, or give its hash as hash:<16 hex digits>.
+ * Entries of the same ROM are merged, later files overriding earlier ones field by field.
+ * Sections whose ROM cannot be read are reported and skipped. Return the number of
+ * records written, -1 on error.
+*/
+int config_db_compile(const char *path, const char *const *configs, int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
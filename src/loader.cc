@@ -1,17 +1,91 @@
 #include "loader.hh"
 #include "c8_def.h"
+#include "c8_file.h"
 
 #include <cstddef>
 #include <algorithm>
 #include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <sys/stat.h>
 
 static const char *help_msg = " \
 Usage: chip8 <GAME_PATH> [CONFIG_PATH] \
+       chip8 <GAMES_DIR> | --grid <GAME_PATH|GAMES_DIR>... \
 ";
 
+static bool is_directory(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+// CHIPPER sources are also listed, they are assembled when loaded
+static bool is_rom_name(const char *name) {
+    return c8_is_rom_name(name) || (name[0] != '.' && Chipper_IsSource(name));
+}
+
+// In memory, warnings are only shown when the source does not assemble
+static bool assemble(const std::string &path, std::vector<BYTE> &image) {
+    Chipper_Result result;
+    bool           ok = Chipper_AssembleFile(path.c_str(), NULL, &result) == CHIPPER_OK;
+
+    if (ok) image.assign(result.image, result.image + result.image_size);
+    else    fprintf(stderr, "Cannot assemble %s\n%s", path.c_str(), result.messages ? result.messages : "");
+
+    Chipper_Free(&result);
+    return ok;
+}
+
+// Regular files of a directory or games of a pack in name order, or the path itself
+static void add_games(std::vector<std::string> &games, const std::string &path) {
+    std::vector<std::string> names;
+    struct dirent *entry;
+    DIR *dir;
+    C8_Pack pack;
+
+    if (!is_directory(path.c_str())) {
+        if (C8_IsPack(path.c_str()) && C8_PackOpen(&pack, path.c_str()) == 0) {
+            for (uint32_t i = 0; i < pack.count; ++i) {
+                games.push_back(path + "/" + C8_PackString(&pack, pack.entries[i].name));
+            }
+            C8_PackClose(&pack);
+        } else {
+            games.push_back(path);
+        }
+        return;
+    }
+
+    dir = opendir(path.c_str());
+    if (dir == NULL) return;
+
+    while ((entry = readdir(dir)) != NULL) {
+        std::string full = path + "/" + entry->d_name;
+        struct stat st;
+
+        if (is_rom_name(entry->d_name) && stat(full.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+            names.push_back(full);
+        }
+    }
+    closedir(dir);
+
+    std::sort(names.begin(), names.end());
+    games.insert(games.end(), names.begin(), names.end());
+}
+
+C8Loader::C8Loader() : game_hash(0), m_entry(NULL), m_assembled(false) {
+    memset(&m_db, 0, sizeof m_db);
+    memset(&m_pack, 0, sizeof m_pack);
+}
+
+C8Loader::~C8Loader() {
+    config_db_close(&m_db);
+    C8_PackClose(&m_pack);
+}
+
 int C8Loader::load(int argc, char **argv, Config &config, C8_Context &context) {
     if (m_parse_args(argc, argv) != 0) {
         fprintf(stderr, "Usage: %s <GAME_PATH> [CONFIG_PATH]\n", argv[0]);
+        fprintf(stderr, "       %s <GAMES_DIR> | --grid <GAME_PATH|GAMES_DIR>...\n", argv[0]);
 
         return -1;
     }
@@ -26,46 +100,204 @@ int C8Loader::load(int argc, char **argv, Config &config, C8_Context &context) {
     }
 
     printf("GAME: %s\n", game_name.c_str());
-    printf("CONFIG [%s]:\n\tfps: %f\n\twrapy: %d\n\tclockspeed: %f\n", 
-            (c_rv < 0 ? "DEFAULT" : config_path.c_str()), config.fps, config.wrapy, config.clockspeed);
+    printf("CONFIG [%s]:\n\tfps: %f\n\twrapy: %d\n\txochip: %d\n\tclockspeed: %f\n\tspeed: %f\n\tkeys: %s\n", 
+            (c_rv < 0 ? "DEFAULT" : m_config_source()), config.fps, config.wrapy, config.xochip, config.clockspeed, config.speed,
+            config.keys[0] ? config.keys : "default");
 
     return 0;
 }
 
-int C8Loader::m_parse_args(int argc, char **argv) {
+int C8Loader::load(const std::string &path, Config &config, C8_Context &context) {
+    m_set_game(path);
+    m_load_config(config);
+
+    return m_load_prgm(config, context);
+}
+
+bool C8Loader::is_grid(int argc, char **argv) {
+    return argc >= 2 && (strcmp(argv[1], "--grid") == 0 || is_directory(argv[1]) || C8_IsPack(argv[1]));
+}
+
+std::vector<std::string> C8Loader::grid_games(int argc, char **argv) {
+    std::vector<std::string> games;
+
+    for (int i = (strcmp(argv[1], "--grid") == 0) ? 2 : 1; i < argc; ++i) {
+        add_games(games, argv[i]);
+    }
+
+    return games;
+}
+
+std::vector<std::string> C8Loader::list_games(const std::string &dir) {
+    std::vector<std::string> games;
+
+    if (is_directory(dir.c_str()) || C8_IsPack(dir.c_str())) add_games(games, dir);
+
+    return games;
+}
+
+std::string C8Loader::game_dir() const {
+    std::size_t found = game_path.find_last_of("/\\");
+
+    return (found == std::string::npos) ? "." : game_path.substr(0, found);
+}
+
+std::string C8Loader::config_file() const {
+    if (m_entry != NULL || (m_db.addr != NULL && m_db_path == config_path)) return "";
+
+    return config_path;
+}
+
+bool C8Loader::hash_game(const std::string &path, uint64_t &hash) {
+    std::size_t         found = path.find_last_of("/\\");
+    const C8_PackEntry *entry;
+
+    if (found != std::string::npos && m_open_pack(path.substr(0, found))) {
+        entry = C8_PackFind(&m_pack, path.c_str() + found + 1);
+        if (entry != NULL) hash = entry->hash;
+
+        return entry != NULL;
+    }
+
+    if (Chipper_IsSource(path.c_str())) {
+        std::vector<BYTE> image;
+
+        if (!assemble(path, image)) return false;
+        hash = C8_Hash(image.data(), image.size());
+        return true;
+    }
+
+    return config_hash_rom(path.c_str(), &hash) == 0;
+}
+
+void C8Loader::m_set_game(const std::string &path) {
     std::size_t found;
 
+    game_path   = path;
+    found       = game_path.find_last_of("/\\");
+    game_name   = game_path.substr(found+1);
+    config_path = game_path.substr(0, found+1) + "config.cfg";
+}
+
+int C8Loader::m_parse_args(int argc, char **argv) {
     if (argc < 2) {
         return -1;
     }
 
     prgm_path   = argv[0];
-    game_path   = argv[1];
-
-    found = game_path.find_last_of("/\\");
-    game_name = game_path.substr(found+1);
+    m_set_game(argv[1]);
 
     if (argc >= 3) {
         config_path = argv[2];
-    } else {
-        config_path = game_path.substr(0, found+1) + "config.cfg";
     }
 
     return 0;
 }
 
 int C8Loader::m_load_config(Config &config) {
-    // Set to default
-    config.fps          = DEFAULT_FPS;
-    config.wrapy        = DEFAULT_WRAPY;
-    config.clockspeed   = DEFAULT_CLOCKSPEED;
+    config_defaults(&config);
 
-    int rv = load_config(&config, game_name.c_str(), config_path.c_str());
+    m_assembled = false;
+    m_entry = m_open_pack(game_dir()) ? C8_PackFind(&m_pack, game_name.c_str()) : NULL;
+    if (m_entry != NULL) {
+        // resolved from the config files when the pack was built
+        game_hash         = m_entry->hash;
+        config.wrapy      = m_entry->wrapy;
+        config.xochip     = m_entry->xochip;
+        config.clockspeed = m_entry->clockspeed;
+        config.fps        = m_entry->fps;
+        config.speed      = m_entry->speed;
+        strncpy(config.keys, C8_PackString(&m_pack, m_entry->keys), KEYMAP_MAX_LEN - 1);
+        memset(config.game_name, 0, GAME_NAME_MAX_LEN);
+        strncpy(config.game_name, game_name.c_str(), GAME_NAME_MAX_LEN - 1);
+        return 0;
+    }
+
+    if (m_pack.base != NULL) return -1;                             // not in the pack
+
+    // a source shares the settings of the ROM it assembles to
+    m_assembled = Chipper_IsSource(game_path.c_str()) && assemble(game_path, m_image);
+    if (m_assembled) {
+        game_hash = C8_Hash(m_image.data(), m_image.size());
+    } else if (config_hash_rom(game_path.c_str(), &game_hash) != 0) {
+        game_hash = 0;
+    }
+
+    if (m_open_db()) {
+        const ConfigRecord *record = config_db_find(&m_db, game_hash);
+
+        memset(config.game_name, 0, GAME_NAME_MAX_LEN);
+        strncpy(config.game_name, game_name.c_str(), GAME_NAME_MAX_LEN - 1);
+
+        if (record == NULL) return -1;
+        config_db_apply(&m_db, record, &config);
+        return 0;
+    }
+
+    int rv = load_config(&config, game_name.c_str(), game_hash, config_path.c_str());
 
     return rv;
 }
 
+// config_path itself when it is a compiled database, else the one next to it unless
+// config.cfg was edited after it was compiled
+bool C8Loader::m_open_db() {
+    if (config_path == m_db_config) return m_db.addr != NULL;
+
+    config_db_close(&m_db);
+    m_db_config = config_path;
+
+    if (config_db_open(&m_db, config_path.c_str()) == 0) {
+        m_db_path = config_path;
+        return true;
+    }
+
+    std::size_t found = config_path.find_last_of("/\\");
+    std::string db    = config_path.substr(0, found + 1) + CONFIG_DB_NAME;
+    struct stat db_st, config_st;
+
+    if (stat(db.c_str(), &db_st) != 0) return false;
+
+    if (stat(config_path.c_str(), &config_st) == 0 && config_st.st_mtime > db_st.st_mtime) {
+        fprintf(stderr, "%s is older than %s, rebuild it with c8configdb\n", db.c_str(), config_path.c_str());
+        return false;
+    }
+
+    if (config_db_open(&m_db, db.c_str()) != 0) return false;
+
+    m_db_path = db;
+    return true;
+}
+
+bool C8Loader::m_open_pack(const std::string &path) {
+    if (path == m_pack_path) return m_pack.base != NULL;
+
+    C8_PackClose(&m_pack);
+    m_pack_path = path;
+
+    return C8_PackOpen(&m_pack, path.c_str()) == 0;
+}
+
+const char *C8Loader::m_config_source() const {
+    if (m_entry != NULL)  return m_pack_path.c_str();
+    if (m_db.addr)        return m_db_path.c_str();
+
+    return config_path.c_str();
+}
+
 int C8Loader::m_load_prgm(const Config &config, C8_Context &context) {
+    if (m_entry != NULL) {
+        return C8_PackLoad(&context, &m_pack, m_entry);
+    }
+
+    // memory layout depends on the variant, set it before loading
+    context.config.wrapy  = config.wrapy;
+    context.config.xochip = config.xochip;
+
+    if (Chipper_IsSource(game_path.c_str())) {
+        return m_assembled ? C8_LoadRom(&context, m_image.data(), m_image.size()) : -1;
+    }
+
     int rv       =  C8_LoadProgram(&context, game_path.c_str());
     C8_Error err =  C8_GetError(&context);
 
@@ -73,7 +305,5 @@ int C8Loader::m_load_prgm(const Config &config, C8_Context &context) {
         fprintf(stderr, "Cannot open config: %s\n", config_path.c_str());
     }
 
-    context.config.wrapy = config.wrapy;
-
     return rv;
 }
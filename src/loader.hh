@@ -2,23 +2,56 @@
 #define LOADER_HH
 
 #include <string>
+#include <vector>
 #include "config.h"
+#include "config_db.h"
+#include "c8_pack.h"
 #include "chip8.h"
+#include "chipper.h"
 
 class C8Loader {
 public:
-    C8Loader() = default;
+    C8Loader();
+    ~C8Loader();
+    C8Loader(const C8Loader&) = delete;
+    C8Loader &operator=(const C8Loader&) = delete;
+
     int load(int argc, char **argv, Config &config, C8_Context &context);
+    int load(const std::string &path, Config &config, C8_Context &context);      // quietly, with the config.cfg next to the game
+
+    static bool is_grid(int argc, char **argv);                                 // a directory or pack, or --grid followed by games
+    static std::vector<std::string> grid_games(int argc, char **argv);
+    static std::vector<std::string> list_games(const std::string &dir);        // ROMs of a directory or pack in name order
+    std::string game_dir() const;
+    std::string config_file() const;                                            // config.cfg of the game, empty for a pack or a database argument
+    bool hash_game(const std::string &path, uint64_t &hash);                    // from the pack index, the file content, or the assembled source
 
     std::string prgm_path;
     std::string game_path;
     std::string config_path;
     std::string game_name;
+    uint64_t    game_hash;                                                      // C8_Hash of the ROM, the config is looked up by it
 
 private:
     int     m_parse_args(int argc, char **argv);
+    void    m_set_game(const std::string &path);
     int     m_load_config(Config &config);
     int     m_load_prgm(const Config &config, C8_Context &context);
+    bool    m_open_db();
+    bool    m_open_pack(const std::string &path);
+    const char *m_config_source() const;
+
+    ConfigDB    m_db;                                                           // mapped once, reused by the following games
+    std::string m_db_config;                                                    // config path m_db was looked up for
+    std::string m_db_path;
+
+    // Games of a pack are named <PACK_PATH>/<NAME>
+    C8_Pack             m_pack;                                                 // mapped once, reused by the following games
+    std::string         m_pack_path;                                            // path m_pack was opened for
+    const C8_PackEntry *m_entry;                                                // game being loaded, NULL outside of a pack
+
+    std::vector<BYTE>   m_image;                                                // assembled by m_load_config, loaded by m_load_prgm
+    bool                m_assembled;
 };
 
 #endif
\ No newline at end of file
@@ -1,226 +1,468 @@
 #include "chip8.h"
+#include "c8_telemetry.h"
+#include "c8_recorder.h"
 #include "c8_def.h"
 #include "c8_profiler.hh"
-#include "cleanup.hh"
+#include "c8_trace.hh"
 #include "config.h"
 #include "loader.hh"
-#include "audio.hh"
+#include "backend.hh"
+#include "c8_browser.hh"
+#include "c8_grid.hh"
+#include "c8_live.hh"
+#include "c8_config_watch.hh"
 
-#include "imgui.h"
-#include "imgui_impl_sdl2.h"
-#include "imgui_impl_sdlrenderer2.h"
-#include <SDL.h>
+#include <algorithm>
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <cassert>
 
-#if !SDL_VERSION_ATLEAST(2,0,17)
-#error This backend requires SDL 2.0.17+ because of SDL_RenderGeometry() function
-#endif
+// Cycle the emulation reaches at the host time of an event, given the last time it caught up.
+// Unthrottled (clockspeed 0), inputs apply at the next instruction.
+uint64_t event_cycle(uint64_t timestamp, uint64_t sync_time, uint64_t sync_cycle, float clockspeed) {
+    if (timestamp <= sync_time) return sync_cycle;
 
-#define TICK_COND(ticks, prev_ticks, speed, cond, statement) do {       \
-    Uint64 delta = ticks - prev_ticks;                                  \
-    if ((delta > (1000/speed)) && cond) {                               \
-        statement                                                       \
-        prev_ticks = ticks;                                             \
-    }                                                                   \
-} while (0);
+    return sync_cycle + (uint64_t)((timestamp - sync_time) * clockspeed / 1e9);
+}
+
+// Spans recorded so far, when CHIP8_TRACE names a file
+void export_trace() {
+    const char *trace_path = getenv("CHIP8_TRACE");
 
-#define TICK(ticks, prevTicks, speed, statement) TICK_COND(ticks, prevTicks, speed, 1, statement)
+    if (trace_path != NULL && !C8_TraceExport(trace_path)) {
+        fprintf(stderr, "Cannot write trace to %s\n", trace_path);
+    }
+}
 
-#define SET_KEY(keyword) do {                                           \
-    int key = event.key.keysym.sym;                                     \
-    if (key >= 0x30 && key <= 0x39)                 /* 0 to 9 */        \
-        C8_##keyword##Key(context, key & 0x0F);                         \
-    else if (key >= 0x60 && key <= 0x66)            /* A to F */        \
-        C8_##keyword##Key(context, (key & 0x0F) + 0x9);                 \
-} while(0);
+// Speeds cycled through with Tab
+static const float speeds[] = { 1, 4, 16, 0 };
 
-void copy_c8_display(SDL_Texture *texture, C8_Context *context) {
-    void    *pixels;
-    int      pitch;
-    Uint32   *base;
+float next_speed(float speed) {
+    size_t count = sizeof speeds / sizeof speeds[0];
 
-    SDL_LockTexture(texture, NULL, &pixels, &pitch);
+    for (size_t i = 0; i < count; ++i) {
+        if (speeds[i] == speed) return speeds[(i + 1) % count];
+    }
 
-    for(int row = 0; row < SCREEN_HEIGHT; ++row) {
-        base = (Uint32*)((Uint8*)pixels + row * pitch);
+    return speeds[0];
+}
 
-        for(int col = 0; col < SCREEN_WIDTH; ++col) {
-            int i = (row * SCREEN_WIDTH) + col;
-            int color = (context->display[i] == 0 ? 0x00 : 0xFF);
+// Labels of the watched source for the disassembly
+std::vector<_C8_Label> source_labels(const C8_LiveSource &live) {
+    std::vector<_C8_Label> labels;
 
-            *base++ = (0xFF000000|(color << 16)|(color << 8)|color);
-        }
+    for (const Chipper_Symbol &symbol : live.symbols()) {
+        labels.push_back(_C8_Label{ (WORD)symbol.address, symbol.name });
     }
 
-    SDL_UnlockTexture(texture);
+    return labels;
 }
 
-int main(int argc, char** argv) {
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_GAMECONTROLLER | SDL_INIT_AUDIO) != 0) {
-        printf("SDL_Init Error: %s\n", SDL_GetError());
+// Every program of the grid advances one timer period per step, at the same pace
+// as a single program. Inputs go to the focused one.
+int run_grid(C8Backend &backend, const std::vector<std::string> &paths) {
+    C8_Grid          grid;
+    bool             bRunning;
+    uint64_t         now, prev_time, next_present;
+    double           owed, present_rate;
+    float            speed;
+
+    if (grid.load(paths) == 0) {
+        fprintf(stderr, "No program to run\n");
         return 1;
     }
-    
+
+    // the profiler needs a context from the start, it follows the focus
+    C8_Profiler      profiler(grid.instance(0).context);
+    const Config    &config = grid.instance(0).config;
+
+    if (backend.init(config) != 0) return 1;
+    grid.focus(0, backend.beeper(), profiler);
+
+    bRunning        = true;
+    owed            = 0;
+    speed           = config.speed;
+    present_rate    = config.fps;
+    if (backend.refreshRate() > 0) {
+        present_rate = std::min(present_rate, backend.refreshRate());
+    }
+
+    backend.setSpeed(speed);
+    prev_time = next_present = backend.now();
+
+    while (bRunning) {
+        BackendEvent event;
+        C8_Context  &focused = grid.instance(grid.focused()).context;
+        now = backend.now();
+
+        {
+            C8_TRACE_SCOPE("events");
+            while (backend.poll(event)) {
+                if (BackendEvent::QUIT == event.type) {
+                    bRunning = false;
+                    break;
+                } else if (BackendEvent::NEXT_SPEED == event.type) {
+                    speed = next_speed(speed);
+                    backend.setSpeed(speed);
+                } else if (BackendEvent::FOCUS == event.type) {
+                    if ((size_t)event.key != grid.focused()) grid.focus(event.key, backend.beeper(), profiler);
+                } else if (BackendEvent::KEY_DOWN == event.type || BackendEvent::KEY_UP == event.type) {
+                    // applied at the next instruction, the grid runs whole periods
+                    profiler.setKey(event.key, BackendEvent::KEY_DOWN == event.type, focused.cycles, event.time);
+                }
+            }
+        }
+
+        // timer periods owed since the last iteration
+        if (speed > 0) {
+            owed = std::min(owed + (now - prev_time) * 60.0 * speed / 1e9, 60.0 * speed * MAX_BACKLOG_IN_SECONDS);
+        }
+        prev_time = now;
+
+        if (profiler.paused() && profiler.shouldStep() && profiler.tick() <= 0) {
+            grid.instance(grid.focused()).running = false;
+        }
+
+        {
+            C8_TRACE_SCOPE("emulate");
+            while (bRunning && (speed == 0 || owed >= 1)) {
+                grid.step(profiler);
+                owed -= (speed == 0) ? 0 : 1;
+
+                if (backend.now() >= next_present) break;
+            }
+        }
+
+        now = backend.now();
+        if (now >= next_present) {
+            backend.presentGrid(grid, profiler);
+            C8_TraceFrame();
+            profiler.presented(backend.now());
+
+            next_present = std::max(next_present + (uint64_t)(1e9 / present_rate), now);
+        } else if (speed > 0 && owed < 1) {
+            C8_TRACE_SCOPE("sleep");
+            backend.sleep(1000000);
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char** argv) {
     bool             bRunning;
     bool             c8_tick;
-    int              opcode;
     C8_Context      _context;
     C8_Context      *context;
     C8_Profiler      profiler(_context);        // needs to be assigned here
-    C8_Beeper        c8_beeper;
-    Beeper           beeper;
+    C8Backend       *backend;
+    const char      *backend_name;
+    int              rv;
 
     C8Loader         loader;
     Config           config;
-
-    SDL_Window      *window;
-    SDL_Renderer    *renderer;
-    SDL_Texture     *texture;
-    SDL_Rect         viewport;
-    SDL_Rect         srcrect, dstrect;
-    Uint64           ticks, prev_ticks, prev_draws, prev_timers_ticks;
+    C8_Browser       browser;
+    C8_LiveSource    live;
+    C8_ConfigWatcher config_watcher;
+    C8_Telemetry     telemetry;
+    const char      *telemetry_path;
+    C8_Recorder      recorder;
+    C8_RecordOptions record_options;
+    const char      *record_path;
+
+    uint64_t         now, prev_time, next_present, present_cost;
+    double           present_rate;
+    double           owed, next_timer_slot, next_frame_slot;
+    uint64_t         slots;
+    float            speed;
+    int              skipped;
+    uint64_t         frame_time;
+    uint64_t         sync_time, sync_cycle;
 
     /* init components */
     bRunning            = true;
     c8_tick             = true;
     context             = &_context;
-    ticks               = 0;
-    prev_ticks          = 0;
-    prev_draws          = 0;
-    prev_timers_ticks   = 0;
-
-    c8_beeper.beep      = beeper.beep;
-    c8_beeper.user_data = (void*)&beeper;
-
-    srcrect.w = SCREEN_WIDTH;
-    srcrect.h = SCREEN_HEIGHT;
-    srcrect.x = 0;
-    srcrect.y = 0;
-    dstrect.w = SCREEN_WIDTH  * PIXEL_SCALE;
-    dstrect.h = SCREEN_HEIGHT * PIXEL_SCALE;
-    dstrect.x = 0;
-    dstrect.y = 0;
-
-    // From 2.0.18: Enable native IME.
-#ifdef SDL_HINT_IME_SHOW_UI
-    SDL_SetHint(SDL_HINT_IME_SHOW_UI, "1");
-#endif
-
-    // Create window with SDL_Renderer graphics context
-    SDL_WindowFlags windowFlags = (SDL_WindowFlags)(SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI);
-    window = SDL_CreateWindow("chip8", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, WINDOW_WIDTH, WINDOW_HEIGHT, windowFlags);
-    if (window == NULL) {
-        printf("SDL_CreateWindow Error: %s\n", SDL_GetError());
-        SDL_Quit();
+    owed                = 0;
+    slots               = 0;
+    skipped             = 0;
+    present_cost        = 0;
+    sync_time           = 0;
+    sync_cycle          = 0;
+
+    // video, input and audio, nothing is initialized before the choice
+    backend_name = getenv("CHIP8_BACKEND");
+    if (backend_name == NULL) backend_name = DEFAULT_BACKEND;
+
+    backend = create_backend(backend_name);
+    if (backend == NULL) {
+        fprintf(stderr, "Unknown backend %s, expected sdl, null or terminal\n", backend_name);
         return 1;
     }
 
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
-    if (renderer == NULL) {
-        cleanup(window);
-        printf("SDL_CreateRenderer Error: %s\n", SDL_GetError());
-        SDL_Quit();
-        return 1;
+    // several programs side by side
+    if (C8Loader::is_grid(argc, argv)) {
+        rv = run_grid(*backend, C8Loader::grid_games(argc, argv));
+        export_trace();
+        delete backend;
+        return rv;
     }
 
-    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
-    if (texture == NULL) {
-        cleanup(renderer, window);
-        printf("SDL_CreateTexture Error: %s\n", SDL_GetError());
-        SDL_Quit();
+    C8_Reset(context, NULL);
+    rv = loader.load(argc, argv, config, _context);
+    if (rv != 0 || backend->init(config) != 0) {
+        delete backend;
+        C8_Destroy(context);
         return 1;
     }
-
-    C8_Reset(context, &c8_beeper);
-    int rv = loader.load(argc, argv, config, _context);
-    if (rv != 0) {
-        cleanup(context, texture, renderer, window);
-        SDL_Quit();
-        return 1;
+    context->beeper = backend->beeper();
+
+    // emulation is paced by instruction slots, presentation by the display
+    auto apply_config = [&]() {
+        speed           = config.speed;
+        owed            = 0;
+        slots           = 0;
+        next_timer_slot = config.clockspeed / 60.0;
+        next_frame_slot = config.clockspeed / config.fps;
+        present_rate    = config.fps;
+        if (backend->refreshRate() > 0) {
+            present_rate = std::min(present_rate, backend->refreshRate());
+        }
+        backend->setSpeed(speed);
+    };
+    apply_config();
+
+    // Sources are assembled again and patched in place when saved
+    auto watch_source = [&]() {
+        if (live.watch(loader.game_path)) printf("Watching %s\n", loader.game_path.c_str());
+        profiler.setLabels(source_labels(live));
+    };
+    watch_source();
+
+    // Edits to the game's entry of config.cfg apply while it runs
+    auto watch_config = [&]() {
+        std::string path = loader.config_file();
+
+        if (path.empty()) config_watcher.stop();
+        else              config_watcher.watch(path, config, loader.game_hash);
+    };
+    watch_config();
+
+    // Other games of the directory, opened over the same context
+    if (backend->setBrowser(&browser)) {
+        browser.scan(loader.game_dir());
     }
 
-    // Setup Dear ImGui context
-    IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
-    ImGuiIO& io = ImGui::GetIO(); (void)io;
-    io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
-    io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
+    auto open_game = [&](const std::string &path) {
+        std::string previous = loader.game_path;
 
-    // Setup Dear ImGui style
-    ImGui::StyleColorsDark();
+        C8_Restart(context);
+        if (loader.load(path, config, _context) != 0) {
+            fprintf(stderr, "Cannot open %s\n", path.c_str());
+            C8_Restart(context);
+            loader.load(previous, config, _context);
+        }
+        C8_ClearError(context);
+
+        profiler.attach(_context);
+        watch_source();
+        watch_config();
+        backend->configure(config);
+        apply_config();
+        sync_time  = backend->now();
+        sync_cycle = 0;
+    };
+
+    // Publish live state for external readers when requested
+    telemetry.page = NULL;
+    telemetry_path = getenv("CHIP8_TELEMETRY");
+    if (telemetry_path != NULL && C8_TelemetryOpen(&telemetry, telemetry_path) != 0) {
+        fprintf(stderr, "Cannot open telemetry at %s\n", telemetry_path);
+    }
+    frame_time = backend->now();
+
+    // Record every frame on a background thread, dropping frames rather than slowing down
+    memset(&recorder, 0, sizeof recorder);
+    record_path = getenv("CHIP8_RECORD");
+    if (record_path != NULL) {
+        memset(&record_options, 0, sizeof record_options);
+        record_options.format = C8_RecordFormatFromPath(record_path);
+        record_options.fps    = (int)config.fps;
+
+        if (C8_RecorderOpen(&recorder, record_path, &record_options) != 0) {
+            fprintf(stderr, "Cannot record to %s\n", record_path);
+        }
+    }
 
-    // Setup Platform/Renderer backends
-    ImGui_ImplSDL2_InitForSDLRenderer(window, renderer);
-    ImGui_ImplSDLRenderer2_Init(renderer);
+    C8_ClearError(context);
 
-    viewport.x = 0;
-    viewport.y = 0;
-    viewport.w = VIEWPORT_WIDTH;
-    viewport.h = VIEWPORT_HEIGHT;
+    // Render and present the current display
+    auto present = [&]() {
+        backend->present(_context, profiler);
+        C8_TraceFrame();
 
-    C8_ClearError(context);
+        profiler.presented(backend->now());
+    };
+
+    prev_time = next_present = backend->now();
 
     while(bRunning) {
-        SDL_Event event;
-        ticks   = SDL_GetTicks64();
+        BackendEvent event;
+        now     = backend->now();
         c8_tick = profiler.shouldStep();
 
-        while(SDL_PollEvent(&event)) {
-            ImGui_ImplSDL2_ProcessEvent(&event);
-
-            if( (SDL_QUIT == event.type) || 
-                (SDL_KEYDOWN == event.type && SDLK_ESCAPE == event.key.keysym.sym) ) {
-                bRunning = false;
-                break;
-            } else if (SDL_KEYDOWN == event.type) {
-                SET_KEY(Set);
-            } else if (SDL_KEYUP == event.type) {
-                SET_KEY(Unset);
+        // a paused emulation is caught up, inputs apply right away
+        if (!c8_tick) {
+            sync_time  = now;
+            sync_cycle = context->cycles;
+        }
+
+        {
+            C8_TRACE_SCOPE("events");
+            while(backend->poll(event)) {
+                if (BackendEvent::QUIT == event.type) {
+                    bRunning = false;
+                    break;
+                } else if (BackendEvent::NEXT_SPEED == event.type) {
+                    speed = next_speed(speed);
+                    backend->setSpeed(speed);
+                } else if (BackendEvent::OPEN == event.type) {
+                    open_game(browser.entry(event.key).path);
+                } else if (BackendEvent::KEY_DOWN == event.type || BackendEvent::KEY_UP == event.type) {
+                    // Key transitions are applied at the cycle the emulation reaches at their timestamp
+                    profiler.setKey(event.key, BackendEvent::KEY_DOWN == event.type,
+                        event_cycle(event.time, sync_time, sync_cycle, config.clockspeed * speed),
+                        event.time);
+                }
             }
         }
 
-TICK_COND(ticks, prev_ticks, config.clockspeed, c8_tick,
-        if ((opcode = C8_Tick(context)) <= 0) {
-            bRunning = false;
-            break;
+        // a saved source lands between two instructions, the recorded history no longer applies
+        C8_LivePatch patch = live.poll(_context);
+        if (patch.status == C8_LivePatch::PATCHED) {
+            profiler.setLabels(source_labels(live));
+
+            if (patch.bytes > 0) {
+                profiler.forget();
+                printf("Patched %zu bytes in $%04X-$%04X (%.2f ms)\n", patch.bytes, patch.first, patch.last, patch.ms);
+            } else {
+                printf("Assembled, no byte changed (%.2f ms)\n", patch.ms);
+            }
         }
-);
 
-// Timers clocked at 60hz    
-TICK_COND(ticks, prev_timers_ticks, 60.0, c8_tick,
-        C8_UpdateTimers(context);
-);
+        // instruction slots owed since the last iteration, idle ones included so timers
+        // keep running while FX0A waits. Beyond the backlog the emulation slows down.
+        if (!profiler.paused() && speed > 0) {
+            owed = std::min(owed + (now - prev_time) * config.clockspeed * speed / 1e9,
+                            (double)config.clockspeed * speed * MAX_BACKLOG_IN_SECONDS);
+        } else {
+            owed = 0;
+        }
+        prev_time = now;
+
+        if (profiler.paused()) {
+            // single steps from the profiler
+            if (c8_tick && profiler.tick() <= 0) bRunning = false;
+        } else {
+            C8_TRACE_SCOPE("emulate");
+
+            // emulate up to the next present, one timer period at a time
+            while (bRunning && !profiler.paused() && (speed == 0 || owed >= 1)) {
+                uint64_t until = (uint64_t)ceil(std::min(next_timer_slot, next_frame_slot)) - slots;
+                uint64_t count = (speed == 0) ? until : std::min(until, (uint64_t)owed);
+
+                // inputs and keyframes go through the profiler for time travel
+                uint64_t start = context->cycles;
+                int      rv    = profiler.run(count);
+
+                // a breakpoint stops short, only a key wait charges its idle slots
+                if (profiler.paused()) count = context->cycles - start;
+                slots += count;
+                owed  -= count;
+
+                // Timers clocked at 60hz of emulated time
+                if (slots >= next_timer_slot) {
+                    C8_TRACE_SCOPE("timers");
+                    profiler.updateTimers();
+                    next_timer_slot += config.clockspeed / 60.0;
+                }
+
+                // every emulated frame is recorded and published, presented or skipped
+                if (slots >= next_frame_slot) {
+                    uint64_t time = backend->now();
+
+                    C8_TelemetryPublish(&telemetry, context, (time - frame_time) / 1e6);
+                    C8_RecorderPush(&recorder, context);
+                    frame_time       = time;
+                    next_frame_slot += config.clockspeed / config.fps;
+                }
+
+                if (rv <= 0) bRunning = false;
+                if (backend->now() >= next_present) break;
+            }
 
-TICK(ticks, prev_draws, config.fps,
-        // Start the Dear ImGui frame
-        ImGui_ImplSDLRenderer2_NewFrame();
-        ImGui_ImplSDL2_NewFrame();
-        ImGui::NewFrame();
+            sync_time  = backend->now();
+            sync_cycle = context->cycles;
+        }
 
-        profiler.render(c8_tick ? &opcode : nullptr);
+        now = backend->now();
+        if (now >= next_present) {
+            // settings edited in config.cfg land between two frames, a Tab speed is kept
+            Config edited;
+            if (config_watcher.take(edited)) {
+                float current = speed;
+                bool  same    = edited.speed == config.speed;
+
+                config                = edited;
+                context->config.wrapy = config.wrapy;
+                backend->configure(config);
+                apply_config();
+                if (same) {
+                    speed = current;
+                    backend->setSpeed(speed);
+                }
+
+                sync_time  = now;
+                sync_cycle = context->cycles;
+                printf("CONFIG reloaded: fps %g, clockspeed %g, wrapy %d, speed %g\n",
+                       config.fps, config.clockspeed, config.wrapy, config.speed);
+            }
 
-        // Rendering
-        ImGui::Render();
-        SDL_RenderSetScale(renderer, io.DisplayFramebufferScale.x, io.DisplayFramebufferScale.y);
-        SDL_RenderClear(renderer);  // Needed as texture doesn't fill the renderer
+            // behind schedule: the frame's time goes to the emulation instead
+            bool behind = speed > 0 && owed >= config.clockspeed * speed / present_rate;
 
-        copy_c8_display(texture, context);
-        SDL_RenderCopy(renderer, texture, &srcrect, &dstrect);
+            if (behind && skipped < MAX_FRAMESKIP) {
+                ++skipped;
+            } else {
+                present();
+                skipped = 0;
 
-        ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData());
-        SDL_RenderPresent(renderer);
-);
+                // away from 1x, presenting may only take a share of the time
+                uint64_t cost = backend->now() - now;
+                present_cost = present_cost ? (present_cost * 7 + cost) / 8 : cost;
+            }
+
+            uint64_t period = (uint64_t)(1e9 / present_rate);
+            if (speed != 1) period = std::max(period, (uint64_t)(present_cost / TURBO_PRESENT_SHARE));
+
+            next_present = std::max(next_present + period, now);
+        } else if (speed > 0 && owed < 1) {
+            // nothing due before the next instruction
+            C8_TRACE_SCOPE("sleep");
+            backend->sleep(1000000);
+        }
     }
 
     // Cleanup
-    ImGui_ImplSDLRenderer2_Shutdown();
-    ImGui_ImplSDL2_Shutdown();
-    ImGui::DestroyContext();
+    export_trace();
+    C8_TelemetryClose(&telemetry);
+    if (record_path != NULL && C8_RecorderClose(&recorder) != 0) {
+        fprintf(stderr, "Recording incomplete: %llu frames dropped\n", (unsigned long long)recorder.dropped);
+    }
+
+    delete backend;
+    C8_Destroy(context);
 
-    cleanup(context, texture, renderer, window);
-    SDL_Quit();
-    
     return 0;
-}
\ No newline at end of file
+}